@@ -31,6 +31,13 @@
 #include "Core.h"		// For g_fh
 #include "YamlHelper.h"
 
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AY_SIMD_SSE2
+#endif
+
 /* The AY white noise RNG algorithm is based on info from MAME's ay8910.c -
  * MAME's licence explicitly permits free use of info (even encourages it).
  */
@@ -122,6 +129,7 @@ void AY8913::init(void)
 AY8913::AY8913(void)
 {
 	memset(sound_ay_registers, 0, sizeof(sound_ay_registers));
+	memset(sound_ay_latched, 0, sizeof(sound_ay_latched));
 	init();
 	m_fCurrentCLK_AY8910 = g_fCurrentCLK6502;
 };
@@ -411,41 +419,6 @@ sound_write_buf_pstereo( libspectrum_signed_word * out, int c )
 #define AY_GET_SUBVAL( chan ) \
   ( level * 2 * ay_tone_tick[ chan ] / tone_count )
 
-#define AY_DO_TONE( var, chan ) \
-  ( var ) = 0;								\
-  is_low = 0;								\
-  if( level ) {								\
-    if( ay_tone_high[ chan ] )						\
-      ( var ) = ( level );						\
-    else {								\
-      ( var ) = -( level );						\
-      is_low = 1;							\
-    }									\
-  }									\
-  									\
-  ay_tone_tick[ chan ] += tone_count;					\
-  count = 0;								\
-  while( ay_tone_tick[ chan ] >= ay_tone_period[ chan ] ) {		\
-    count++;								\
-    ay_tone_tick[ chan ] -= ay_tone_period[ chan ];			\
-    ay_tone_high[ chan ] = !ay_tone_high[ chan ];			\
-    									\
-    /* has to be here, unfortunately... */				\
-    if( count == 1 && level && ay_tone_tick[ chan ] < tone_count ) {	\
-      if( is_low )							\
-        ( var ) += AY_GET_SUBVAL( chan );				\
-      else								\
-        ( var ) -= AY_GET_SUBVAL( chan );				\
-      }									\
-    }									\
-  									\
-  /* if it's changed more than once during the sample, we can't */	\
-  /* represent it faithfully. So, just hope it's a sample.      */	\
-  /* (That said, this should also help avoid aliasing noise.)   */	\
-  if( count > 1 )							\
-    ( var ) = -( level )
-
-
 #if 0
 /* add val, correctly delayed on either left or right buffer,
  * to add the AY stereo positioning. This doesn't actually put
@@ -471,123 +444,76 @@ sound_write_buf_pstereo( libspectrum_signed_word * out, int c )
 #define HZ_COMMON_DENOMINATOR 50
 #include "Log.h"
 
-void AY8913::sound_ay_overlay( void )
+void AY8913::sound_ay_change( int reg, int val )
 {
-  int tone_level[3];
-  int mixer, envshape;
-  int f, g, level, count;
-//  libspectrum_signed_word *ptr;
-  struct ay_change_tag *change_ptr = ay_change;
-  int changes_left = ay_change_count;
-  int reg, r;
-  int is_low;
-  int chan1, chan2, chan3;
-  unsigned int tone_count, noise_count;
-  libspectrum_dword sfreq, cpufreq;
-
-///* If no AY chip, don't produce any AY sound (!) */
-//  if( !machine_current->capabilities & LIBSPECTRUM_MACHINE_CAPABILITY_AY )
-//    return;
-
-/* convert change times to sample offsets, use common denominator of 50 to
-   avoid overflowing a dword */
-  sfreq = sound_generator_freq / HZ_COMMON_DENOMINATOR;
-//  cpufreq = machine_current->timings.processor_speed / HZ_COMMON_DENOMINATOR;
-  cpufreq = (libspectrum_dword) (m_fCurrentCLK_AY8910 / HZ_COMMON_DENOMINATOR);	// [TC]
-  int dbgCount=0;
-  for( f = 0; f < ay_change_count; f++ )
-  {
-    ay_change[f].ofs = (USHORT) (( ay_change[f].tstates * sfreq ) / cpufreq);	// [TC] Added cast
-
-	if (ay_change[f].ofs >= sound_generator_framesiz)	// [TC] Ensure that all ay_change's get processed
-	{
-		ay_change[f].ofs = sound_generator_framesiz-1;	// [TC] - as parent, sound_frame(), just dumps outstanding changes (ay_change_count=0)
-		dbgCount++;
-	}
-  }
-#if defined(_DEBUG) && 0
-  if (dbgCount)
-  {
-	  LogOutput("ay_change: saved %d\n", dbgCount);	// [TC] previously would've been dumped!
-  }
-#endif
-
-  libspectrum_signed_word* pBuf1 = ppSoundBuffers[0];
-  libspectrum_signed_word* pBuf2 = ppSoundBuffers[1];
-  libspectrum_signed_word* pBuf3 = ppSoundBuffers[2];
-
-//  for( f = 0, ptr = sound_buf; f < sound_generator_framesiz; f++ ) {
-  for( f = 0; f < sound_generator_framesiz; f++ ) {
-    /* update ay registers. All this sub-frame change stuff
-     * is pretty hairy, but how else would you handle the
-     * samples in Robocop? :-) It also clears up some other
-     * glitches.
+  int r;
+
+  sound_ay_registers[ reg ] = val;
+
+  /* fix things as needed for some register changes */
+  switch ( reg ) {
+  case 0:
+  case 1:
+  case 2:
+  case 3:
+  case 4:
+  case 5:
+    r = reg >> 1;
+    /* a zero-len period is the same as 1 */
+    ay_tone_period[r] = ( sound_ay_registers[ reg & ~1 ] |
+			  ( sound_ay_registers[ reg | 1 ] & 15 ) << 8 );
+    if( !ay_tone_period[r] )
+      ay_tone_period[r]++;
+
+    /* important to get this right, otherwise e.g. Ghouls 'n' Ghosts
+     * has really scratchy, horrible-sounding vibrato.
      */
-    while( changes_left && f >= change_ptr->ofs ) {
-      sound_ay_registers[ reg = change_ptr->reg ] = change_ptr->val;
-      change_ptr++;
-      changes_left--;
-
-      /* fix things as needed for some register changes */
-      switch ( reg ) {
-      case 0:
-      case 1:
-      case 2:
-      case 3:
-      case 4:
-      case 5:
-	r = reg >> 1;
-	/* a zero-len period is the same as 1 */
-	ay_tone_period[r] = ( sound_ay_registers[ reg & ~1 ] |
-			      ( sound_ay_registers[ reg | 1 ] & 15 ) << 8 );
-	if( !ay_tone_period[r] )
-	  ay_tone_period[r]++;
-
-	/* important to get this right, otherwise e.g. Ghouls 'n' Ghosts
-	 * has really scratchy, horrible-sounding vibrato.
-	 */
-	if( ay_tone_tick[r] >= ay_tone_period[r] * 2 )
-	  ay_tone_tick[r] %= ay_tone_period[r] * 2;
-	break;
-      case 6:
-	ay_noise_tick = 0;
-	ay_noise_period = ( sound_ay_registers[ reg ] & 31 );
-	break;
-      case 11:
-      case 12:
-	/* this one *isn't* fixed-point */
-	ay_env_period =
-	  sound_ay_registers[11] | ( sound_ay_registers[12] << 8 );
-	break;
-      case 13:
-	ay_env_internal_tick = ay_env_tick = ay_env_subcycles = 0;
-	env_first = 1;
-	env_rev = 0;
-	env_counter = ( sound_ay_registers[13] & AY_ENV_ATTACK ) ? 0 : 15;
-	break;
-      }
-    }
-
-    /* the tone level if no enveloping is being used */
-    for( g = 0; g < 3; g++ )
-      tone_level[g] = ay_tone_levels[ sound_ay_registers[ 8 + g ] & 15 ];
+    if( ay_tone_tick[r] >= ay_tone_period[r] * 2 )
+      ay_tone_tick[r] %= ay_tone_period[r] * 2;
+    break;
+  case 6:
+    ay_noise_tick = 0;
+    ay_noise_period = ( sound_ay_registers[ reg ] & 31 );
+    break;
+  case 11:
+  case 12:
+    /* this one *isn't* fixed-point */
+    ay_env_period =
+      sound_ay_registers[11] | ( sound_ay_registers[12] << 8 );
+    break;
+  case 13:
+    ay_env_internal_tick = ay_env_tick = ay_env_subcycles = 0;
+    env_first = 1;
+    env_rev = 0;
+    env_counter = ( sound_ay_registers[13] & AY_ENV_ATTACK ) ? 0 : 15;
+    break;
+  }
+}
 
-    /* envelope */
-    envshape = sound_ay_registers[13];
-    level = ay_tone_levels[ env_counter ];
+/* advance the envelope, noise and tone clocks over a block of samples,
+ * recording for each sample what the 3 channels need:
+ * the envelope level, the noise output (as a mask) and the tone clock count.
+ */
+void AY8913::sound_ay_block_clocks( int len )
+{
+  const int envshape = sound_ay_registers[13];
+  unsigned int noise_count, tick;
+  int f;
 
-    for( g = 0; g < 3; g++ )
-      if( sound_ay_registers[ 8 + g ] & 16 )
-	tone_level[g] = level;
+  for( f = 0; f < len; f++ ) {
+    ay_block_env_level[f] = ay_tone_levels[ env_counter ];
+    ay_block_noise_mask[f] = noise_toggle ? 0 : -1;
 
     /* envelope output counter gets incr'd every 16 AY cycles.
-     * Has to be a while, as this is sub-output-sample res.
+     * Has to be a loop, as this is sub-output-sample res.
      */
     ay_env_subcycles += ay_tick_incr;
-    noise_count = 0;
-    while( ay_env_subcycles >= ( 16 << 16 ) ) {
-      ay_env_subcycles -= ( 16 << 16 );
-      noise_count++;
+    noise_count = ay_env_subcycles >> ( 4 + 16 );
+    ay_env_subcycles &= ( 16 << 16 ) - 1;
+
+    if( ay_env_tick + noise_count < ay_env_period )
+      ay_env_tick += noise_count;	/* no envelope step in this sample */
+    else for( tick = 0; tick < noise_count; tick++ ) {
       ay_env_tick++;
       while( ay_env_tick >= ay_env_period ) {
 	ay_env_tick -= ay_env_period;
@@ -634,77 +560,10 @@ void AY8913::sound_ay_overlay( void )
       }
     }
 
-    /* generate tone+noise... or neither.
-     * (if no tone/noise is selected, the chip just shoves the
-     * level out unmodified. This is used by some sample-playing
-     * stuff.)
-     */
-    chan1 = tone_level[0];
-    chan2 = tone_level[1];
-    chan3 = tone_level[2];
-    mixer = sound_ay_registers[7];
-
     ay_tone_subcycles += ay_tick_incr;
-    tone_count = ay_tone_subcycles >> ( 3 + 16 );
+    ay_block_tone_count[f] = ay_tone_subcycles >> ( 3 + 16 );
     ay_tone_subcycles &= ( 8 << 16 ) - 1;
 
-    if( ( mixer & 1 ) == 0 ) {
-      level = chan1;
-      AY_DO_TONE( chan1, 0 );
-    }
-    if( ( mixer & 0x08 ) == 0 && noise_toggle )
-      chan1 = 0;
-
-    if( ( mixer & 2 ) == 0 ) {
-      level = chan2;
-      AY_DO_TONE( chan2, 1 );
-    }
-    if( ( mixer & 0x10 ) == 0 && noise_toggle )
-      chan2 = 0;
-
-    if( ( mixer & 4 ) == 0 ) {
-      level = chan3;
-      AY_DO_TONE( chan3, 2 );
-    }
-    if( ( mixer & 0x20 ) == 0 && noise_toggle )
-      chan3 = 0;
-
-    /* write the sample(s) */
-	*pBuf1++ = chan1;	// [TC]
-	*pBuf2++ = chan2;	// [TC]
-	*pBuf3++ = chan3;	// [TC]
-#if 0
-    if( !sound_stereo ) {
-      /* mono */
-      ( *ptr++ ) += chan1 + chan2 + chan3;
-    } else {
-      if( !sound_stereo_ay ) {
-	/* stereo output, but mono AY sound; still,
-	 * incr separately in case of beeper pseudostereo.
-	 */
-	( *ptr++ ) += chan1 + chan2 + chan3;
-	( *ptr++ ) += chan1 + chan2 + chan3;
-      } else {
-	/* stereo with ACB/ABC AY positioning.
-	 * Here we use real stereo positions for the channels.
-	 * Just because, y'know, it's cool and stuff. No, really. :-)
-	 * This is a little tricky, as it works by delaying sounds
-	 * on the left or right channels to model the delay you get
-	 * in the real world when sounds originate at different places.
-	 */
-	GEN_STEREO( rchan1pos, chan1 );
-	GEN_STEREO( rchan2pos, chan2 );
-	GEN_STEREO( rchan3pos, chan3 );
-	( *ptr++ ) += rstereobuf_l[ rstereopos ];
-	( *ptr++ ) += rstereobuf_r[ rstereopos ];
-	rstereobuf_l[ rstereopos ] = rstereobuf_r[ rstereopos ] = 0;
-	rstereopos++;
-	if( rstereopos >= STEREO_BUF_SIZE )
-	  rstereopos = 0;
-      }
-    }
-#endif
-
     /* update noise RNG/filter */
     ay_noise_tick += noise_count;
     while( ay_noise_tick >= ay_noise_period ) {
@@ -726,28 +585,167 @@ void AY8913::sound_ay_overlay( void )
   }
 }
 
-BYTE AY8913::sound_ay_read( int reg )
+/* square wave of a channel, in place: out[] holds the level of each sample.
+ * Between 2 edges the sample is just +/- level; only samples with an edge
+ * need the sub-sample value.
+ */
+void AY8913::sound_ay_block_tone( int chan, libspectrum_signed_word *out, int len )
 {
-	reg &= 15;
+  const unsigned int period = ay_tone_period[ chan ];
+  unsigned int tone_count;
+  int f, level, var, count, is_low;
+
+  for( f = 0; f < len; f++ ) {
+    level = out[f];
+    tone_count = ay_block_tone_count[f];
+    ay_tone_tick[ chan ] += tone_count;
+
+    if( ay_tone_tick[ chan ] < period ) {
+      /* no edge in this sample */
+      if( !ay_tone_high[ chan ] )
+	out[f] = -level;
+      continue;
+    }
+
+    is_low = level && !ay_tone_high[ chan ];
+    var = ay_tone_high[ chan ] ? level : -level;
+
+    count = 0;
+    while( ay_tone_tick[ chan ] >= period ) {
+      count++;
+      ay_tone_tick[ chan ] -= period;
+      ay_tone_high[ chan ] = !ay_tone_high[ chan ];
+
+      /* has to be here, unfortunately... */
+      if( count == 1 && level && ay_tone_tick[ chan ] < tone_count ) {
+	if( is_low )
+	  var += AY_GET_SUBVAL( chan );
+	else
+	  var -= AY_GET_SUBVAL( chan );
+      }
+    }
 
-	BYTE val = 0;
-	bool got = false;
+    /* if it's changed more than once during the sample, we can't */
+    /* represent it faithfully. So, just hope it's a sample.      */
+    /* (That said, this should also help avoid aliasing noise.)   */
+    if( count > 1 )
+      var = -level;
 
-	if (ay_change_count)
+    out[f] = var;
+  }
+}
+
+/* noise gate of a channel, in place */
+static void sound_ay_block_noise( libspectrum_signed_word *out, const libspectrum_signed_word *mask, int len )
+{
+  int f = 0;
+
+#ifdef AY_SIMD_SSE2
+  for( ; f + 8 <= len; f += 8 ) {
+    const __m128i v = _mm_loadu_si128( ( const __m128i * ) ( out + f ) );
+    const __m128i m = _mm_loadu_si128( ( const __m128i * ) ( mask + f ) );
+    _mm_storeu_si128( ( __m128i * ) ( out + f ), _mm_and_si128( v, m ) );
+  }
+#endif
+
+  for( ; f < len; f++ )
+    out[f] &= mask[f];
+}
+
+/* The frame is rendered in blocks of samples over which the registers do not change
+ * (at most AY_BLOCK_SIZE): first the clocks shared by the 3 channels, then each channel
+ * on its own: level (volume table or envelope), tone, noise.
+ * The output is sample-for-sample identical to rendering one sample at a time
+ * with all 3 channels interleaved.
+ */
+void AY8913::sound_ay_overlay( void )
+{
+  int mixer, level;
+  int f, g, len;
+//  libspectrum_signed_word *ptr;
+  struct ay_change_tag *change_ptr = ay_change;
+  int changes_left = ay_change_count;
+  libspectrum_dword sfreq, cpufreq;
+
+///* If no AY chip, don't produce any AY sound (!) */
+//  if( !machine_current->capabilities & LIBSPECTRUM_MACHINE_CAPABILITY_AY )
+//    return;
+
+/* convert change times to sample offsets, use common denominator of 50 to
+   avoid overflowing a dword */
+  sfreq = sound_generator_freq / HZ_COMMON_DENOMINATOR;
+//  cpufreq = machine_current->timings.processor_speed / HZ_COMMON_DENOMINATOR;
+  cpufreq = (libspectrum_dword) (m_fCurrentCLK_AY8910 / HZ_COMMON_DENOMINATOR);	// [TC]
+  int dbgCount=0;
+  for( f = 0; f < ay_change_count; f++ )
+  {
+    ay_change[f].ofs = (USHORT) (( ay_change[f].tstates * sfreq ) / cpufreq);	// [TC] Added cast
+
+	if (ay_change[f].ofs >= sound_generator_framesiz)	// [TC] Ensure that all ay_change's get processed
 	{
-		for (int i=ay_change_count-1; i>=0; i--)
-		{
-			if (ay_change[i].reg == reg)
-			{
-				val = ay_change[i].val;	// return the most recently written reg's value
-				got = true;
-				break;
-			}
-		}
+		ay_change[f].ofs = sound_generator_framesiz-1;	// [TC] - as parent, sound_frame(), just dumps outstanding changes (ay_change_count=0)
+		dbgCount++;
 	}
+  }
+#if defined(_DEBUG) && 0
+  if (dbgCount)
+  {
+	  LogOutput("ay_change: saved %d\n", dbgCount);	// [TC] previously would've been dumped!
+  }
+#endif
+
+//  for( f = 0, ptr = sound_buf; f < sound_generator_framesiz; f++ ) {
+  for( f = 0; f < sound_generator_framesiz; f += len ) {
+    /* update ay registers. All this sub-frame change stuff
+     * is pretty hairy, but how else would you handle the
+     * samples in Robocop? :-) It also clears up some other
+     * glitches.
+     */
+    while( changes_left && f >= change_ptr->ofs ) {
+      sound_ay_change( change_ptr->reg, change_ptr->val );
+      change_ptr++;
+      changes_left--;
+    }
+
+    len = sound_generator_framesiz - f;
+    if( changes_left && change_ptr->ofs - f < len )
+      len = change_ptr->ofs - f;
+    if( len > AY_BLOCK_SIZE )
+      len = AY_BLOCK_SIZE;
+
+    sound_ay_block_clocks( len );
+
+    mixer = sound_ay_registers[7];
+
+    for( g = 0; g < 3; g++ ) {
+      libspectrum_signed_word *out = ppSoundBuffers[g] + f;	// [TC]
+
+      /* the envelope, or the tone level if no enveloping is being used */
+      if( sound_ay_registers[ 8 + g ] & 16 )
+	memcpy( out, ay_block_env_level, len * sizeof( *out ) );
+      else {
+	level = ay_tone_levels[ sound_ay_registers[ 8 + g ] & 15 ];
+	std::fill( out, out + len, ( libspectrum_signed_word ) level );
+      }
+
+      /* generate tone+noise... or neither.
+       * (if no tone/noise is selected, the chip just shoves the
+       * level out unmodified. This is used by some sample-playing
+       * stuff.)
+       */
+      if( ( mixer & ( 1 << g ) ) == 0 )
+	sound_ay_block_tone( g, out, len );
+      if( ( mixer & ( 8 << g ) ) == 0 )
+	sound_ay_block_noise( out, ay_block_noise_mask, len );
+    }
+  }
+}
 
-	if (!got)
-		val = sound_ay_registers[reg];
+BYTE AY8913::sound_ay_read( int reg )
+{
+	reg &= 15;
+
+	BYTE val = sound_ay_latched[reg];	// the most recently written reg's value
 
 	switch (reg & 15)
 	{
@@ -768,6 +766,14 @@ BYTE AY8913::sound_ay_read( int reg )
 	return val;
 }
 
+/* record the value for sound_ay_read(), on the emulation thread;
+ * sound_ay_write() must still be called (directly or via the audio thread).
+ */
+void AY8913::sound_ay_latch( int reg, int val )
+{
+  sound_ay_latched[ reg & 15 ] = val;
+}
+
 // AppleWin:TC  Holding down ScrollLock will result in lots of AY changes /ay_change_count/
 //              - since sound_ay_overlay() is called to consume them.
 
@@ -802,8 +808,10 @@ void AY8913::sound_ay_reset( void )
   sound_ay_init();
 
   ay_change_count = 0;
-  for( f = 0; f < 16; f++ )
+  for( f = 0; f < 16; f++ ) {
+    sound_ay_latch( f, 0 );
     sound_ay_write( f, 0, 0 );
+  }
   for( f = 0; f < 3; f++ )
     ay_tone_high[f] = 0;
   ay_tone_subcycles = ay_env_subcycles = 0;
@@ -1193,6 +1201,10 @@ bool AY8913::LoadSnapshot(YamlLoadHelper& yamlLoadHelper, const std::string& suf
 		yamlLoadHelper.PopMap();
 	}
 
+	memcpy(sound_ay_latched, sound_ay_registers, sizeof(sound_ay_latched));
+	for (int i=0; i<ay_change_count; i++)
+		sound_ay_latch(ay_change[i].reg, ay_change[i].val);
+
 	yamlLoadHelper.PopMap();
 
 	return true;
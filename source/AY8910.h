@@ -13,6 +13,9 @@ typedef SHORT libspectrum_signed_word;
  */
 #define AY_CHANGE_MAX		8000
 
+/* max. number of samples rendered at once by sound_ay_overlay() */
+#define AY_BLOCK_SIZE		256
+
 class AY8913
 {
 public:
@@ -22,6 +25,7 @@ public:
 	void sound_ay_init( void );
 	void sound_init( const char *device );
 	BYTE sound_ay_read( int reg );	// TC
+	void sound_ay_latch( int reg, int val );
 	void sound_ay_write( int reg, int val, libspectrum_dword now );
 	void sound_ay_reset( void );
 	void sound_frame( void );
@@ -36,6 +40,9 @@ private:
 	void init( void );
 	void sound_end( void );
 	void sound_ay_overlay( void );
+	void sound_ay_change( int reg, int val );
+	void sound_ay_block_clocks( int len );
+	void sound_ay_block_tone( int chan, libspectrum_signed_word *out, int len );
 
 private:
 	/* foo_subcycles are fixed-point with low 16 bits as fractional part.
@@ -52,6 +59,12 @@ private:
 	/* Local copy of the AY registers */
 	libspectrum_byte sound_ay_registers[16];
 
+	/* AY registers as last written by the 6502, for sound_ay_read().
+	 * Owned by the emulation thread: sound_ay_registers[] may lag behind
+	 * when sound_frame() runs on the Mockingboard audio thread.
+	 */
+	libspectrum_byte sound_ay_latched[16];
+
 	struct ay_change_tag
 	{
 		libspectrum_dword tstates;
@@ -67,6 +80,11 @@ private:
 	int noise_toggle;
 	int env_first, env_rev, env_counter;
 
+	// per-sample clocks of the current block, shared by the 3 channels
+	unsigned int ay_block_tone_count[ AY_BLOCK_SIZE ];
+	libspectrum_signed_word ay_block_env_level[ AY_BLOCK_SIZE ];
+	libspectrum_signed_word ay_block_noise_mask[ AY_BLOCK_SIZE ];
+
 	// Vars
 	libspectrum_signed_word** ppSoundBuffers;	// Used to pass param to sound_ay_overlay()
 	int sound_generator_framesiz;
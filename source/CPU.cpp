@@ -95,6 +95,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #endif
 #include "SynchronousEventManager.h"
 #include "NTSC.h"
+#include "PerfCounters.h"
 #include "Log.h"
 
 #include "z80emu.h"
@@ -720,10 +721,7 @@ ULONG CpuGetCyclesThisVideoFrame(const ULONG nExecutedCycles)
 
 uint32_t CpuExecute(const uint32_t uCycles, const bool bVideoUpdate)
 {
-#ifdef LOG_PERF_TIMINGS
-	extern UINT64 g_timeCpu;
-	PerfMarker perfMarker(g_timeCpu);
-#endif
+	PerfMarker perfMarker(PERF_CPU);
 
 	g_nCyclesExecuted =	0;
 	g_interruptInLastExecutionBatch = false;
@@ -46,6 +46,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "VidHD.h"
 #include "LanguageCard.h"
 #include "Memory.h"
+#include "PerfCounters.h"
 #include "z80emu.h"
 
 void CardManager::InsertInternal(UINT slot, SS_CARDTYPE type)
@@ -285,6 +286,8 @@ void CardManager::Reset(const bool powerCycle)
 
 void CardManager::Update(const ULONG nExecutedCycles)
 {
+	PerfMarker perfMarker(PERF_CARDS);
+
 	for (UINT i = SLOT0; i < NUM_SLOTS; ++i)
 	{
 		if (m_slot[i])
@@ -34,6 +34,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Interface.h"
 #include "Log.h"
 #include "Memory.h"
+#include "PerfCounters.h"
 #include "Pravets.h"
 #include "Speaker.h"
 #include "Registry.h"
@@ -93,36 +94,25 @@ CSpeech		g_Speech;
 //===========================================================================
 
 #ifdef LOG_PERF_TIMINGS
-static UINT64 g_timeTotal = 0;
-UINT64 g_timeCpu = 0;
-UINT64 g_timeVideo = 0;			// part of timeCpu
-UINT64 g_timeMB_Timer = 0;		// part of timeCpu
-UINT64 g_timeMB_NoTimer = 0;
-UINT64 g_timeSpeaker = 0;
-static UINT64 g_timeVideoRefresh = 0;
-
 void LogPerfTimings(void)
 {
-	if (g_timeTotal)
+	const UINT64 wallTime = PerfCounters_GetWallTime();
+	if (wallTime)
 	{
-		UINT64 cpu = g_timeCpu - g_timeVideo - g_timeMB_Timer;
-		UINT64 video = g_timeVideo + g_timeVideoRefresh;
-		UINT64 spkr = g_timeSpeaker;
-		UINT64 mb = g_timeMB_Timer + g_timeMB_NoTimer;
-		UINT64 audio = spkr + mb;
-		UINT64 other = g_timeTotal - g_timeCpu - g_timeSpeaker - g_timeMB_NoTimer - g_timeVideoRefresh;
-
-		LogOutput("Perf breakdown:\n");
-		LogOutput(". CPU %%        = %6.2f\n", (double)cpu / (double)g_timeTotal * 100.0);
-		LogOutput(". Video %%      = %6.2f\n", (double)video / (double)g_timeTotal * 100.0);
-		LogOutput("... NTSC %%     = %6.2f\n", (double)g_timeVideo / (double)g_timeTotal * 100.0);
-		LogOutput("... refresh %%  = %6.2f\n", (double)g_timeVideoRefresh / (double)g_timeTotal * 100.0);
-		LogOutput(". Audio %%      = %6.2f\n", (double)audio / (double)g_timeTotal * 100.0);
-		LogOutput("... Speaker %%  = %6.2f\n", (double)spkr / (double)g_timeTotal * 100.0);
-		LogOutput("... MB %%       = %6.2f\n", (double)mb / (double)g_timeTotal * 100.0);
-		LogOutput(". Other %%      = %6.2f\n", (double)other / (double)g_timeTotal * 100.0);
-		LogOutput(". TOTAL %%      = %6.2f\n", (double)(cpu+video+audio+other) / (double)g_timeTotal * 100.0);
+		UINT64 total = 0;
+
+		LogOutput("Perf breakdown (%u frames):\n", (UINT)PerfCounters_GetFrames());
+		for (UINT i = 0; i < PERF_NUM_COUNTERS; ++i)
+		{
+			PerfCounterStats stats;
+			PerfCounters_GetStats(PerfCounterID(i), stats);
+			total += stats.total;
+			LogOutput(". %-12s %% = %6.2f\n", PerfCounters_GetName(PerfCounterID(i)), (double)stats.total / (double)wallTime * 100.0);
+		}
+		LogOutput(". Other        %% = %6.2f\n", (double)(wallTime - std::min(wallTime, total)) / (double)wallTime * 100.0);
 	}
+
+	PerfCounters_Reset();
 }
 #endif
 
@@ -134,6 +124,7 @@ static bool bLogKeyReadDone = false;
 void LogFileTimeUntilFirstKeyReadReset(void)
 {
 #ifdef LOG_PERF_TIMINGS
+	PerfCounters_Enable(true);
 	LogPerfTimings();
 #endif
 
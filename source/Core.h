@@ -75,24 +75,4 @@ extern bool       g_bDisableDirectSoundMockingboard;	// Cmd line switch: don't i
 
 class Pravets& GetPravets(void);
 
-//#define LOG_PERF_TIMINGS
-#ifdef LOG_PERF_TIMINGS
-class PerfMarker
-{
-public:
-	PerfMarker(UINT64& globalCounter)
-		: counter(globalCounter)
-	{
-		QueryPerformanceCounter(&timeStart);
-	}
-	~PerfMarker()
-	{
-		QueryPerformanceCounter(&timeEnd);
-		counter += (UINT64)timeEnd.QuadPart - (UINT64)timeStart.QuadPart;
-	}
-private:
-	UINT64& counter;
-	LARGE_INTEGER timeStart;
-	LARGE_INTEGER timeEnd;
-};
-#endif
+//#define LOG_PERF_TIMINGS	// Enable the PerfCounters at startup and log them at every reboot (see PerfCounters.h)
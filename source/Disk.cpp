@@ -39,6 +39,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "DiskImage.h"
 #include "Log.h"
 #include "Memory.h"
+#include "PerfCounters.h"
 #include "Registry.h"
 #include "SaveState.h"
 #include "YamlHelper.h"
@@ -53,9 +54,49 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 // . if false && I/O ReadWrite($C0EC) && drive is spinning, then advance the track buffer's nibble index (to simulate spinning).
 // Also m_enhanceDisk is persisted to the save-state, so it's an attribute of the DiskII interface card.
 
+// WOZ write: [first bit-cell in byte][number of bit-cells] (only n <= 8-b is used)
+const BYTE Disk2InterfaceCard::m_writeBitCellMask[8][9] = {
+	{0x00,0x80,0xC0,0xE0,0xF0,0xF8,0xFC,0xFE,0xFF},
+	{0x00,0x40,0x60,0x70,0x78,0x7C,0x7E,0x7F,0x7F},
+	{0x00,0x20,0x30,0x38,0x3C,0x3E,0x3F,0x3F,0x3F},
+	{0x00,0x10,0x18,0x1C,0x1E,0x1F,0x1F,0x1F,0x1F},
+	{0x00,0x08,0x0C,0x0E,0x0F,0x0F,0x0F,0x0F,0x0F},
+	{0x00,0x04,0x06,0x07,0x07,0x07,0x07,0x07,0x07},
+	{0x00,0x02,0x03,0x03,0x03,0x03,0x03,0x03,0x03},
+	{0x00,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01},
+};
+
 // NB. Non-standard 4&4, with Vol=0x00 and Chk=0x00 (only a few match, eg. Wasteland, Legacy of the Ancients, Planetfall, Border Zone & Wizardry). [*1]
 const BYTE Disk2InterfaceCard::m_T00S00Pattern[] = {0xD5,0xAA,0x96,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xDE};
 
+// Fast-load: DOS 3.3 RWTS READ16 (usually at $B8DC) up to & including RDERR
+// . operands for DNIBL, NBUF1 & NBUF2 are wildcards, since the RWTS can be relocated
+const short Disk2InterfaceCard::m_fastLoadDOS33Read16[] = {
+	0xA0,0x20,0x88,0xF0,0x61,0xBD,0x8C,0xC0,0x10,0xFB,0x49,0xD5,0xD0,0xF4,0xEA,0xBD,
+	0x8C,0xC0,0x10,0xFB,0xC9,0xAA,0xD0,0xF2,0xA0,0x56,0xBD,0x8C,0xC0,0x10,0xFB,0xC9,
+	0xAD,0xD0,0xE7,0xA9,0x00,0x88,0x84,0x26,0xBC,0x8C,0xC0,0x10,0xFB,0x59,  -1,  -1,
+	0xA4,0x26,0x99,  -1,  -1,0xD0,0xEE,0x84,0x26,0xBC,0x8C,0xC0,0x10,0xFB,0x59,  -1,
+	  -1,0xA4,0x26,0x99,  -1,  -1,0xC8,0xD0,0xEE,0xBC,0x8C,0xC0,0x10,0xFB,0xD9,  -1,
+	  -1,0xD0,0x13,0xBD,0x8C,0xC0,0x10,0xFB,0xC9,0xDE,0xD0,0x0A,0xEA,0xBD,0x8C,0xC0,
+	0x10,0xFB,0xC9,0xAA,0xF0,0x5C,0x38,0x60
+};
+
+// Fast-load: ProDOS 8 Disk II driver's read data field (eg. $D431 for ProDOS 2.4.3) up to & including the final RTS
+// . self-modified operands (slot & buffer) and the driver's tables are wildcards
+const short Disk2InterfaceCard::m_fastLoadProDOSRead[] = {
+	0xA0,0x20,0x88,0xF0,0x37,0xBD,0x8C,0xC0,0x10,0xFB,0x49,0xD5,0xD0,0xF4,0xEA,0xBD,
+	0x8C,0xC0,0x10,0xFB,0xC9,0xAA,0xD0,0xF2,0xEA,0xBD,0x8C,0xC0,0x10,0xFB,0xC9,0xAD,
+	0xD0,0xE8,0xA0,0xAA,0xA9,0x00,0x85,0x3A,0xAE,  -1,0xC0,0x10,0xFB,0xBD,  -1,  -1,
+	0x99,  -1,  -1,0x45,0x3A,0xC8,0xD0,0xEE,0xA0,0xAA,0xD0,0x05,0x38,0x60,0x99,  -1,
+	  -1,0xAE,  -1,0xC0,0x10,0xFB,0x5D,  -1,  -1,0xBE,  -1,  -1,0x5D,  -1,  -1,0xC8,
+	0xD0,0xEC,0x48,0x29,0xFC,0xA0,0xAA,0xAE,  -1,0xC0,0x10,0xFB,0x5D,  -1,  -1,0xBE,
+	  -1,  -1,0x5D,  -1,  -1,0x99,  -1,  -1,0xC8,0xD0,0xEC,0xAE,  -1,0xC0,0x10,0xFB,
+	0x29,0xFC,0xA0,0xAC,0x5D,  -1,  -1,0xBE,  -1,  -1,0x5D,  -1,  -1,0x99,  -1,  -1,
+	0xAE,  -1,0xC0,0x10,0xFB,0xC8,0xD0,0xEC,0x29,0xFC,0x5D,  -1,  -1,0xD0,0x0C,0xA6,
+	0x3E,0xBD,0x8C,0xC0,0x10,0xFB,0xC9,0xDE,0x18,0xF0,0x01,0x38,0x68,0xA0,0x55,0x91,
+	0x44,0x60
+};
+
 Disk2InterfaceCard::Disk2InterfaceCard(UINT slot) :
 	Card(CT_Disk2, slot),
 	m_syncEvent(slot, 0, SyncEventCallback)	// use slot# as "unique" id for Disk2InterfaceCards
@@ -70,6 +111,8 @@ Disk2InterfaceCard::Disk2InterfaceCard(UINT slot) :
 	m_diskLastCycle = 0;
 	m_diskLastReadLatchCycle = 0;
 	m_enhanceDisk = true;
+	m_fastLoad = false;
+	m_fastLoadFailedPC = 0;
 	m_is13SectorFirmware = false;
 	m_force13SectorFirmware = false;
 	m_deferredStepperEvent = false;
@@ -100,6 +143,9 @@ Disk2InterfaceCard::~Disk2InterfaceCard(void)
 bool Disk2InterfaceCard::GetEnhanceDisk(void) { return m_enhanceDisk; }
 void Disk2InterfaceCard::SetEnhanceDisk(bool bEnhanceDisk) { m_enhanceDisk = bEnhanceDisk; }
 
+bool Disk2InterfaceCard::GetFastLoad(void) { return m_fastLoad; }
+void Disk2InterfaceCard::SetFastLoad(bool bFastLoad) { m_fastLoad = bFastLoad; }
+
 UINT   Disk2InterfaceCard::GetCurrentBitOffset  (void) { return m_floppyDrive[m_currDrive].m_disk.m_bitOffset; }
 double Disk2InterfaceCard::GetCurrentExtraCycles(void) { return m_floppyDrive[m_currDrive].m_disk.m_extraCycles; }
 float  Disk2InterfaceCard::GetCurrentPhase      (void) { return m_floppyDrive[m_currDrive].m_phasePrecise; }
@@ -380,7 +426,26 @@ void Disk2InterfaceCard::ReadTrack(const int drive, ULONG uExecutedCycles)
 			pFloppy->m_extraCycles = 0.0;
 			pDrive->m_headWindow = 0;
 
-			FindTrackSeamWOZ(*pFloppy, pDrive->m_phasePrecise/2);
+			// The seam only depends on the track's bitstream, so just scan it on the 1st visit (and after the track has been written)
+			WOZTrackInfo* pTrackInfo = ImageGetWOZTrackInfo(pFloppy->m_imagehandle, pDrive->m_phasePrecise);
+			if (pTrackInfo && pTrackInfo->valid && pTrackInfo->bitCount == pFloppy->m_bitCount && pTrackInfo->nibbles == pFloppy->m_nibbles)
+			{
+				pFloppy->m_longestSyncFFBitOffsetStart = pTrackInfo->longestSyncFFBitOffsetStart;
+				pFloppy->m_longestSyncFFRunLength = pTrackInfo->longestSyncFFRunLength;
+			}
+			else
+			{
+				FindTrackSeamWOZ(*pFloppy, pDrive->m_phasePrecise/2);
+
+				if (pTrackInfo)
+				{
+					pTrackInfo->bitCount = pFloppy->m_bitCount;
+					pTrackInfo->nibbles = pFloppy->m_nibbles;
+					pTrackInfo->longestSyncFFBitOffsetStart = pFloppy->m_longestSyncFFBitOffsetStart;
+					pTrackInfo->longestSyncFFRunLength = pFloppy->m_longestSyncFFRunLength;
+					pTrackInfo->valid = true;
+				}
+			}
 		}
 
 		pFloppy->m_trackimagedata = (pFloppy->m_nibbles != 0);
@@ -479,6 +544,21 @@ void Disk2InterfaceCard::FlushCurrentTrack(const int drive)
 
 //===========================================================================
 
+// eg. after fork(): the image files are no longer shared with the other process, and disk writes stay in this process
+bool Disk2InterfaceCard::DetachImages(void)
+{
+	for (int drive = DRIVE_1; drive < NUM_DRIVES; drive++)
+	{
+		FloppyDisk& floppy = m_floppyDrive[drive].m_disk;
+		if (floppy.m_imagehandle && !ImageDetach(floppy.m_imagehandle))
+			return false;
+	}
+
+	return true;
+}
+
+//===========================================================================
+
 void Disk2InterfaceCard::Boot(void)
 {
 	// THIS FUNCTION RELOADS A PROGRAM IMAGE IF ONE IS LOADED IN DRIVE ONE.
@@ -830,7 +910,7 @@ ImageError_e Disk2InterfaceCard::InsertDisk(const int drive, const std::string&
 	if (dwAttributes == INVALID_FILE_ATTRIBUTES)
 		pFloppy->m_bWriteProtected = false;	// Assume this is a new file to create (so it must be write-enabled to allow it to be formatted)
 	else
-		pFloppy->m_bWriteProtected = bForceWriteProtected ? true : (dwAttributes & FILE_ATTRIBUTE_READONLY);
+		pFloppy->m_bWriteProtected = bForceWriteProtected ? true : ((dwAttributes & FILE_ATTRIBUTE_READONLY) && !ImageGetOverlay());	// Overlay: a read-only image is still writable via its journal
 
 	// Check if image is being used by the other drive, and if so remove it in order so it can be swapped
 	{
@@ -1546,17 +1626,44 @@ void Disk2InterfaceCard::DataShiftWriteWOZ(WORD pc, WORD addr, ULONG uExecutedCy
 	LOG_DISK("T$%02X, bitOffset=%04X: %02X (%d bits)\n", drive.m_phase/2, floppy.m_bitOffset, m_shiftReg, bitCellRemainder);
 #endif
 
-	for (UINT i = 0; i < bitCellRemainder; i++)
+	// Write the bit-cells a byte at a time (rather than 1 bit-cell at a time), up to the next byte boundary or the end of the track:
+	// . the shiftReg's MSBs are aligned to the current bit-cell and merged into the track byte using a mask
+	// . once the shiftReg has been completely shifted out it's zero, so any whole bytes can just be zeroed
+	// NB. the resulting bitstream (and bitOffset, byte, bitMask & revs) is identical to shifting 1 bit-cell at a time
+	UINT remaining = bitCellRemainder;
+	while (remaining)
 	{
-		BYTE outputBit = m_shiftReg & 0x80;
-		m_shiftReg <<= 1;
+		_ASSERT(floppy.m_bitOffset < floppy.m_bitCount);
+		const UINT bitCell = floppy.m_bitOffset & 7;
+		const UINT toTrackEnd = floppy.m_bitCount - floppy.m_bitOffset;	// then wraps to bit-cell 0
+		UINT bits;
 
-		BYTE n = floppy.m_trackimage[floppy.m_byte];
-		n &= ~floppy.m_bitMask;
-		if (outputBit) n |= floppy.m_bitMask;
-		floppy.m_trackimage[floppy.m_byte] = n;
+		if (m_shiftReg == 0 && bitCell == 0 && remaining >= 8 && toTrackEnd >= 8)
+		{
+			const UINT bytes = MIN(remaining, toTrackEnd) / 8;
+			memset(&floppy.m_trackimage[floppy.m_byte], 0, bytes);
+			bits = bytes * 8;
+		}
+		else
+		{
+			bits = MIN(MIN(remaining, toTrackEnd), 8 - bitCell);
+			const BYTE mask = m_writeBitCellMask[bitCell][bits];
+			BYTE& n = floppy.m_trackimage[floppy.m_byte];
+			n = (n & ~mask) | ((m_shiftReg >> bitCell) & mask);
+			m_shiftReg = (BYTE)(m_shiftReg << bits);
+		}
 
-		IncBitStream(floppy);
+		const UINT oldBitOffset = floppy.m_bitOffset;
+		floppy.m_bitOffset += bits;
+		if (floppy.m_bitOffset == floppy.m_bitCount)
+			floppy.m_bitOffset = 0;
+
+		// As IncBitStream(): count passing the initial bitOffset (after each bit-cell)
+		if ((floppy.m_initialBitOffset > oldBitOffset && floppy.m_initialBitOffset < oldBitOffset + bits) || floppy.m_initialBitOffset == floppy.m_bitOffset)
+			floppy.m_revs++;
+
+		UpdateBitStreamOffsets(floppy);
+		remaining -= bits;
 	}
 
 	floppy.m_trackimagedirty = true;
@@ -1584,6 +1691,7 @@ void Disk2InterfaceCard::FindTrackSeamWOZ(FloppyDisk& floppy, float track)
 	int longestSyncFFRunLength = 0;
 
 	floppy.m_longestSyncFFBitOffsetStart = -1;
+	floppy.m_longestSyncFFRunLength = 0;
 
 	while (1)
 	{
@@ -1665,6 +1773,333 @@ void Disk2InterfaceCard::FindTrackSeamWOZ(FloppyDisk& floppy, float track)
 
 //===========================================================================
 
+// Fast-load (opt-in, see m_fastLoad):
+// . For a standard DOS 3.3 RWTS (READ16) or ProDOS 8 Disk II driver sector read, satisfy the whole data field in one go:
+//   decode it straight from the track and copy it into 6502 memory (like the HDD's DMA), instead of shifting ~350 nibbles through the latch.
+// . Triggered on the routine's 1st latch read of its data prologue search (ie. just after LDY #$20 / DEY), identified via the I/O access's PC.
+// . The routine's code must match exactly (only relocatable operands are wildcards), so patched RWTSs (eg. copy-protection) just run as normal.
+// . The nibbles are consumed exactly as the routine would; if anything is non-standard (no prologue found in time, bad nibble, bad checksum,
+//   DMA to I/O or ROM) then nothing is changed and the real sequencer continues.
+// . On success the drive is left just after the data field's checksum nibble and the 6502 resumes at the routine's epilogue check,
+//   so the routine still reads the DE AA epilogue itself and returns via its own CLC/RTS.
+// . Cycle accounting is synthetic: the skipped latch reads cost no 6502 cycles.
+
+Disk2InterfaceCard::FASTLOAD_ROUTINE Disk2InterfaceCard::FastLoadMatchRoutine(WORD entry)
+{
+	// Quick reject: LDY #$20 / DEY / BEQ / LDA $C08C,X
+	if (ReadByteFromMemory(entry+0) != 0xA0 || ReadByteFromMemory(entry+1) != 0x20 || ReadByteFromMemory(entry+5) != 0xBD)
+		return FL_NONE;
+
+	struct { FASTLOAD_ROUTINE routine; const short* pCode; UINT size; } routines[] =
+	{
+		{ FL_DOS33_READ16, m_fastLoadDOS33Read16, sizeof(m_fastLoadDOS33Read16) / sizeof(m_fastLoadDOS33Read16[0]) },
+		{ FL_PRODOS_READ, m_fastLoadProDOSRead, sizeof(m_fastLoadProDOSRead) / sizeof(m_fastLoadProDOSRead[0]) },
+	};
+
+	for (UINT i = 0; i < sizeof(routines) / sizeof(routines[0]); i++)
+	{
+		UINT j = 0;
+		for (; j < routines[i].size; j++)
+		{
+			const short code = routines[i].pCode[j];
+			if (code >= 0 && code != ReadByteFromMemory(entry + j))
+				break;
+		}
+
+		if (j == routines[i].size)
+			return routines[i].routine;
+	}
+
+	return FL_NONE;
+}
+
+// Read ahead without changing the drive's state. For WOZ this is the LSS's read sequence, but without weak-bit randomness.
+bool Disk2InterfaceCard::FastLoadNextNibble(FastLoadReader& reader, BYTE& nibble)
+{
+	const FloppyDisk& floppy = m_floppyDrive[m_currDrive].m_disk;
+
+	if (!ImageIsWOZ(floppy.m_imagehandle))
+	{
+		if (reader.count++ >= (UINT)floppy.m_nibbles * 2)
+			return false;
+
+		nibble = floppy.m_trackimage[reader.byte];
+		if (++reader.byte >= floppy.m_nibbles)
+			reader.byte = 0;
+
+		return true;
+	}
+
+	while (reader.count++ < floppy.m_bitCount * 2)
+	{
+		reader.headWindow <<= 1;
+		reader.headWindow |= (floppy.m_trackimage[reader.byte] & reader.bitMask) ? 1 : 0;
+		const BYTE outputBit = (reader.headWindow & 0xf) ? (reader.headWindow >> 1) & 1 : 0;
+
+		reader.bitMask >>= 1;
+		if (!reader.bitMask)
+		{
+			reader.bitMask = 1 << 7;
+			reader.byte++;
+		}
+
+		if (++reader.bitOffset == floppy.m_bitCount)
+		{
+			reader.bitMask = 1 << 7;
+			reader.bitOffset = 0;
+			reader.byte = 0;
+		}
+
+		reader.shiftReg <<= 1;
+		reader.shiftReg |= outputBit;
+
+		if (reader.shiftReg & 0x80)
+		{
+			nibble = reader.shiftReg;
+			reader.shiftReg = 0;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Same control flow as both routines' D5 AA AD search, including the Y retry count
+bool Disk2InterfaceCard::FastLoadFindDataPrologue(FastLoadReader& reader, BYTE firstNibble, BYTE& y, bool reloadY)
+{
+	BYTE nibble = firstNibble;
+
+	while (1)
+	{
+		if (!(nibble & 0x80) || nibble != 0xD5)
+		{
+			if (--y == 0)
+				return false;
+			if (!FastLoadNextNibble(reader, nibble))
+				return false;
+			continue;
+		}
+
+		if (!FastLoadNextNibble(reader, nibble))
+			return false;
+		if (nibble != 0xAA)
+			continue;
+
+		if (reloadY)
+			y = 0x56;
+
+		if (!FastLoadNextNibble(reader, nibble))
+			return false;
+		if (nibble != 0xAD)
+			continue;
+
+		return true;
+	}
+}
+
+static bool FastLoadIsWritable(WORD addr, UINT size)
+{
+	for (UINT i = 0; i < size; i += _6502_PAGE_SIZE)
+	{
+		if (!memwrite[((addr + i) & 0xffff) >> 8])
+			return false;
+	}
+	return memwrite[((addr + size - 1) & 0xffff) >> 8] != NULL;
+}
+
+// Pre: FastLoadIsWritable()
+static void FastLoadWrite(WORD addr, const BYTE* pSrc, UINT size)
+{
+	for (UINT i = 0; i < size; i++)
+	{
+		const WORD dstAddr = (addr + i) & 0xffff;
+		memdirty[dstAddr >> 8] = 0xFF;
+		*(memwrite[dstAddr >> 8] + (dstAddr & 0xff)) = pSrc[i];
+	}
+}
+
+void Disk2InterfaceCard::FastLoadDataField(WORD pc)
+{
+	FloppyDrive& drive = m_floppyDrive[m_currDrive];
+	FloppyDisk& floppy = drive.m_disk;
+
+	if (m_seqFunc.function != readSequencing || !drive.m_spinning || !floppy.m_trackimagedata || g_nAppMode == MODE_STEPPING)
+		return;
+
+	// Only for the routine's 1st latch read (Y=$1F), and only try once per call of the routine
+	if (regs.y != 0x1F)
+	{
+		m_fastLoadFailedPC = 0;
+		return;
+	}
+
+	if (pc == m_fastLoadFailedPC)
+		return;
+
+	m_fastLoadFailedPC = pc;	// Assume failure
+
+	// NB. PC is after the 1st LDA $C08C,X of the routine
+	const WORD entry = pc - 8;
+	const FASTLOAD_ROUTINE routine = FastLoadMatchRoutine(entry);
+	if (routine == FL_NONE)
+		return;
+
+	const bool isWOZ = ImageIsWOZ(floppy.m_imagehandle);
+
+	FastLoadReader reader;
+	reader.bitOffset = floppy.m_bitOffset;
+	reader.byte = floppy.m_byte;
+	reader.bitMask = floppy.m_bitMask;
+	reader.headWindow = drive.m_headWindow;
+	reader.shiftReg = isWOZ ? m_shiftReg : 0;
+	reader.count = 0;
+
+	// The current latch is the 1st nibble read by the routine (NIB: this read has already advanced m_byte past it)
+	BYTE nibble = m_floppyLatch;
+	if (!(nibble & 0x80) && !FastLoadNextNibble(reader, nibble))
+		return;
+
+	BYTE y = regs.y;
+	if (!FastLoadFindDataPrologue(reader, nibble, y, routine == FL_DOS33_READ16))
+		return;
+
+	// Data field: 86 nibbles for the 2-bit fragments, then 256 for the 6-bit parts, then the checksum
+
+	const UINT kDataNibbles = 0x56 + 0x100;
+	BYTE data[kDataNibbles + 1];
+	for (UINT i = 0; i < kDataNibbles + 1; i++)
+	{
+		if (!FastLoadNextNibble(reader, data[i]))
+			return;
+	}
+
+	if (routine == FL_DOS33_READ16)
+	{
+		// Decode as READ16 does, using the RWTS's own DNIBL table: NBUF2 (in reverse order) & NBUF1 hold the (checksum-chained) 6-bit values
+		const WORD dnibl = ReadWordFromMemory(entry + 0x2E);
+		const WORD nbuf2 = ReadWordFromMemory(entry + 0x33);
+		const WORD nbuf1 = ReadWordFromMemory(entry + 0x44);
+
+		BYTE buf2[0x56];
+		BYTE buf1[0x100];
+		BYTE a = 0;
+		for (UINT i = 0; i < kDataNibbles; i++)
+		{
+			a ^= ReadByteFromMemory(dnibl + data[i]);
+			if (i < 0x56)
+				buf2[0x55 - i] = a;
+			else
+				buf1[i - 0x56] = a;
+		}
+
+		const BYTE checksum = data[kDataNibbles];
+		if (a != ReadByteFromMemory(dnibl + checksum))
+			return;
+
+		if (!FastLoadIsWritable(nbuf2, sizeof(buf2)) || !FastLoadIsWritable(nbuf1, sizeof(buf1)) || !FastLoadIsWritable(0x0026, 1))
+			return;
+
+		FastLoadWrite(nbuf2, buf2, sizeof(buf2));
+		FastLoadWrite(nbuf1, buf1, sizeof(buf1));
+		const BYTE idx = 0xFF;
+		FastLoadWrite(0x0026, &idx, 1);	// IDX
+
+		regs.a = a;
+		regs.y = checksum;
+		regs.pc = entry + 0x53;		// LDA $C08C,X / CMP #$DE
+	}
+	else	// FL_PRODOS_READ
+	{
+		// Standard 6&2 decode (the driver denibblizes on-the-fly straight into the caller's buffer at ($44))
+		static BYTE sixBitValue[0x80];
+		static bool sixBitValueInit = false;
+		if (!sixBitValueInit)
+		{
+			memset(sixBitValue, 0xFF, sizeof(sixBitValue));
+			BYTE value = 0;
+			for (UINT n = 0x96; n <= 0xFF; n++)
+			{
+				// Valid disk bytes: at least 2 adjacent 1 bits (excluding bit7), and no more than 1 pair of adjacent 0 bits
+				bool adjacentOnes = false;
+				UINT adjacentZeros = 0;
+				for (UINT bit = 0; bit < 6; bit++)
+				{
+					const UINT pair = (n >> bit) & 3;
+					if (pair == 3) adjacentOnes = true;
+					if (pair == 0) adjacentZeros++;
+				}
+				if (adjacentOnes && adjacentZeros <= 1)
+					sixBitValue[n & 0x7F] = value++;
+			}
+			_ASSERT(value == 0x40);
+			sixBitValueInit = true;
+		}
+
+		BYTE values[kDataNibbles];
+		BYTE a = 0;
+		for (UINT i = 0; i < kDataNibbles + 1; i++)
+		{
+			const BYTE value = sixBitValue[data[i] & 0x7F];
+			if (value == 0xFF)
+				return;
+			a ^= value;
+			if (i < kDataNibbles)
+				values[i] = a;
+		}
+
+		if (a != 0)		// checksum
+			return;
+
+		BYTE sector[0x100];
+		for (UINT i = 0; i < 0x100; i++)
+		{
+			const BYTE twoBits = values[i % 0x56] >> ((i / 0x56) * 2);
+			sector[i] = (values[0x56 + i] << 2) | ((twoBits & 1) << 1) | ((twoBits >> 1) & 1);
+		}
+
+		const WORD buffer = ReadWordFromMemory(0x0044);
+		if (!FastLoadIsWritable(buffer, sizeof(sector)) || !memwrite[_6502_STACK_PAGE])
+			return;
+
+		FastLoadWrite(buffer, sector, sizeof(sector));
+
+		// The driver stores the byte at offset $55 last, via: PHA ... PLA / LDY #$55 / STA ($44),Y
+		*(memwrite[_6502_STACK_PAGE] + (regs.sp & 0xFF)) = sector[0x55];
+		regs.sp--;
+		if (regs.sp < _6502_STACK_BEGIN)
+			regs.sp = _6502_STACK_END;
+
+		regs.y = 0;
+		regs.pc = entry + 0x8F;		// LDX $3E / LDA $C08C,X / CMP #$DE
+	}
+
+	// Success: leave the drive just after the checksum nibble
+
+	if (isWOZ)
+	{
+		floppy.m_bitOffset = reader.bitOffset;
+		UpdateBitStreamOffsets(floppy);
+		floppy.m_extraCycles = 0.0;
+		drive.m_headWindow = reader.headWindow;
+		m_shiftReg = 0;
+		m_latchDelay = 0;
+	}
+	else
+	{
+		floppy.m_byte = reader.byte;
+	}
+
+	m_diskLastCycle = g_nCumulativeCycles;
+	m_floppyLatch = 0;	// no nibble ready yet
+	m_fastLoadFailedPC = 0;
+
+#if LOG_DISK_FAST_LOAD
+	LOG_DISK("fast-load: %s T%s (entry=%04X)\r\n", routine == FL_DOS33_READ16 ? "RWTS" : "ProDOS", GetCurrentTrackString().c_str(), entry);
+#endif
+}
+
+//===========================================================================
+
 #ifdef _DEBUG
 // Dump nibbles from current position bitstream wraps to same position
 // NB. Need to define LOG_DISK_NIBBLES_READ so that GetReadD5AAxxDetectedString() works.
@@ -2114,6 +2549,8 @@ void Disk2InterfaceCard::SetSequencerFunction(WORD addr, ULONG executedCycles)
 
 BYTE __stdcall Disk2InterfaceCard::IORead(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles)
 {
+	PerfMarker perfMarker(PERF_DISK2);
+
 	CpuCalcCycles(nExecutedCycles);	// g_nCumulativeCycles needed by most Disk I/O functions
 
 	UINT uSlot = ((addr & 0xff) >> 4) - 8;
@@ -2153,6 +2590,9 @@ BYTE __stdcall Disk2InterfaceCard::IORead(WORD pc, WORD addr, BYTE bWrite, BYTE
 		if (isWOZ && pCard->m_seqFunc.function != dataShiftWrite)
 			pCard->DataLatchReadWriteWOZ(pc, addr, bWrite, nExecutedCycles);
 
+		if (pCard->m_fastLoad && (addr & 0xF) == 0xC)
+			pCard->FastLoadDataField(pc);
+
 		return pCard->m_floppyLatch;
 	}
 
@@ -2161,6 +2601,8 @@ BYTE __stdcall Disk2InterfaceCard::IORead(WORD pc, WORD addr, BYTE bWrite, BYTE
 
 BYTE __stdcall Disk2InterfaceCard::IOWrite(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles)
 {
+	PerfMarker perfMarker(PERF_DISK2);
+
 	CpuCalcCycles(nExecutedCycles);	// g_nCumulativeCycles needed by most Disk I/O functions
 
 	UINT uSlot = ((addr & 0xff) >> 4) - 8;
@@ -2334,10 +2776,40 @@ bool Disk2InterfaceCard::LoadSnapshotFloppy(YamlLoadHelper& yamlLoadHelper, UINT
 	const std::string simpleFilename = yamlLoadHelper.LoadString(SS_YAML_KEY_FILENAME);
 	const std::string absolutePath = version >= 9 ? yamlLoadHelper.LoadString(SS_YAML_KEY_ABSOLUTE_PATH) : "";
 
+	FloppyDisk& floppy = m_floppyDrive[unit].m_disk;
+
 	std::string filename = simpleFilename;
 	bool bImageError = filename.empty();
 
-	if (!bImageError)
+	if (!bImageError && !absolutePath.empty() && floppy.m_imagehandle && absolutePath == ImageGetPathname(floppy.m_imagehandle))
+	{
+		// Same disk already in this drive (eg. card kept by an in-memory load for rewind or run-ahead):
+		// keep the image and the track buffer, so nothing is re-opened or re-read
+		// . the current track isn't flushed: it's replaced by the state's track
+		FloppyDisk disk;
+		disk.m_imagename = floppy.m_imagename;
+		disk.m_fullname = floppy.m_fullname;
+		disk.m_strFilenameInZip = floppy.m_strFilenameInZip;
+		disk.m_imagehandle = floppy.m_imagehandle;
+		disk.m_bWriteProtected = floppy.m_bWriteProtected;
+		disk.m_trackimage = floppy.m_trackimage;
+		m_floppyDrive[unit].clear();
+		floppy = disk;
+	}
+	else
+	{
+		EjectDisk(unit);	// Remove any disk & update Registry to reflect empty drive
+
+		// Also eject Drive-2's disk if it's to be inserted into Drive-1
+		const int otherDrive = !unit;
+		const FloppyDisk& otherFloppy = m_floppyDrive[otherDrive].m_disk;
+		if (unit == DRIVE_1 && otherFloppy.m_imagehandle && (absolutePath.empty() || absolutePath == ImageGetPathname(otherFloppy.m_imagehandle)))
+			EjectDisk(otherDrive);
+
+		m_floppyDrive[unit].clear();
+	}
+
+	if (!bImageError && !floppy.m_imagehandle)
 	{
 		DWORD dwAttributes = GetFileAttributes(filename.c_str());
 		if (dwAttributes == INVALID_FILE_ATTRIBUTES && !absolutePath.empty())
@@ -2539,13 +3011,11 @@ bool Disk2InterfaceCard::LoadSnapshot(YamlLoadHelper& yamlLoadHelper, UINT versi
 		m_deferredStepperCumulativeCycles = yamlLoadHelper.LoadUint64(SS_YAML_KEY_DEFERRED_STEPPER_CYCLE);
 	}
 
-	// Eject all disks first in case Drive-2 contains disk to be inserted into Drive-1
-	for (UINT i=0; i<NUM_DRIVES; i++)
-	{
-		EjectDisk(i);	// Remove any disk & update Registry to reflect empty drive
-		m_floppyDrive[i].clear();
-	}
+	// Remove any deferred stepper event of a card kept by an in-memory load (re-inserted below if in the state)
+	if (m_syncEvent.m_active)
+		g_SynchronousEventMgr.Remove(m_syncEvent.m_id);
 
+	// NB. LoadSnapshotFloppy() resets each drive: it keeps the disk if it's in the same drive in the state, else ejects it
 	LoadSnapshotDriveUnit(yamlLoadHelper, DRIVE_1, version);
 	LoadSnapshotDriveUnit(yamlLoadHelper, DRIVE_2, version);
 
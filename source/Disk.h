@@ -146,6 +146,7 @@ public:
 
 	void Boot(void);
 	void FlushCurrentTrack(const int drive);
+	bool DetachImages(void);
 
 	const std::string & GetFullDiskFilename(const int drive);
 	const std::string & DiskGetFullPathName(const int drive);
@@ -194,6 +195,8 @@ public:
 
 	bool GetEnhanceDisk(void);
 	void SetEnhanceDisk(bool bEnhanceDisk);
+	bool GetFastLoad(void);
+	void SetFastLoad(bool bFastLoad);
 
 	static BYTE __stdcall IORead(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles);
 	static BYTE __stdcall IOWrite(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles);
@@ -230,6 +233,21 @@ private:
 	void AddJitter(int phase, FloppyDisk& floppy);
 	void AddTrackSeamJitter(float phasePrecise, FloppyDisk& floppy);
 
+	enum FASTLOAD_ROUTINE {FL_NONE=0, FL_DOS33_READ16, FL_PRODOS_READ};
+	struct FastLoadReader
+	{
+		UINT bitOffset;		// WOZ
+		int byte;
+		BYTE bitMask;		// WOZ
+		BYTE headWindow;	// WOZ
+		BYTE shiftReg;		// WOZ
+		UINT count;			// # bit-cells (WOZ) or nibbles read
+	};
+	FASTLOAD_ROUTINE FastLoadMatchRoutine(WORD entry);
+	bool FastLoadNextNibble(FastLoadReader& reader, BYTE& nibble);
+	bool FastLoadFindDataPrologue(FastLoadReader& reader, BYTE firstNibble, BYTE& y, bool reloadY);
+	void FastLoadDataField(WORD pc);
+
 	void SaveSnapshotFloppy(YamlSaveHelper& yamlSaveHelper, UINT unit);
 	void SaveSnapshotDriveUnit(YamlSaveHelper& yamlSaveHelper, UINT unit);
 	bool LoadSnapshotFloppy(YamlLoadHelper& yamlLoadHelper, UINT unit, UINT version, std::vector<BYTE>& track);
@@ -272,6 +290,8 @@ private:
 	unsigned __int64 m_diskLastReadLatchCycle;
 	FormatTrack m_formatTrack;
 	bool m_enhanceDisk;
+	bool m_fastLoad;
+	WORD m_fastLoadFailedPC;
 
 	static const UINT SPINNING_CYCLES = 1000*1000;		// 1M cycles = ~1.000s
 	static const UINT WRITELIGHT_CYCLES = 1000*1000;	// 1M cycles = ~1.000s
@@ -301,6 +321,13 @@ private:
 	unsigned __int64 m_deferredStepperCumulativeCycles;
 	SyncEvent m_syncEvent;
 
+	// Fast-load: code of the recognised sector read routines (-1 = any byte)
+	static const short m_fastLoadDOS33Read16[];
+	static const short m_fastLoadProDOSRead[];
+
+	// WOZ write: mask of the n bit-cells starting at bit-cell b (MSB first) of a track byte, indexed [b][n]
+	static const BYTE m_writeBitCellMask[8][9];
+
 	// Jitter (GH#930)
 	static const BYTE m_T00S00Pattern[];
 	UINT m_T00S00PatternIdx;
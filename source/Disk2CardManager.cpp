@@ -94,6 +94,30 @@ void Disk2CardManager::SetEnhanceDisk(bool enhanceDisk)
 	}
 }
 
+bool Disk2CardManager::GetFastLoad(void)
+{
+	for (UINT i = 0; i < NUM_SLOTS; i++)
+	{
+		if (GetCardMgr().QuerySlot(i) == CT_Disk2)
+		{
+			// All Disk2 cards should have the same setting, so just return the state of the first card
+			return dynamic_cast<Disk2InterfaceCard&>(GetCardMgr().GetRef(i)).GetFastLoad();
+		}
+	}
+	return false;
+}
+
+void Disk2CardManager::SetFastLoad(bool fastLoad)
+{
+	for (UINT i = 0; i < NUM_SLOTS; i++)
+	{
+		if (GetCardMgr().QuerySlot(i) == CT_Disk2)
+		{
+			dynamic_cast<Disk2InterfaceCard&>(GetCardMgr().GetRef(i)).SetFastLoad(fastLoad);
+		}
+	}
+}
+
 void Disk2CardManager::LoadLastDiskImage(void)
 {
 	for (UINT i = 0; i < NUM_SLOTS; i++)
@@ -106,24 +106,22 @@ void FormatTrack::UpdateOnWriteLatch(UINT uSpinNibbleCount, const FloppyDisk* co
 		return;
 	}
 
-	UINT uTrackIndex = pFloppy->m_byte;
-	const UINT& kTrackMaxNibbles = pFloppy->m_nibbles;
+	const UINT uTrackIndex = pFloppy->m_byte;
+	const UINT kTrackMaxNibbles = pFloppy->m_nibbles;
 
 	// NB. spin in write mode is only max 1-2 bytes
-	do
-	{
-		if (m_WriteTrackStartIndex == uTrackIndex)	// disk has completed a revolution
-		{
-			// Occurs for: .dsk & enhance=0|1 & ProDOS-FORMAT/DOS3.3-INIT with big gap3 size (as trackimage is only 0x18F0 in size)
-			m_WriteTrackHasWrapped = true;
+	// Check the whole batch of nibbles [uTrackIndex, uTrackIndex+uSpinNibbleCount] (mod track size) at once, rather than stepping through them
+	const bool bStartIndexPassed = (m_WriteTrackStartIndex == uTrackIndex)
+		|| (m_WriteTrackStartIndex < kTrackMaxNibbles && uTrackIndex < kTrackMaxNibbles
+			&& (m_WriteTrackStartIndex + kTrackMaxNibbles - uTrackIndex) % kTrackMaxNibbles <= uSpinNibbleCount);
 
-			// Now wait until drive switched from write to read mode
-			return;
-		}
+	if (bStartIndexPassed)	// disk has completed a revolution
+	{
+		// Occurs for: .dsk & enhance=0|1 & ProDOS-FORMAT/DOS3.3-INIT with big gap3 size (as trackimage is only 0x18F0 in size)
+		m_WriteTrackHasWrapped = true;
 
-		uTrackIndex = (uTrackIndex+1) % kTrackMaxNibbles;
+		// Now wait until drive switched from write to read mode
 	}
-	while (uSpinNibbleCount--);
 }
 
 void FormatTrack::DriveSwitchedToReadMode(FloppyDisk* const pFloppy)
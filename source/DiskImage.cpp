@@ -31,6 +31,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "DiskImage.h"
 #include "Common.h"
 #include "DiskImageHelper.h"
+#include "Log.h"
 
 
 static CDiskImageHelper sg_DiskImageHelper;
@@ -106,6 +107,13 @@ void ImageClose(ImageInfo* const pImageInfo)
 
 //===========================================================================
 
+bool ImageDetach(ImageInfo* const pImageInfo)
+{
+	return pImageInfo->pImageHelper->Detach(pImageInfo);
+}
+
+//===========================================================================
+
 BOOL ImageBoot(ImageInfo* const pImageInfo)
 {
 	BOOL result = 0;
@@ -169,6 +177,10 @@ void ImageWriteTrack(	ImageInfo* const pImageInfo,
 			uint32_t dummy;
 			bool res = sg_DiskImageHelper.WOZUpdateInfo(pImageInfo, dummy);
 			_ASSERT(res);
+
+			WOZTrackInfo* pTrackInfo = ImageGetWOZTrackInfo(pImageInfo, phase);
+			if (pTrackInfo)
+				pTrackInfo->valid = false;	// bitstream has changed, so re-scan on next read
 		}
 	}
 }
@@ -232,6 +244,27 @@ BYTE ImageGetOptimalBitTiming(ImageInfo* const pImageInfo)
 	return pImageInfo ? pImageInfo->optimalBitTiming : 32;
 }
 
+// Lazily filled in by the caller on the 1st visit to each track, and invalidated by ImageWriteTrack()
+// . Quarter tracks that map (via TMAP) to the same TRKS entry share the same info
+WOZTrackInfo* ImageGetWOZTrackInfo(ImageInfo* const pImageInfo, const float phase)
+{
+	if (!ImageIsWOZ(pImageInfo) || !pImageInfo->pWOZTrackMap)
+		return NULL;
+
+	const UINT quarterTrack = (UINT)(phase * 2);
+	if (quarterTrack >= CWOZHelper::MAX_QUARTER_TRACKS_5_25)
+		return NULL;
+
+	if (pImageInfo->wozTrackInfo.empty())
+	{
+		const WOZTrackInfo invalid = {};
+		pImageInfo->wozTrackInfo.resize(CWOZHelper::TMAP_TRACK_EMPTY + 1, invalid);
+	}
+
+	const BYTE indexFromTMAP = ((CWOZHelper::Tmap*)pImageInfo->pWOZTrackMap)->tmap[quarterTrack];
+	return &pImageInfo->wozTrackInfo[indexFromTMAP];
+}
+
 bool ImageIsBootSectorFormatSector13(ImageInfo* const pImageInfo)
 {
 	return pImageInfo ? pImageInfo->bootSectorFormat == CWOZHelper::bootSector13 : false;
@@ -259,6 +292,36 @@ UINT ImageGetMaxNibblesPerTrack(ImageInfo* const pImageInfo)
 	return pImageInfo ? pImageInfo->maxNibblesPerTrack : NIBBLES_PER_TRACK;
 }
 
+// Copy-on-write overlay journals (see CImageJournal): only affects images opened after this is set
+void ImageSetOverlay(const bool bOverlay)
+{
+	sg_DiskImageHelper.SetOverlay(bOverlay);
+	sg_HardDiskImageHelper.SetOverlay(bOverlay);
+}
+
+bool ImageGetOverlay(void)
+{
+	return sg_DiskImageHelper.GetOverlay();
+}
+
+// The session is part of the journal's filename (<image>.<session>.journal), so it mustn't reach another directory
+// . an invalid session is rejected: changes are then only kept in memory
+bool ImageSetOverlaySession(const std::string& session)
+{
+	const bool bValid = session.find_first_of("/\\") == std::string::npos && session.find("..") == std::string::npos;
+	if (!bValid)
+		LogFileOutput("Image journal: invalid session '%s' (no '/', '\\' or '..'), changes will only be kept in memory\n", session.c_str());
+
+	sg_DiskImageHelper.SetOverlaySession(bValid ? session : "");
+	sg_HardDiskImageHelper.SetOverlaySession(bValid ? session : "");
+	return bValid;
+}
+
+const std::string& ImageGetOverlaySession(void)
+{
+	return sg_DiskImageHelper.GetOverlaySession();
+}
+
 void GetImageTitle(LPCTSTR pPathname, std::string & pImageName, std::string & pFullName)
 {
 	char   imagetitle[ MAX_DISK_FULL_NAME+1 ];
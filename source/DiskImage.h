@@ -78,8 +78,19 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 struct ImageInfo;
 
+// WOZ only: data derived from a TRKS entry's bitstream, which is constant until the track is written
+struct WOZTrackInfo
+{
+	bool	valid;
+	UINT	bitCount;
+	int		nibbles;
+	int		longestSyncFFBitOffsetStart;	// track seam: -1 if no FF/10 sync run
+	UINT	longestSyncFFRunLength;
+};
+
 ImageError_e ImageOpen(const std::string & pszImageFilename, ImageInfo** ppImageInfo, bool* pWriteProtected, const bool bCreateIfNecessary, std::string& strFilenameInZip, const bool bExpectFloppy=true);
 void ImageClose(ImageInfo* const pImageInfo);
+bool ImageDetach(ImageInfo* const pImageInfo);	// eg. after fork(): own read-only file handle, writes are only kept in memory
 BOOL ImageBoot(ImageInfo* const pImageInfo);
 
 void ImageReadTrack(ImageInfo* const pImageInfo, float phase, LPBYTE pTrackImageBuffer, int* pNibbles, UINT* pBitCount, bool enhanceDisk);
@@ -93,8 +104,13 @@ const std::string & ImageGetPathname(ImageInfo* const pImageInfo);
 UINT ImageGetImageSize(ImageInfo* const pImageInfo);
 bool ImageIsWOZ(ImageInfo* const pImageInfo);
 BYTE ImageGetOptimalBitTiming(ImageInfo* const pImageInfo);
+WOZTrackInfo* ImageGetWOZTrackInfo(ImageInfo* const pImageInfo, const float phase);
 UINT ImagePhaseToTrack(ImageInfo* const pImageInfo, const float phase, const bool limit=true);
 UINT ImageGetMaxNibblesPerTrack(ImageInfo* const pImageInfo);
+void ImageSetOverlay(const bool bOverlay);
+bool ImageGetOverlay(void);
+bool ImageSetOverlaySession(const std::string& session);
+const std::string& ImageGetOverlaySession(void);
 bool ImageIsBootSectorFormatSector13(ImageInfo* const pImageInfo);
 
 void GetImageTitle(LPCTSTR pPathname, std::string & pImageName, std::string & pFullName);
@@ -56,6 +56,7 @@ ImageInfo::ImageInfo()
 	memset(&zipFileInfo, 0, sizeof(zipFileInfo));
 	uNumEntriesInZip = 0;
 	uNumValidImagesInZip = 0;
+	pJournal = NULL;
 	uNumTracks = 0;
 	pImageBuffer = NULL;
 	pWOZTrackMap = NULL;
@@ -138,6 +139,9 @@ bool CImageBase::ReadBlock(ImageInfo* pImageInfo, const int nBlock, LPBYTE pBloc
 
 	if (pImageInfo->FileType == eFileNormal)
 	{
+		if (pImageInfo->pJournal && pImageInfo->pJournal->ReadBlock(Offset, pBlockBuffer))
+			return true;
+
 		if (pImageInfo->hFile == INVALID_HANDLE_VALUE)
 			return false;
 
@@ -206,6 +210,9 @@ bool CImageBase::WriteBlock(ImageInfo* pImageInfo, const int nBlock, LPBYTE pBlo
 
 bool CImageBase::WriteImageData(ImageInfo* pImageInfo, LPBYTE pSrcBuffer, const UINT uSrcSize, const long offset)
 {
+	if (pImageInfo->pJournal)
+		return pImageInfo->pJournal->Write(pSrcBuffer, uSrcSize, offset);	// image file is never written (nor recompressed)
+
 	if (pImageInfo->FileType == eFileNormal)
 	{
 		if (pImageInfo->hFile == INVALID_HANDLE_VALUE)
@@ -1587,6 +1594,221 @@ eDetectResult CWOZHelper::ProcessChunks(ImageInfo* pImageInfo, uint32_t& dwOffse
 
 //-----------------------------------------------------------------------------
 
+// Replay the session's journal (creating it if necessary), and keep it locked until it's closed
+bool CImageJournal::Open(const std::string& imagePathname, const std::string& session, const UINT uBaseSize)
+{
+	m_uBaseSize = uBaseSize;
+
+	if (session.empty())
+	{
+		SetInMemory();
+		return true;
+	}
+
+	m_pathname = GetPathname(imagePathname, session);
+
+	// NB. Windows already fails to open it if another process has it open (no sharing)
+	m_hFile = CreateFile(m_pathname.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	OVERLAPPED overlapped = {};
+	if (m_hFile != INVALID_HANDLE_VALUE && !LockFileEx(m_hFile, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0, MAXDWORD, MAXDWORD, &overlapped))
+	{
+		CloseHandle(m_hFile);
+		m_hFile = INVALID_HANDLE_VALUE;
+	}
+
+	if (m_hFile == INVALID_HANDLE_VALUE)
+	{
+		// Another process is using this session: don't replay (nor write) its journal
+		LogFileOutput("Image journal: %s is in use (or can't be created), changes will only be kept in memory\n", m_pathname.c_str());
+		SetInMemory();
+		return true;
+	}
+
+	const DWORD dwFileSize = GetFileSize(m_hFile, NULL);
+	if (dwFileSize == 0)
+		return WriteHeader();
+
+	UINT32 hdr[2];
+	DWORD dwBytesRead;
+	if (!ReadFile(m_hFile, hdr, sizeof(hdr), &dwBytesRead, NULL) || hdr[0] != JOURNAL_ID || hdr[1] != m_uBaseSize)
+	{
+		// Don't replay (or overwrite) a journal that was made against a different image
+		LogFileOutput("Image journal: %s doesn't match the image (size=%08X), changes will only be kept in memory\n", m_pathname.c_str(), m_uBaseSize);
+		SetInMemory();
+		return true;
+	}
+
+	DWORD dwPos = sizeof(hdr);
+	std::vector<BYTE> data;
+	while (dwPos + 2*sizeof(UINT32) <= dwFileSize)
+	{
+		UINT32 rec[2];	// offset, size
+		if (!ReadFile(m_hFile, rec, sizeof(rec), &dwBytesRead, NULL))
+			break;
+		if (rec[1] > dwFileSize - dwPos - sizeof(rec))
+			break;	// truncated (eg. emulator was killed mid-write)
+
+		data.resize(rec[1]);
+		if (rec[1] && !ReadFile(m_hFile, &data[0], rec[1], &dwBytesRead, NULL))
+			break;
+
+		AddExtent(rec[0], data.empty() ? NULL : &data[0], rec[1]);
+		m_uNumRecords++;
+		dwPos += sizeof(rec) + rec[1];
+	}
+
+	if (m_uNumRecords > m_extents.size() || dwPos != dwFileSize)
+		return Compact();	// drop superseded extents (and any truncated record)
+
+	SetFilePointer(m_hFile, 0, NULL, FILE_END);
+	return true;
+}
+
+void CImageJournal::Close(void)
+{
+	if (m_hFile != INVALID_HANDLE_VALUE)
+	{
+		// Don't leave unused journals behind (deleted while still locked, so no other process is using it)
+		if (m_extents.empty())
+			DeleteFile(m_pathname.c_str());
+
+		CloseHandle(m_hFile);
+		m_hFile = INVALID_HANDLE_VALUE;
+	}
+
+	m_extents.clear();
+	m_extentAtOffset.clear();
+	m_uNumRecords = 0;
+}
+
+// Replay the journal over the image (growing the image buffer if tracks or blocks were appended)
+// . NB. harddisk-normal has no image buffer, so just its size is updated and blocks are read via ReadBlock()
+void CImageJournal::Apply(ImageInfo* pImageInfo)
+{
+	for (std::list<Extent>::const_iterator it = m_extents.begin(); it != m_extents.end(); ++it)
+	{
+		const UINT uEnd = it->offset + (UINT)it->data.size();
+
+		if (pImageInfo->pImageBuffer)
+		{
+			if (uEnd > pImageInfo->uImageSize)
+			{
+				BYTE* pNewImageBuffer = new BYTE[uEnd];
+				memcpy(pNewImageBuffer, pImageInfo->pImageBuffer, pImageInfo->uImageSize);
+				memset(&pNewImageBuffer[pImageInfo->uImageSize], 0, uEnd - pImageInfo->uImageSize);
+				delete [] pImageInfo->pImageBuffer;
+				pImageInfo->pImageBuffer = pNewImageBuffer;
+			}
+
+			if (!it->data.empty())
+				memcpy(&pImageInfo->pImageBuffer[it->offset], &it->data[0], it->data.size());
+		}
+
+		if (uEnd > pImageInfo->uImageSize)
+			pImageInfo->uImageSize = uEnd;
+	}
+}
+
+bool CImageJournal::Write(const BYTE* pSrcBuffer, const UINT uSrcSize, const UINT uOffset)
+{
+	if (m_bInMemory)
+	{
+		AddExtent(uOffset, pSrcBuffer, uSrcSize);
+		return true;
+	}
+
+	if (m_hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	AddExtent(uOffset, pSrcBuffer, uSrcSize);
+	m_uNumRecords++;
+
+	return WriteRecord(m_extents.back());
+}
+
+// Only for harddisk-normal: block writes are always whole, aligned blocks
+bool CImageJournal::ReadBlock(const UINT uOffset, LPBYTE pBlockBuffer)
+{
+	std::map<UINT, std::list<Extent>::iterator>::const_iterator it = m_extentAtOffset.find(uOffset);
+	if (it == m_extentAtOffset.end() || it->second->data.size() != HD_BLOCK_SIZE)
+		return false;
+
+	memcpy(pBlockBuffer, &it->second->data[0], HD_BLOCK_SIZE);
+	return true;
+}
+
+void CImageJournal::SetInMemory(void)
+{
+	if (m_hFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_hFile);
+		m_hFile = INVALID_HANDLE_VALUE;
+	}
+
+	m_bInMemory = true;
+}
+
+// Rewrite the journal in place: closing and recreating it would drop the lock
+bool CImageJournal::Compact(void)
+{
+	if (SetFilePointer(m_hFile, 0, NULL, FILE_BEGIN) == INVALID_SET_FILE_POINTER)
+		return false;
+
+	if (!WriteHeader())
+		return false;
+
+	for (std::list<Extent>::const_iterator it = m_extents.begin(); it != m_extents.end(); ++it)
+	{
+		if (!WriteRecord(*it))
+			return false;
+	}
+
+	if (!SetEndOfFile(m_hFile))
+		return false;
+
+	m_uNumRecords = m_extents.size();
+	return true;
+}
+
+bool CImageJournal::WriteHeader(void)
+{
+	const UINT32 hdr[2] = { JOURNAL_ID, m_uBaseSize };
+	DWORD dwBytesWritten;
+	BOOL bRes = WriteFile(m_hFile, hdr, sizeof(hdr), &dwBytesWritten, NULL);
+	return bRes && dwBytesWritten == sizeof(hdr);
+}
+
+bool CImageJournal::WriteRecord(const Extent& extent)
+{
+	const UINT32 rec[2] = { extent.offset, (UINT32)extent.data.size() };
+	DWORD dwBytesWritten;
+	BOOL bRes = WriteFile(m_hFile, rec, sizeof(rec), &dwBytesWritten, NULL);
+	if (!bRes || dwBytesWritten != sizeof(rec))
+		return false;
+
+	if (extent.data.empty())
+		return true;
+
+	bRes = WriteFile(m_hFile, &extent.data[0], extent.data.size(), &dwBytesWritten, NULL);
+	return bRes && dwBytesWritten == extent.data.size();
+}
+
+void CImageJournal::AddExtent(const UINT uOffset, const BYTE* pData, const UINT uSize)
+{
+	// A later write that completely covers the previous write at the same offset supersedes it
+	// (eg. a DSK track, HDV block or WOZ track - but not a shorter WOZ header following a header + TRKS write)
+	std::map<UINT, std::list<Extent>::iterator>::iterator it = m_extentAtOffset.find(uOffset);
+	if (it != m_extentAtOffset.end() && it->second->data.size() <= uSize)
+		m_extents.erase(it->second);
+
+	m_extents.push_back(Extent());
+	m_extents.back().offset = uOffset;
+	m_extents.back().data.assign(pData, pData + uSize);
+	m_extentAtOffset[uOffset] = --m_extents.end();
+}
+
+//-----------------------------------------------------------------------------
+
 // NB. Of the 6 cases (floppy/harddisk x gzip/zip/normal) only harddisk-normal isn't read entirely to memory
 // - harddisk-normal-create also doesn't create a max size image-buffer
 
@@ -1829,7 +2051,7 @@ ImageError_e CImageHelperBase::CheckNormalFile(LPCTSTR pszImageFilename, ImageIn
 
 	HANDLE& hFile = pImageInfo->hFile;
 
-	if (!pImageInfo->bWriteProtected)
+	if (!pImageInfo->bWriteProtected && !m_bOverlay)	// Overlay: the image file is only ever read
 	{
 		hFile = CreateFile(pszImageFilename,
                       GENERIC_READ | GENERIC_WRITE,
@@ -1852,7 +2074,7 @@ ImageError_e CImageHelperBase::CheckNormalFile(LPCTSTR pszImageFilename, ImageIn
 			FILE_ATTRIBUTE_NORMAL,
 			NULL );
 		
-		if (hFile != INVALID_HANDLE_VALUE)
+		if (hFile != INVALID_HANDLE_VALUE && !m_bOverlay)
 			pImageInfo->bWriteProtected = true;
 	}
 
@@ -2012,6 +2234,23 @@ ImageError_e CImageHelperBase::Open(	LPCTSTR pszImageFilename,
 	if (uNameLen == 0 || uNameLen >= MAX_PATH)
 		Err = eIMAGE_ERROR_FAILED_TO_GET_PATHNAME;
 
+	if (m_bOverlay && pImageInfo->pImageType->AllowRW())
+	{
+		pImageInfo->pJournal = new CImageJournal;
+		if (!pImageInfo->pJournal->Open(pImageInfo->szFilename, m_overlaySession, pImageInfo->uImageSize))
+			return eIMAGE_ERROR_BAD_FILE;
+
+		pImageInfo->pJournal->Apply(pImageInfo);
+
+		const eImageType imageType = pImageInfo->pImageType->GetType();
+		if (imageType == eImageWOZ1 || imageType == eImageWOZ2)
+		{
+			uint32_t dwOffset;	// TMAP & TRKS may have changed (and the image buffer may have been reallocated)
+			if (!WOZUpdateInfo(pImageInfo, dwOffset))
+				return eIMAGE_ERROR_BAD_FILE;
+		}
+	}
+
 	return eIMAGE_ERROR_NONE;
 }
 
@@ -2027,17 +2266,43 @@ void CImageHelperBase::Close(ImageInfo* pImageInfo)
 
 	pImageInfo->szFilename.clear();
 
+	delete pImageInfo->pJournal;
+	pImageInfo->pJournal = NULL;
+
 	delete [] pImageInfo->pImageBuffer;
 	pImageInfo->pImageBuffer = NULL;
 }
 
 //-------------------------------------
 
+// Stop sharing the image file with another process (eg. after fork()):
+// . reopen the image file read-only, as the old handle's file offset is shared
+// . from now on all writes go to an in-memory journal, so the image file (and any journal file) is never written
+bool CImageHelperBase::Detach(ImageInfo* pImageInfo)
+{
+	if (pImageInfo->hFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(pImageInfo->hFile);
+		pImageInfo->hFile = CreateFile(pImageInfo->szFilename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (pImageInfo->hFile == INVALID_HANDLE_VALUE)
+			return false;
+	}
+
+	if (!pImageInfo->pJournal)
+		pImageInfo->pJournal = new CImageJournal;
+
+	pImageInfo->pJournal->SetInMemory();
+	return true;
+}
+
+//-------------------------------------
+
 bool CImageHelperBase::WOZUpdateInfo(ImageInfo* pImageInfo, uint32_t& dwOffset)
 {
 	if (m_WOZHelper.ProcessChunks(pImageInfo, dwOffset) != eMatch)
 	{
-		GetFrame().FrameMessageBox("Malformed WOZ image.\nUnable to use this image.", "AppleWin: WOZ chunks", MB_ICONEXCLAMATION | MB_SETFOREGROUND);
+		if (m_bInteractive)
+			GetFrame().FrameMessageBox("Malformed WOZ image.\nUnable to use this image.", "AppleWin: WOZ chunks", MB_ICONEXCLAMATION | MB_SETFOREGROUND);
 		return false;
 	}
 
@@ -2123,7 +2388,9 @@ CImageBase* CDiskImageHelper::Detect(LPBYTE pImage, uint32_t dwSize, const char*
 		if (pWozHdr->crc32 && // WOZ spec: CRC of 0 should be ignored
 			pWozHdr->crc32 != crc32(0, pImage+sizeof(CWOZHelper::WOZHeader), dwSize-sizeof(CWOZHelper::WOZHeader)))
 		{
-			int res = GetFrame().FrameMessageBox("CRC mismatch.\nContinue using image?", "AppleWin: WOZ Header", MB_ICONSTOP | MB_SETFOREGROUND | MB_YESNO);
+			// Non-interactive: accept the image (the user is still asked when it's actually inserted)
+			int res = m_bInteractive ? GetFrame().FrameMessageBox("CRC mismatch.\nContinue using image?", "AppleWin: WOZ Header", MB_ICONSTOP | MB_SETFOREGROUND | MB_YESNO)
+									 : IDYES;
 			if (res == IDNO)
 				return NULL;
 		}
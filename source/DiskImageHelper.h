@@ -4,6 +4,8 @@
 #include "DiskImage.h"
 #include "minizip/zip.h"
 
+#include <list>
+
 #define GZ_SUFFIX ".gz"
 #define GZ_SUFFIX_LEN (sizeof(GZ_SUFFIX)-1)
 
@@ -16,6 +18,7 @@ enum eDetectResult {eMismatch, ePossibleMatch, eMatch};
 
 class CImageBase;
 class CImageHelperBase;
+class CImageJournal;
 
 enum FileType_e {eFileNormal, eFileGZip, eFileZip};
 
@@ -33,6 +36,7 @@ struct ImageInfo
 	zip_fileinfo	zipFileInfo;
 	UINT			uNumEntriesInZip;
 	UINT			uNumValidImagesInZip;
+	CImageJournal*	pJournal;			// Copy-on-write overlay (or NULL)
 	// Floppy only
 	UINT			uNumTracks;
 	BYTE*			pImageBuffer;
@@ -40,6 +44,7 @@ struct ImageInfo
 	BYTE			optimalBitTiming;	// WOZ only
 	BYTE			bootSectorFormat;	// WOZ only
 	UINT			maxNibblesPerTrack;
+	std::vector<WOZTrackInfo> wozTrackInfo;	// WOZ only: indexed by TMAP value (last entry is for the empty track)
 
 	ImageInfo();
 };
@@ -361,13 +366,63 @@ private:
 
 //-------------------------------------
 
+// Copy-on-write overlay:
+// . the image file is only opened for reading (and is never rewritten, so a .zip/.gz isn't recompressed on every write)
+// . all writes are appended to a sidecar journal (<image>.<session>.journal) as (offset, size, data) extents of the uncompressed image
+// . on open the session's journal is replayed over the image, so discarding a session's changes is just deleting the journal
+// . a journal is locked while its image is open: a 2nd process using the same session only keeps its changes in memory
+// . so does a journal made against a different image (which is left untouched)
+// . no session: the journal is only kept in memory, so each run starts from the image
+class CImageJournal
+{
+public:
+	CImageJournal(void) : m_hFile(INVALID_HANDLE_VALUE), m_uBaseSize(0), m_uNumRecords(0), m_bInMemory(false) {}
+	~CImageJournal(void) { Close(); }
+
+	bool Open(const std::string& imagePathname, const std::string& session, const UINT uBaseSize);
+	void Close(void);
+	void Apply(ImageInfo* pImageInfo);
+	bool Write(const BYTE* pSrcBuffer, const UINT uSrcSize, const UINT uOffset);
+	bool ReadBlock(const UINT uOffset, LPBYTE pBlockBuffer);
+	void SetInMemory(void);	// close the journal file: from now on writes are only kept in memory
+
+	static std::string GetPathname(const std::string& imagePathname, const std::string& session) { return imagePathname + "." + session + ".journal"; }
+
+private:
+	struct Extent
+	{
+		UINT offset;
+		std::vector<BYTE> data;
+	};
+
+	bool Compact(void);
+	bool WriteHeader(void);
+	bool WriteRecord(const Extent& extent);
+	void AddExtent(const UINT uOffset, const BYTE* pData, const UINT uSize);
+
+	static const UINT32 JOURNAL_ID = 0x314A5741;	// "AWJ1"
+
+	std::string m_pathname;
+	HANDLE m_hFile;
+	UINT m_uBaseSize;
+	UINT m_uNumRecords;					// in the file, including superseded ones
+	bool m_bInMemory;
+	std::list<Extent> m_extents;		// in write order: later extents take priority where they overlap
+	std::map<UINT, std::list<Extent>::iterator> m_extentAtOffset;
+};
+
+//-------------------------------------
+
 class CImageHelperBase
 {
 public:
 	CImageHelperBase(const bool bIsFloppy) :
 		m_2IMGHelper(bIsFloppy),
 		m_Result2IMG(eMismatch),
-		m_WOZHelper()
+		m_WOZHelper(),
+		m_bInteractive(true),
+		m_bOverlay(false),
+		m_overlaySession()
 	{
 	}
 	virtual ~CImageHelperBase(void)
@@ -378,7 +433,13 @@ public:
 
 	ImageError_e Open(LPCTSTR pszImageFilename, ImageInfo* pImageInfo, const bool bCreateIfNecessary, std::string& strFilenameInZip);
 	void Close(ImageInfo* pImageInfo);
+	bool Detach(ImageInfo* pImageInfo);
 	bool WOZUpdateInfo(ImageInfo* pImageInfo, uint32_t& dwOffset);
+	void SetInteractive(const bool bInteractive) { m_bInteractive = bInteractive; }	// false: never prompt the user (eg. for a background scan)
+	void SetOverlay(const bool bOverlay) { m_bOverlay = bOverlay; }	// true: open images read-only and journal all writes (see CImageJournal)
+	bool GetOverlay(void) { return m_bOverlay; }
+	void SetOverlaySession(const std::string& session) { m_overlaySession = session; }	// the journals to use ("": in memory only)
+	const std::string& GetOverlaySession(void) { return m_overlaySession; }
 
 	virtual CImageBase* Detect(LPBYTE pImage, uint32_t dwSize, const char* pszExt, uint32_t& dwOffset, ImageInfo* pImageInfo) = 0;
 	virtual CImageBase* GetImageForCreation(const char* pszExt, uint32_t* pCreateImageSize) = 0;
@@ -415,6 +476,9 @@ protected:
 	C2IMGHelper m_2IMGHelper;
 	eDetectResult m_Result2IMG;
 	CWOZHelper m_WOZHelper;
+	bool m_bInteractive;
+	bool m_bOverlay;
+	std::string m_overlaySession;
 };
 
 //-------------------------------------
@@ -16,6 +16,7 @@
 #define LOG_DISK_WOZ_SHIFTWRITE 1
 #define LOG_DISK_WOZ_READTRACK 1
 #define LOG_DISK_WOZ_TRACK_SEAM 1
+#define LOG_DISK_FAST_LOAD 1
 
 // __VA_ARGS__ not supported on MSVC++ .NET 7.x
 #if (LOG_DISK_ENABLED)
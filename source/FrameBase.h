@@ -37,6 +37,10 @@ public:
 	virtual void SetLoadedSaveStateFlag(const bool bFlag) = 0;
 
 	virtual void VideoPresentScreen(void) = 0;
+
+	// frameBuffer holds a whole frame: return the buffer to draw the next frame into
+	// (same size and layout as Video::GetFrameBuffer(), e.g. a texture or a buffer owned by another thread)
+	virtual uint8_t* VideoSwapFrameBuffer(uint8_t* frameBuffer) { return frameBuffer; }
 	virtual void ResizeWindow(void) = 0;
 
 	// this function has the same interface as MessageBox in windows.h
@@ -413,7 +413,7 @@ bool HarddiskInterfaceCard::Insert(const int iDrive, const std::string& pathname
 	if (dwAttributes == INVALID_FILE_ATTRIBUTES)
 		m_hardDiskDrive[iDrive].m_bWriteProtected = false;	// File doesn't exist - so ImageOpen() below will fail
 	else
-		m_hardDiskDrive[iDrive].m_bWriteProtected = (dwAttributes & FILE_ATTRIBUTE_READONLY) ? true : false;
+		m_hardDiskDrive[iDrive].m_bWriteProtected = ((dwAttributes & FILE_ATTRIBUTE_READONLY) && !ImageGetOverlay()) ? true : false;	// Overlay: writes go to the journal
 
 	// Check if image is being used by the other HDD, and unplug it in order to be swapped
 	{
@@ -521,6 +521,20 @@ void HarddiskInterfaceCard::Unplug(const int iDrive)
 
 //===========================================================================
 
+// eg. after fork(): see Disk2InterfaceCard::DetachImages()
+bool HarddiskInterfaceCard::DetachImages(void)
+{
+	for (UINT i = 0; i < NUM_HARDDISKS; i++)
+	{
+		if (m_hardDiskDrive[i].m_imagehandle && !ImageDetach(m_hardDiskDrive[i].m_imagehandle))
+			return false;
+	}
+
+	return true;
+}
+
+//===========================================================================
+
 #if 0	// Enable HDD command logging
 #define LOG_DISK(format, ...) LOG(format, __VA_ARGS__)
 #define DEBUG_SKIP_BUSY_STATUS 1
@@ -1306,19 +1320,18 @@ void HarddiskInterfaceCard::SaveSnapshot(YamlSaveHelper& yamlSaveHelper)
 	}
 }
 
-bool HarddiskInterfaceCard::LoadSnapshotHDDUnit(YamlLoadHelper& yamlLoadHelper, const UINT unit, const UINT version)
+bool HarddiskInterfaceCard::LoadSnapshotHDDUnit(YamlLoadHelper& yamlLoadHelper, const UINT unit, const UINT version, bool& lookedUpImage)
 {
 	const UINT baseUnitNum = (version >= 5) ? 1 : 0;
 
 	std::string hddUnitName = std::string(SS_YAML_KEY_HDDUNIT) + (char)('0' + baseUnitNum + unit);
 	if (!yamlLoadHelper.GetSubMap(hddUnitName))
-		return false;	// No HDD plugged in for this unit#
-
-	m_hardDiskDrive[unit].m_fullname.clear();
-	m_hardDiskDrive[unit].m_imagename.clear();
-	m_hardDiskDrive[unit].m_imageloaded = false;	// Default to false (until image is successfully loaded below)
-	m_hardDiskDrive[unit].m_status_next = DISK_STATUS_OFF;
-	m_hardDiskDrive[unit].m_status_prev = DISK_STATUS_OFF;
+	{
+		// No HDD plugged in for this unit#
+		Unplug(unit);
+		m_hardDiskDrive[unit].clear();
+		return false;
+	}
 
 	const std::string simpleFilename = yamlLoadHelper.LoadString(SS_YAML_KEY_FILENAME);
 	const std::string absolutePath = version >= 6 ? yamlLoadHelper.LoadString(SS_YAML_KEY_ABSOLUTE_PATH) : "";
@@ -1341,11 +1354,36 @@ bool HarddiskInterfaceCard::LoadSnapshotHDDUnit(YamlLoadHelper& yamlLoadHelper,
 
 	//
 
+	HardDiskDrive& drive = m_hardDiskDrive[unit];
+
+	if (!simpleFilename.empty() && !absolutePath.empty() && drive.m_imageloaded && absolutePath == ImageGetPathname(drive.m_imagehandle))
+	{
+		// Same image already in this unit (eg. card kept by an in-memory load for rewind or run-ahead): keep it, so it isn't re-opened
+		drive.m_status_next = diskStatusNext;
+		drive.m_status_prev = diskStatusPrev;
+		return false;
+	}
+
+	Unplug(unit);
+
+	// Also unplug a later unit's image if it's to be plugged in as this unit (eg. HDD-2 as HDD-1)
+	for (UINT i = unit + 1; i < NUM_HARDDISKS; i++)
+	{
+		if (m_hardDiskDrive[i].m_imageloaded && (absolutePath.empty() || absolutePath == ImageGetPathname(m_hardDiskDrive[i].m_imagehandle)))
+			Unplug(i);
+	}
+
+	drive.m_imageloaded = false;	// Default to false (until image is successfully loaded below)
+	drive.m_status_next = DISK_STATUS_OFF;
+	drive.m_status_prev = DISK_STATUS_OFF;
+
 	bool userSelectedImageFolder = false;
 
 	std::string filename = simpleFilename;
 	if (!filename.empty())
 	{
+		lookedUpImage = true;
+
 		DWORD dwAttributes = GetFileAttributes(filename.c_str());
 		if (dwAttributes == INVALID_FILE_ATTRIBUTES && !absolutePath.empty())
 		{
@@ -1430,18 +1468,13 @@ bool HarddiskInterfaceCard::LoadSnapshot(YamlLoadHelper& yamlLoadHelper, UINT ve
 			m_saveStateFirmwareValid = false;
 	}
 
-	// Unplug all HDDs first in case eg. HDD-2 is to be plugged in as HDD-1
-	for (UINT i = 0; i < NUM_HARDDISKS; i++)
-	{
-		Unplug(i);
-		m_hardDiskDrive[i].clear();
-	}
-
+	// NB. LoadSnapshotHDDUnit() keeps an image if it's in the same unit in the state (eg. card kept by an in-memory load), else unplugs it
 	bool userSelectedImageFolder = false;
+	bool lookedUpImage = false;
 	for (UINT i = 0; i < NUM_HARDDISKS; i++)
-		userSelectedImageFolder |= LoadSnapshotHDDUnit(yamlLoadHelper, i, version);
+		userSelectedImageFolder |= LoadSnapshotHDDUnit(yamlLoadHelper, i, version, lookedUpImage);
 
-	if (!userSelectedImageFolder)
+	if (lookedUpImage && !userSelectedImageFolder)
 		RegSaveString(REG_PREFS, REGVALUE_PREF_HDV_START_DIR, 1, Snapshot_GetPath());
 
 	GetFrame().FrameRefreshStatus(DRAW_LEDS | DRAW_DISK_STATUS);
@@ -1950,6 +1950,43 @@ static LPBYTE AllocMemImage(void)
 #endif
 }
 
+// The 64K pages of 'memimage' are shared mappings of the same file, so they are shared with a fork()ed process too.
+// Call this in the child: it moves 'memimage' (at the same address) to a new file, with a copy of its content.
+bool MemUnshareImage(void)
+{
+#ifdef _WIN32
+	return true;
+#else
+	if (!g_hMemTempFile)
+		return true;	// ALIGNED_ALLOC is private already
+
+	FILE * hNewFile = tmpfile();
+	if (!hNewFile)
+		return false;
+
+	const int fd = fileno(hNewFile);
+	bool ok = !ftruncate(fd, _6502_MEM_LEN) && pwrite(fd, memimage, _6502_MEM_LEN, 0) == ssize_t(_6502_MEM_LEN);
+	for (UINT i = 0; ok && i < num64KPages; i++)
+	{
+		void * target = memimage + i * _6502_MEM_LEN;
+		void * addr = mmap(target, _6502_MEM_LEN, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+		ok = (target == addr);
+	}
+
+	if (!ok)
+	{
+		// a partial remap would leave the pages out of sync
+		_ASSERT(0);
+		fclose(hNewFile);
+		return false;
+	}
+
+	fclose(g_hMemTempFile);
+	g_hMemTempFile = hNewFile;
+	return true;
+#endif
+}
+
 //===========================================================================
 
 void MemInitialize()
@@ -59,6 +59,7 @@ void	RegisterIoHandler(UINT uSlot, iofunction IOReadC0, iofunction IOWriteC0, io
 void	UnregisterIoHandler(UINT uSlot);
 
 void    MemDestroy ();
+bool    MemUnshareImage(void);
 bool	MemCheckSLOTC3ROM();
 bool	MemCheckINTCXROM();
 LPBYTE  MemGetAuxPtr(const WORD);
@@ -433,6 +433,7 @@ BYTE MockingboardCard::GetPCR(BYTE nDevice)
 // Called by:
 // . MB_SyncEventCallback() -> MockingboardCardManager::UpdateSoundBuffer() on a TIMER1 (not TIMER2) underflow - when IsAnyTimer1Active() == true (for any MB)
 // . MockingboardCardManager::Update()                                                                         - when IsAnyTimer1Active() == false (for all MB's)
+// Returns the number of samples for MB_Render() (called by MockingboardCardManager, maybe on its audio thread)
 UINT MockingboardCard::MB_Update(void)
 {
 	if (g_bFullSpeed)
@@ -504,28 +505,37 @@ UINT MockingboardCard::MB_Update(void)
 		nNumSamples = MAX_SAMPLES;	// Clamp to prevent buffer overflow
 
 	if (nNumSamples)
+		AY8910UpdateSetCycles();	// Subsequent AY reg writes are relative to this MB_Render()
+
+	return (UINT) nNumSamples;
+}
+
+// Synthesize the AY voices: all AY reg writes before the last MB_Update() must have been passed to the AY8913's
+UINT MockingboardCard::MB_Render(UINT nNumSamples)
+{
+	if (!nNumSamples)
+		return 0;
+
+	for (BYTE subunit = 0; subunit < NUM_SUBUNITS_PER_MB; subunit++)
 	{
-		for (BYTE subunit = 0; subunit < NUM_SUBUNITS_PER_MB; subunit++)
+		for (BYTE ay = 0; ay < NUM_AY8913_PER_SUBUNIT; ay++)
 		{
-			for (BYTE ay = 0; ay < NUM_AY8913_PER_SUBUNIT; ay++)
-			{
-				const UINT chip = subunit * NUM_AY8913_PER_SUBUNIT + ay;
-				AY8910Update(subunit, ay, &m_ppAYVoiceBuffer[chip * NUM_VOICES_PER_AY8913], nNumSamples);
-			}
+			const UINT chip = subunit * NUM_AY8913_PER_SUBUNIT + ay;
+			AY8910Update(subunit, ay, &m_ppAYVoiceBuffer[chip * NUM_VOICES_PER_AY8913], nNumSamples);
 		}
+	}
 
-		// Echo+ right speaker is also output to left speaker
-		if (m_isPhasorCard && m_phasorMode == PH_EchoPlus)
+	// Echo+ right speaker is also output to left speaker
+	if (m_isPhasorCard && m_phasorMode == PH_EchoPlus)
+	{
+		for (UINT j = 0; j < NUM_VOICES_PER_AY8913; j++)
 		{
-			for (UINT j = 0; j < NUM_VOICES_PER_AY8913; j++)
-			{
-				memcpy(m_ppAYVoiceBuffer[0 * NUM_VOICES_PER_AY8913 + j], m_ppAYVoiceBuffer[2 * NUM_VOICES_PER_AY8913 + j], nNumSamples * sizeof(short));
-				memcpy(m_ppAYVoiceBuffer[1 * NUM_VOICES_PER_AY8913 + j], m_ppAYVoiceBuffer[3 * NUM_VOICES_PER_AY8913 + j], nNumSamples * sizeof(short));
-			}
+			memcpy(m_ppAYVoiceBuffer[0 * NUM_VOICES_PER_AY8913 + j], m_ppAYVoiceBuffer[2 * NUM_VOICES_PER_AY8913 + j], nNumSamples * sizeof(short));
+			memcpy(m_ppAYVoiceBuffer[1 * NUM_VOICES_PER_AY8913 + j], m_ppAYVoiceBuffer[3 * NUM_VOICES_PER_AY8913 + j], nNumSamples * sizeof(short));
 		}
 	}
 
-	return (UINT) nNumSamples;
+	return nNumSamples;
 }
 
 //-----------------------------------------------------------------------------
@@ -541,6 +551,8 @@ void MockingboardCard::ReinitializeClock(void)
 
 void MockingboardCard::Destroy(void)
 {
+	SyncAudioThread();	// Voice buffers are about to be freed
+
 	for (UINT i = 0; i < NUM_SSI263; i++)
 		m_MBSubUnit[i].ssi263.DSUninit();
 
@@ -833,6 +845,8 @@ BYTE MockingboardCard::PhasorIOInternal(WORD PC, WORD nAddr, BYTE bWrite, BYTE n
 
 void MockingboardCard::SetPhasorMode(PHASOR_MODE newMode)
 {
+	SyncAudioThread();	// m_phasorMode is used by MB_Render()
+
 	m_phasorMode = newMode;
 
 	if (m_phasorMode == PH_Mockingboard || m_phasorMode == PH_EchoPlus)
@@ -1056,13 +1070,27 @@ void MockingboardCard::_AYWriteReg(BYTE subunit, BYTE ay, int r, int v)
 {
 	_ASSERT(subunit < NUM_SUBUNITS_PER_MB && ay < NUM_AY8913_PER_SUBUNIT);
 	libspectrum_dword uOffset = (libspectrum_dword)(g_nCumulativeCycles - m_lastAYUpdateCycle);
-	m_MBSubUnit[subunit].ay8913[ay].sound_ay_write(r, v, uOffset);
+	m_MBSubUnit[subunit].ay8913[ay].sound_ay_latch(r, v);
+
+	MockingboardCardManager& mbCardMgr = GetCardMgr().GetMockingboardCardMgr();
+	if (mbCardMgr.IsAudioThreadRunning())
+		mbCardMgr.PostAYWrite(this, subunit * NUM_AY8913_PER_SUBUNIT + ay, (BYTE)r, (BYTE)v, uOffset);
+	else
+		m_MBSubUnit[subunit].ay8913[ay].sound_ay_write(r, v, uOffset);
+}
+
+// Called by MockingboardCardManager's audio thread, for the AY reg writes posted by _AYWriteReg()
+void MockingboardCard::AY8910Write(UINT chip, BYTE r, BYTE v, UINT offset)
+{
+	_ASSERT(chip < NUM_SUBUNITS_PER_MB * NUM_AY8913_PER_SUBUNIT);
+	m_MBSubUnit[chip / NUM_AY8913_PER_SUBUNIT].ay8913[chip % NUM_AY8913_PER_SUBUNIT].sound_ay_write(r, v, offset);
 }
 
 void MockingboardCard::AY8910_reset(BYTE subunit, BYTE ay)
 {
 	// Don't reset the AY CLK, as this is a property of the card (MB/Phasor), not the AY chip
 	_ASSERT(subunit < NUM_SUBUNITS_PER_MB && ay < NUM_AY8913_PER_SUBUNIT);
+	SyncAudioThread();
 	m_MBSubUnit[subunit].ay8913[ay].sound_ay_reset();	// Calls: sound_ay_init();
 }
 
@@ -1074,8 +1102,6 @@ void MockingboardCard::AY8910UpdateSetCycles()
 void MockingboardCard::AY8910Update(BYTE subunit, BYTE ay, INT16** buffer, int nNumSamples)
 {
 	_ASSERT(subunit < NUM_SUBUNITS_PER_MB && ay < NUM_AY8913_PER_SUBUNIT);
-	AY8910UpdateSetCycles();
-
 	m_MBSubUnit[subunit].ay8913[ay].SetFramesize(nNumSamples);
 	m_MBSubUnit[subunit].ay8913[ay].SetSoundBuffers(buffer);
 	m_MBSubUnit[subunit].ay8913[ay].sound_frame();
@@ -1083,6 +1109,8 @@ void MockingboardCard::AY8910Update(BYTE subunit, BYTE ay, INT16** buffer, int n
 
 void MockingboardCard::AY8910_InitAll(int nClock, int nSampleRate)
 {
+	SyncAudioThread();
+
 	for (UINT subunit = 0; subunit < NUM_SUBUNITS_PER_MB; subunit++)
 	{
 		for (UINT ay = 0; ay < 2; ay++)
@@ -1095,6 +1123,7 @@ void MockingboardCard::AY8910_InitAll(int nClock, int nSampleRate)
 
 void MockingboardCard::AY8910_InitClock(int nClock)
 {
+	SyncAudioThread();	// NB. CLK is shared by all AY's, on all cards
 	AY8913::SetCLK((double)nClock);
 
 	for (UINT subunit = 0; subunit < NUM_SUBUNITS_PER_MB; subunit++)
@@ -1109,12 +1138,14 @@ void MockingboardCard::AY8910_InitClock(int nClock)
 BYTE* MockingboardCard::AY8910_GetRegsPtr(BYTE subunit, BYTE ay)
 {
 	_ASSERT(subunit < NUM_SUBUNITS_PER_MB && ay < NUM_AY8913_PER_SUBUNIT);
+	SyncAudioThread();
 	return m_MBSubUnit[subunit].ay8913[ay].GetAYRegsPtr();
 }
 
 UINT MockingboardCard::AY8910_SaveSnapshot(YamlSaveHelper& yamlSaveHelper, BYTE subunit, BYTE ay, const std::string& suffix)
 {
 	_ASSERT(subunit < NUM_SUBUNITS_PER_MB && ay < NUM_AY8913_PER_SUBUNIT);
+	SyncAudioThread();
 	m_MBSubUnit[subunit].ay8913[ay].SaveSnapshot(yamlSaveHelper, suffix);
 	return 1;
 }
@@ -1122,9 +1153,16 @@ UINT MockingboardCard::AY8910_SaveSnapshot(YamlSaveHelper& yamlSaveHelper, BYTE
 UINT MockingboardCard::AY8910_LoadSnapshot(YamlLoadHelper& yamlLoadHelper, BYTE subunit, BYTE ay, const std::string& suffix)
 {
 	_ASSERT(subunit < NUM_SUBUNITS_PER_MB && ay < NUM_AY8913_PER_SUBUNIT);
+	SyncAudioThread();
 	return m_MBSubUnit[subunit].ay8913[ay].LoadSnapshot(yamlLoadHelper, suffix) ? 1 : 0;
 }
 
+// Wait for the AY8913's and voice buffers to be released by MockingboardCardManager's audio thread (if any)
+void MockingboardCard::SyncAudioThread(void)
+{
+	GetCardMgr().GetMockingboardCardMgr().SyncAudioThread();
+}
+
 //=============================================================================
 
 // Unit version history:
@@ -1242,6 +1280,8 @@ bool MockingboardCard::LoadSnapshot(YamlLoadHelper& yamlLoadHelper, UINT version
 	if (version < 1 || version > kUNIT_VERSION)
 		throw std::runtime_error("Card: wrong version");
 
+	SyncAudioThread();
+
 	if (QueryType() == CT_Phasor)
 		return Phasor_LoadSnapshot(yamlLoadHelper, version);
 
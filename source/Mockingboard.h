@@ -35,6 +35,8 @@ public:
 	void SetVolume(uint32_t dwVolume, uint32_t dwVolumeMax);
 	void SetCumulativeCycles(void);
 	UINT MB_Update(void);
+	UINT MB_Render(UINT nNumSamples);
+	void AY8910Write(UINT chip, BYTE r, BYTE v, UINT offset);
 	short** GetVoiceBuffers(void) { return m_ppAYVoiceBuffer; }
 	int GetNumSamplesError(void) { return m_numSamplesError; }
 	void SetNumSamplesError(int numSamplesError) { m_numSamplesError = numSamplesError; }
@@ -143,6 +145,7 @@ private:
 
 	UINT AY8910_SaveSnapshot(class YamlSaveHelper& yamlSaveHelper, BYTE subunit, BYTE ay, const std::string& suffix);
 	UINT AY8910_LoadSnapshot(class YamlLoadHelper& yamlLoadHelper, BYTE subunit, BYTE ay, const std::string& suffix);
+	void SyncAudioThread(void);
 
 	UINT64 m_lastAYUpdateCycle;
 	//-------------------------------------
@@ -34,8 +34,17 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "CardManager.h"
 #include "CPU.h"
 #include "MockingboardDefs.h"
+#include "PerfCounters.h"
 #include "Riff.h"
 
+#include <algorithm>
+#include <climits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MB_MIX_SSE2
+#endif
+
 //#define DBG_MB_UPDATE
 
 bool MockingboardCardManager::IsMockingboard(UINT slot)
@@ -67,6 +76,7 @@ void MockingboardCardManager::InitializeForLoadingSnapshot(void)
 	if (!m_mockingboardVoice.lpDSBvoice)
 		return;
 
+	SyncAudioThread();
 	DSVoiceStop(&m_mockingboardVoice);	// Reason: 'MB voice is playing' then loading a save-state where 'no MB present' (GH#609)
 }
 
@@ -206,6 +216,8 @@ void MockingboardCardManager::Destroy(void)
 {
 	// NB. All cards (including any Mockingboard cards) have just been destroyed by CardManager
 
+	SyncAudioThread();
+
 	if (m_mockingboardVoice.lpDSBvoice && m_mockingboardVoice.bActive)
 		DSVoiceStop(&m_mockingboardVoice);
 
@@ -249,11 +261,7 @@ void MockingboardCardManager::Update(const ULONG executedCycles)
 // . Update()                                                  - when IsAnyTimer1Active() == false
 void MockingboardCardManager::UpdateSoundBuffer(void)
 {
-#ifdef LOG_PERF_TIMINGS
-	extern UINT64 g_timeMB_NoTimer;
-	extern UINT64 g_timeMB_Timer;
-	PerfMarker perfMarker(!IsAnyTimer1Active() ? g_timeMB_NoTimer : g_timeMB_Timer);
-#endif
+	PerfMarker perfMarker(PERF_MOCKINGBOARD);
 
 	if (!m_mockingboardVoice.lpDSBvoice)
 	{
@@ -270,15 +278,26 @@ void MockingboardCardManager::UpdateSoundBuffer(void)
 		// NB. DSZeroVoiceBuffer() also zeros the sound buffer, so it's better than directly calling IDirectSoundBuffer::Play():
 		// - without zeroing, then the previous sound buffer can be heard for a fraction of a second
 		// - eg. when doing Mockingboard playback, then loading a save-state which is also doing Mockingboard playback
+		SyncAudioThread();
 		bool bRes = DSZeroVoiceBuffer(&m_mockingboardVoice, SOUNDBUFFER_SIZE);	// ... and Play()
 		LogFileOutput("MBCardMgr: DSZeroVoiceBuffer(), res=%d\n", bRes ? 1 : 0);
 		if (!bRes)
 			return;
 	}
 
-	UINT numSamples = GenerateAllSoundData();
-	if (numSamples)
-		MixAllAndCopyToRingBuffer(numSamples);
+	const UINT numSamples = GenerateAllSoundData();
+
+	// The ring-buffer position and the sample error are updated here, as without the audio thread:
+	// so the number of samples of the next MB_Update() doesn't depend on when the audio thread runs
+	const bool write = UpdateByteOffset(numSamples) && numSamples;
+	const AudioEvent event = { AudioEvent::WRITE_BUFFER, 0, 0, 0, write ? numSamples : 0, NULL, m_byteOffset };
+	if (write)
+		m_byteOffset = (m_byteOffset + (uint32_t)numSamples * sizeof(short) * MockingboardCard::NUM_MB_CHANNELS) % SOUNDBUFFER_SIZE;
+
+	if (IsAudioThreadRunning())
+		PostEvent(event);
+	else
+		ProcessEvent(event);
 }
 
 bool MockingboardCardManager::Init(void)
@@ -318,15 +337,41 @@ UINT MockingboardCardManager::GenerateAllSoundData(void)
 
 		MB.SetNumSamplesError(m_numSamplesError);
 		nNumSamples = MB.MB_Update();
-		m_numSamplesError = MB.GetNumSamplesError();
+
+		const AudioEvent event = { AudioEvent::RENDER, 0, 0, 0, nNumSamples, &MB };
+		if (IsAudioThreadRunning())
+			PostEvent(event);
+		else
+			ProcessEvent(event);
 	}
 
-	//
+	return nNumSamples;
+}
+
+// Called (directly or on the audio thread) once all cards have been rendered
+void MockingboardCardManager::WriteSoundBuffer(UINT nNumSamples, uint32_t byteOffset)
+{
+	if (nNumSamples)
+		MixAllAndCopyToRingBuffer(nNumSamples, byteOffset);
+
+	m_numRenderedCards = 0;
+}
+
+// Re-sync the write offset with the ring-buffer's cursors and update the sample error correction
+bool MockingboardCardManager::UpdateByteOffset(UINT nNumSamples)
+{
+	bool bUnderrun = false;
 
 	DWORD dwCurrentPlayCursor, dwCurrentWriteCursor;
 	HRESULT hr = m_mockingboardVoice.lpDSBvoice->GetCurrentPosition(&dwCurrentPlayCursor, &dwCurrentWriteCursor);
 	if (FAILED(hr))
-		return 0;
+		return false;
+
+	// The audio thread may not have written the previous blocks yet: the data ends at our offset, not at the write cursor
+	// (else the lagging write cursor looks like an underrun)
+	const bool pendingWrites = IsAudioThreadRunning();
+	if (pendingWrites && m_byteOffset != (uint32_t)-1)
+		dwCurrentWriteCursor = m_byteOffset;
 
 	if (m_byteOffset == (uint32_t)-1)
 	{
@@ -349,6 +394,7 @@ UINT MockingboardCardManager::GenerateAllSoundData(void)
 #endif
 				m_byteOffset = dwCurrentWriteCursor;
 				m_numSamplesError = 0;
+				bUnderrun = true;
 			}
 		}
 		else
@@ -362,6 +408,7 @@ UINT MockingboardCardManager::GenerateAllSoundData(void)
 #endif
 				m_byteOffset = dwCurrentWriteCursor;
 				m_numSamplesError = 0;
+				bUnderrun = true;
 			}
 		}
 	}
@@ -371,82 +418,131 @@ UINT MockingboardCardManager::GenerateAllSoundData(void)
 		nBytesRemaining += SOUNDBUFFER_SIZE;
 
 	// Calc correction factor so that play-buffer doesn't under/overflow
-	const int nErrorInc = SoundCore_GetErrorInc();
-	if (nBytesRemaining < SOUNDBUFFER_SIZE / 4)
-		m_numSamplesError += nErrorInc;				// < 0.25 of buffer remaining
-	else if (nBytesRemaining > SOUNDBUFFER_SIZE / 2)
-		m_numSamplesError -= nErrorInc;				// > 0.50 of buffer remaining
+	int numSamplesError = 0;
+	if (m_mockingboardVoice.latency.Update(*m_mockingboardVoice.lpDSBvoice, nBytesRemaining, nNumSamples, bUnderrun, numSamplesError, pendingWrites))
+	{
+		m_numSamplesError = numSamplesError;
+	}
 	else
-		m_numSamplesError = 0;						// Acceptable amount of data in buffer
+	{
+		const int nErrorInc = SoundCore_GetErrorInc();
+		if (nBytesRemaining < SOUNDBUFFER_SIZE / 4)
+			m_numSamplesError += nErrorInc;				// < 0.25 of buffer remaining
+		else if (nBytesRemaining > SOUNDBUFFER_SIZE / 2)
+			m_numSamplesError -= nErrorInc;				// > 0.50 of buffer remaining
+		else
+			m_numSamplesError = 0;						// Acceptable amount of data in buffer
+	}
 
 #ifdef DBG_MB_UPDATE
 	double fTicksSecs = (double)GetTickCount() / 1000.0;
 	LogOutput("%010.3f: [MBUpdt]    PC=%08X, WC=%08X, Diff=%08X, Off=%08X, NS=%08X, NSE=%08X, Interval=%f\n", fTicksSecs, dwCurrentPlayCursor, dwCurrentWriteCursor, dwCurrentWriteCursor - dwCurrentPlayCursor, dwByteOffset, nNumSamples, nNumSamplesError, updateInterval);
 #endif
 
-	return nNumSamples;
+	return true;
 }
 
-void MockingboardCardManager::MixAllAndCopyToRingBuffer(UINT nNumSamples)
+// Add one voice to a channel's accumulator: acc[i] += (int)(voice[i] * attenuation)
+// The SSE2 path does the same double multiply and truncation, so the result is identical.
+static void MixVoice(int* acc, const short* voice, UINT nNumSamples, double fAttenuation)
 {
-//	const double fAttenuation = g_bPhasorEnable ? 2.0 / 3.0 : 1.0;
-	const double fAttenuation = true ? 2.0 / 3.0 : 1.0;
+	UINT i = 0;
 
-	short** slotAYVoiceBuffers[NUM_SLOTS] = {0};
+#ifdef MB_MIX_SSE2
+	const __m128d attenuation = _mm_set1_pd(fAttenuation);
+	for (; i + 4 <= nNumSamples; i += 4)
+	{
+		__m128i v = _mm_loadl_epi64((const __m128i*)(voice + i));
+		v = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);	// sign extend to 4x int32
+		const __m128i lo = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(v), attenuation));
+		const __m128i hi = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(v, 0xEE)), attenuation));
+		const __m128i sum = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(acc + i)), _mm_unpacklo_epi64(lo, hi));
+		_mm_storeu_si128((__m128i*)(acc + i), sum);
+	}
+#endif
 
-	for (UINT slot = SLOT0; slot < NUM_SLOTS; slot++)
+	for (; i < nNumSamples; i++)
+		acc[i] += (int)((double)voice[i] * fAttenuation);
+}
+
+// Cap the superpositioned output and interleave L & R
+static void CapAndInterleave(short* out, const int* accL, const int* accR, UINT nNumSamples,
+	short waveDataMin, short waveDataMax)
+{
+	UINT i = 0;
+
+#ifdef MB_MIX_SSE2
+	if (waveDataMin == SHRT_MIN && waveDataMax == SHRT_MAX)	// ie. packs's saturation
 	{
-		if (IsMockingboard(slot))
-			slotAYVoiceBuffers[slot] = dynamic_cast<MockingboardCard&>(GetCardMgr().GetRef(slot)).GetVoiceBuffers();
+		for (; i + 8 <= nNumSamples; i += 8)
+		{
+			const __m128i* pL = (const __m128i*)(accL + i);
+			const __m128i* pR = (const __m128i*)(accR + i);
+			const __m128i l = _mm_packs_epi32(_mm_loadu_si128(pL), _mm_loadu_si128(pL + 1));
+			const __m128i r = _mm_packs_epi32(_mm_loadu_si128(pR), _mm_loadu_si128(pR + 1));
+			_mm_storeu_si128((__m128i*)(out + 2 * i), _mm_unpacklo_epi16(l, r));
+			_mm_storeu_si128((__m128i*)(out + 2 * i + 8), _mm_unpackhi_epi16(l, r));
+		}
 	}
+#endif
 
-	for (UINT i = 0; i < nNumSamples; i++)
+	for (; i < nNumSamples; i++)
 	{
-		// Mockingboard stereo (all voices on an AY8910 wire-or'ed together)
-		// L = Address.b7=0, R = Address.b7=1
-		int nDataL = 0, nDataR = 0;
+		int nDataL = accL[i], nDataR = accR[i];
 
-		for (UINT slot = SLOT0; slot < NUM_SLOTS; slot++)
-		{
-			if (!slotAYVoiceBuffers[slot])
-				continue;
+		if (nDataL < waveDataMin)
+			nDataL = waveDataMin;
+		else if (nDataL > waveDataMax)
+			nDataL = waveDataMax;
 
-			for (UINT j = 0; j < NUM_VOICES_PER_AY8913; j++)
-			{
-				short** ppAYVoiceBuffer = slotAYVoiceBuffers[slot];
+		if (nDataR < waveDataMin)
+			nDataR = waveDataMin;
+		else if (nDataR > waveDataMax)
+			nDataR = waveDataMax;
 
-				// Regular MB-C AY's
-				nDataL += (int)((double)ppAYVoiceBuffer[0 * NUM_VOICES_PER_AY8913 + j][i] * fAttenuation);
-				nDataR += (int)((double)ppAYVoiceBuffer[2 * NUM_VOICES_PER_AY8913 + j][i] * fAttenuation);
+		out[i * MockingboardCard::NUM_MB_CHANNELS + 0] = (short)nDataL;	// L
+		out[i * MockingboardCard::NUM_MB_CHANNELS + 1] = (short)nDataR;	// R
+	}
+}
 
-				// Extra Phasor AY's
-				nDataL += (int)((double)ppAYVoiceBuffer[1 * NUM_VOICES_PER_AY8913 + j][i] * fAttenuation);
-				nDataR += (int)((double)ppAYVoiceBuffer[3 * NUM_VOICES_PER_AY8913 + j][i] * fAttenuation);
-			}
-		}
+void MockingboardCardManager::MixAllAndCopyToRingBuffer(UINT nNumSamples, uint32_t byteOffset)
+{
+//	const double fAttenuation = g_bPhasorEnable ? 2.0 / 3.0 : 1.0;
+	const double fAttenuation = true ? 2.0 / 3.0 : 1.0;
+
+	// Mockingboard stereo (all voices on an AY8910 wire-or'ed together)
+	// L = Address.b7=0, R = Address.b7=1
+	int* accL = m_mixAccumulator[0];
+	int* accR = m_mixAccumulator[1];
+	std::fill(accL, accL + nNumSamples, 0);
+	std::fill(accR, accR + nNumSamples, 0);
 
-		// Cap the superpositioned output
-		if (nDataL < WAVE_DATA_MIN)
-			nDataL = WAVE_DATA_MIN;
-		else if (nDataL > WAVE_DATA_MAX)
-			nDataL = WAVE_DATA_MAX;
+	// NB. Not the slots, as CardManager belongs to the emulation thread
+	for (UINT i = 0; i < m_numRenderedCards; i++)
+	{
+		short** ppAYVoiceBuffer = m_renderedCards[i]->GetVoiceBuffers();
 
-		if (nDataR < WAVE_DATA_MIN)
-			nDataR = WAVE_DATA_MIN;
-		else if (nDataR > WAVE_DATA_MAX)
-			nDataR = WAVE_DATA_MAX;
+		for (UINT j = 0; j < NUM_VOICES_PER_AY8913; j++)
+		{
+			// Regular MB-C AY's
+			MixVoice(accL, ppAYVoiceBuffer[0 * NUM_VOICES_PER_AY8913 + j], nNumSamples, fAttenuation);
+			MixVoice(accR, ppAYVoiceBuffer[2 * NUM_VOICES_PER_AY8913 + j], nNumSamples, fAttenuation);
 
-		m_mixBuffer[i * MockingboardCard::NUM_MB_CHANNELS + 0] = (short)nDataL;	// L
-		m_mixBuffer[i * MockingboardCard::NUM_MB_CHANNELS + 1] = (short)nDataR;	// R
+			// Extra Phasor AY's
+			MixVoice(accL, ppAYVoiceBuffer[1 * NUM_VOICES_PER_AY8913 + j], nNumSamples, fAttenuation);
+			MixVoice(accR, ppAYVoiceBuffer[3 * NUM_VOICES_PER_AY8913 + j], nNumSamples, fAttenuation);
+		}
 	}
 
+	CapAndInterleave(m_mixBuffer, accL, accR, nNumSamples, WAVE_DATA_MIN, WAVE_DATA_MAX);
+
 	//
 
 	DWORD dwDSLockedBufferSize0, dwDSLockedBufferSize1;
 	SHORT* pDSLockedBuffer0, * pDSLockedBuffer1;
 
 	HRESULT hr = DSGetLock(m_mockingboardVoice.lpDSBvoice,
-		m_byteOffset, (uint32_t)nNumSamples * sizeof(short) * MockingboardCard::NUM_MB_CHANNELS,
+		byteOffset, (uint32_t)nNumSamples * sizeof(short) * MockingboardCard::NUM_MB_CHANNELS,
 		&pDSLockedBuffer0, &dwDSLockedBufferSize0,
 		&pDSLockedBuffer1, &dwDSLockedBufferSize1);
 	if (FAILED(hr))
@@ -460,8 +556,134 @@ void MockingboardCardManager::MixAllAndCopyToRingBuffer(UINT nNumSamples)
 	hr = m_mockingboardVoice.lpDSBvoice->Unlock((void*)pDSLockedBuffer0, dwDSLockedBufferSize0,
 		(void*)pDSLockedBuffer1, dwDSLockedBufferSize1);
 
-	m_byteOffset = (m_byteOffset + (uint32_t)nNumSamples * sizeof(short) * MockingboardCard::NUM_MB_CHANNELS) % SOUNDBUFFER_SIZE;
-
 	if (m_outputToRiff)
 		RiffPutSamples(&m_mixBuffer[0], nNumSamples);
 }
+
+//=============================================================================
+// Audio thread
+//
+// The emulation thread posts (in order) every AY reg write, each card's MB_Update() sample count and the final
+// ring-buffer write to a single-producer/single-consumer queue; the audio thread replays them against the same
+// AY8913 objects, so the output is unchanged, only delayed until the audio thread catches up.
+// Anything else touching the AY8913's, voice buffers or the MB voice must call SyncAudioThread() first.
+// NB. SSI263 speech is not pipelined: its phoneme-complete IRQ is driven by its ring-buffer updates.
+
+void MockingboardCardManager::SetAudioThread(bool enable)
+{
+	if (enable == IsAudioThreadRunning())
+		return;
+
+	if (enable)
+	{
+		m_audioQueue.resize(AUDIO_QUEUE_SIZE);
+		m_audioQueueHead = 0;
+		m_audioQueueTail = 0;
+		m_audioThreadQuit = false;
+		m_audioThread = std::thread(&MockingboardCardManager::AudioThread, this);
+	}
+	else
+	{
+		SyncAudioThread();
+		{
+			std::lock_guard<std::mutex> lock(m_audioMutex);
+			m_audioThreadQuit = true;
+		}
+		m_audioCondition.notify_one();
+		m_audioThread.join();
+	}
+
+	LogFileOutput("MBCardMgr: audio thread %s\n", enable ? "started" : "stopped");
+}
+
+void MockingboardCardManager::PostAYWrite(MockingboardCard* card, UINT chip, BYTE reg, BYTE val, UINT offset)
+{
+	const AudioEvent event = { AudioEvent::AY_WRITE, (BYTE)chip, reg, val, offset, card };
+	PostEvent(event);
+}
+
+void MockingboardCardManager::PostEvent(const AudioEvent& event)
+{
+	const UINT head = m_audioQueueHead.load(std::memory_order_relaxed);
+
+	while (head - m_audioQueueTail.load(std::memory_order_acquire) >= AUDIO_QUEUE_SIZE)
+	{
+		// Full: only when the AY's are written faster than the audio thread renders (eg. ScrollLock)
+		m_audioCondition.notify_one();
+		std::this_thread::yield();
+	}
+
+	m_audioQueue[head & (AUDIO_QUEUE_SIZE - 1)] = event;
+	m_audioQueueHead.store(head + 1, std::memory_order_release);
+
+	if (event.type == AudioEvent::WRITE_BUFFER)
+	{
+		// Take the lock so that the audio thread can't miss the wake-up
+		std::lock_guard<std::mutex> lock(m_audioMutex);
+		m_audioCondition.notify_one();
+	}
+}
+
+// Wait until every posted event has been processed
+void MockingboardCardManager::SyncAudioThread(void)
+{
+	if (!IsAudioThreadRunning())
+		return;
+
+	const UINT head = m_audioQueueHead.load(std::memory_order_relaxed);
+	if (m_audioQueueTail.load(std::memory_order_acquire) == head)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_audioMutex);
+		m_audioCondition.notify_one();
+	}
+
+	while (m_audioQueueTail.load(std::memory_order_acquire) != head)
+		std::this_thread::yield();
+}
+
+void MockingboardCardManager::AudioThread(void)
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_audioMutex);
+			m_audioCondition.wait(lock, [this] {
+				return m_audioThreadQuit
+					|| m_audioQueueTail.load(std::memory_order_relaxed) != m_audioQueueHead.load(std::memory_order_acquire);
+			});
+
+			if (m_audioThreadQuit)
+				return;	// NB. Queue has been drained by SyncAudioThread()
+		}
+
+		PerfMarker perfMarker(PERF_MOCKINGBOARD);
+
+		UINT tail = m_audioQueueTail.load(std::memory_order_relaxed);
+		const UINT head = m_audioQueueHead.load(std::memory_order_acquire);
+		while (tail != head)
+		{
+			ProcessEvent(m_audioQueue[tail & (AUDIO_QUEUE_SIZE - 1)]);
+			m_audioQueueTail.store(++tail, std::memory_order_release);
+		}
+	}
+}
+
+void MockingboardCardManager::ProcessEvent(const AudioEvent& event)
+{
+	switch (event.type)
+	{
+	case AudioEvent::AY_WRITE:
+		event.card->AY8910Write(event.chip, event.reg, event.val, event.value);
+		break;
+	case AudioEvent::RENDER:
+		event.card->MB_Render(event.value);
+		if (m_numRenderedCards < NUM_SLOTS)
+			m_renderedCards[m_numRenderedCards++] = event.card;
+		break;
+	case AudioEvent::WRITE_BUFFER:
+		WriteSoundBuffer(event.value, event.byteOffset);
+		break;
+	}
+}
@@ -4,6 +4,12 @@
 #include "SoundCore.h"
 #include "Mockingboard.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 class MockingboardCardManager
 {
 public:
@@ -11,6 +17,10 @@ public:
 	{
 		m_numSamplesError = 0;
 		m_byteOffset = (uint32_t)-1;
+		m_numRenderedCards = 0;
+		m_audioQueueHead = 0;
+		m_audioQueueTail = 0;
+		m_audioThreadQuit = false;
 		m_cyclesThisAudioFrame = 0;
 		m_userVolume = 0;
 		m_outputToRiff = false;
@@ -20,7 +30,9 @@ public:
 		LogFileOutput("MBCardMgr::ctor() g_bDisableDirectSound=%d, g_bDisableDirectSoundMockingboard=%d\n", g_bDisableDirectSound, g_bDisableDirectSoundMockingboard);
 	}
 	~MockingboardCardManager(void)
-	{}
+	{
+		SetAudioThread(false);
+	}
 
 	bool IsMockingboard(UINT slot);
 	void ReinitializeClock(void);
@@ -44,6 +56,12 @@ public:
 	void Update(const ULONG executedCycles);
 	void UpdateSoundBuffer(void);
 
+	// Optional audio thread: AY synthesis, mixing & ring-buffer writes are pipelined behind the emulation
+	void SetAudioThread(bool enable);
+	bool IsAudioThreadRunning(void) const { return m_audioThread.joinable(); }
+	void PostAYWrite(MockingboardCard* card, UINT chip, BYTE reg, BYTE val, UINT offset);
+	void SyncAudioThread(void);
+
 #ifdef _DEBUG
 	void CheckCumulativeCycles(void);
 	void Get6522IrqDescription(std::string& desc);
@@ -52,7 +70,9 @@ public:
 private:
 	bool Init(void);
 	UINT GenerateAllSoundData(void);
-	void MixAllAndCopyToRingBuffer(UINT nNumSamples);
+	void WriteSoundBuffer(UINT nNumSamples, uint32_t byteOffset);
+	bool UpdateByteOffset(UINT nNumSamples);
+	void MixAllAndCopyToRingBuffer(UINT nNumSamples, uint32_t byteOffset);
 	bool IsMockingboardExtraCardType(UINT slot);
 
 	static const uint32_t SOUNDBUFFER_SIZE = MAX_SAMPLES * sizeof(short) * MockingboardCard::NUM_MB_CHANNELS;
@@ -61,12 +81,46 @@ private:
 	static const SHORT WAVE_DATA_MAX = (SHORT)0x7FFF;
 
 	short m_mixBuffer[SOUNDBUFFER_SIZE / sizeof(short)];
+	int m_mixAccumulator[MockingboardCard::NUM_MB_CHANNELS][MAX_SAMPLES];	// L & R, before capping
 	VOICE m_mockingboardVoice;
 
+	// Cards rendered since the last WriteSoundBuffer() (owned by the audio thread, when running)
+	MockingboardCard* m_renderedCards[NUM_SLOTS];
+	UINT m_numRenderedCards;
+
+	//
+
+	struct AudioEvent
+	{
+		enum Type : BYTE { AY_WRITE, RENDER, WRITE_BUFFER };
+
+		Type type;
+		BYTE chip;
+		BYTE reg;
+		BYTE val;
+		UINT value;	// AY_WRITE: cycles since the card's last MB_Update(), RENDER & WRITE_BUFFER: number of samples (WRITE_BUFFER: 0 = don't write)
+		MockingboardCard* card;
+		uint32_t byteOffset;	// WRITE_BUFFER: where to write in the ring-buffer
+	};
+
+	void PostEvent(const AudioEvent& event);
+	void AudioThread(void);
+	void ProcessEvent(const AudioEvent& event);
+
+	static const UINT AUDIO_QUEUE_SIZE = 32768;	// power of 2: 4 AY's * AY_CHANGE_MAX, and then some
+
+	std::vector<AudioEvent> m_audioQueue;
+	alignas(64) std::atomic<UINT> m_audioQueueHead;	// written by the emulation thread
+	alignas(64) std::atomic<UINT> m_audioQueueTail;	// written by the audio thread, once an event is processed
+	std::thread m_audioThread;
+	std::mutex m_audioMutex;
+	std::condition_variable m_audioCondition;
+	bool m_audioThreadQuit;	// protected by m_audioMutex
+
 	//
 
 	int m_numSamplesError;
-	uint32_t m_byteOffset;
+	uint32_t m_byteOffset;	// NB. The ring-buffer position & the sample error belong to the emulation thread (the audio thread only writes)
 	UINT m_cyclesThisAudioFrame;
 	uint32_t m_userVolume;	// GUI's slide volume
 	bool m_outputToRiff;
@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	#include "CPU.h"	// CpuGetCyclesThisVideoFrame()
 	#include "Memory.h" // MemGetMainPtr(), MemGetAuxPtr(), MemGetAnnunciator()
 	#include "Interface.h"  // GetFrameBuffer()
+	#include "PerfCounters.h"
 	#include "RGBMonitor.h"
 	#include "VidHD.h"
 
@@ -108,7 +109,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	// To maintain the 280x192 aspect ratio for 560px width, we double every scan line -> 560x384
 	// NB. For IIgs SHR, the 320x200 is again doubled (to 640x400), but this gives a ~16:9 ratio, when 4:3 is probably required (ie. stretch height from 200 to 240)
 	static bgra_t* g_pScanLines[VIDEO_SCANNER_Y_DISPLAY_IIGS * 2];
-	static UINT g_kFrameBufferWidth = 0;
+	static int g_nFrameBufferRowStep = 0;	// from one scanline to the one below it
+	static bool g_bFrameBufferWholeFrame = false;	// the frame buffer has been drawn into since the top of the screen
+	static bool g_bRedrawingWholeScreen = false;
+	static bool g_bVideoRaster = true;	// false: the video scanner runs (VBL, floating bus) but no pixels are produced
 
 	static unsigned short (*g_pHorzClockOffset)[VIDEO_SCANNER_MAX_HORZ] = 0;
 
@@ -401,24 +405,24 @@ inline uint32_t getScanlineColor( const uint16_t signal, const bgra_t *pTable )
 //===========================================================================
 inline uint32_t* getScanlineNextInbetween()
 {
-	return (uint32_t*) (g_pVideoAddress - 1*g_kFrameBufferWidth);
+	return (uint32_t*) (g_pVideoAddress + 1*g_nFrameBufferRowStep);
 }
 
 #if 0	// don't use this pixel, as it's from the previous video-frame!
 inline uint32_t* getScanlineNext()
 {
-	return (uint32_t*) (g_pVideoAddress - 2*g_kFrameBufferWidth);
+	return (uint32_t*) (g_pVideoAddress + 2*g_nFrameBufferRowStep);
 }
 #endif
 //===========================================================================
 inline uint32_t* getScanlinePreviousInbetween()
 {
-	return (uint32_t*) (g_pVideoAddress + 1*g_kFrameBufferWidth);
+	return (uint32_t*) (g_pVideoAddress - 1*g_nFrameBufferRowStep);
 }
 
 inline uint32_t* getScanlinePrevious()
 {
-	return (uint32_t*) (g_pVideoAddress + 2*g_kFrameBufferWidth);
+	return (uint32_t*) (g_pVideoAddress - 2*g_nFrameBufferRowStep);
 }
 //===========================================================================
 inline uint32_t* getScanlineCurrent()
@@ -451,6 +455,17 @@ inline void updateFlashRate() // TODO: Flash rate should be constant (regardless
 	//     if (0 == g_nVideoCharSet && 0x40 == (m & 0xC0)) // Flash only if mousetext not active
 }
 
+//===========================================================================
+inline void updateFrameBuffer()
+{
+	// The scanner is back at the top: hand over the whole frame, the frontend can supply another buffer for the next one
+	// (not during NTSC_VideoRedrawWholeScreen(), which hands over when it is done)
+	if (g_bFrameBufferWholeFrame && !g_bRedrawingWholeScreen)
+		GetVideo().SwapFrameBuffer();
+
+	g_bFrameBufferWholeFrame = true;
+}
+
 #if 0
 #define updateFramebufferMonitorSingleScanline(signal,table) \
 	do { \
@@ -673,6 +688,7 @@ inline void updateVideoScannerHorzEOLSimple()
 			g_nVideoClockVert = 0;
 
 			updateFlashRate();
+			updateFrameBuffer();
 		}
 
 		if (g_nVideoClockVert < VIDEO_SCANNER_Y_DISPLAY)
@@ -717,6 +733,7 @@ inline void updateVideoScannerHorzEOL()
 			g_nVideoClockVert = 0;
 
 			updateFlashRate();
+			updateFrameBuffer();
 		}
 
 		if (g_nVideoClockVert < VIDEO_SCANNER_Y_DISPLAY)
@@ -735,6 +752,8 @@ inline void updateVideoScannerHorzEOL_SHR()
 		if (++g_nVideoClockVert == g_videoScannerMaxVert)
 		{
 			g_nVideoClockVert = 0;
+
+			updateFrameBuffer();
 		}
 
 		if (g_nVideoClockVert < VIDEO_SCANNER_Y_DISPLAY_IIGS)
@@ -852,6 +871,9 @@ static void ClearOverscanVideoArea(void)
 		for (uint32_t j = 0; j < kOverscanSpanR; j++)
 			pScanLine[j] = CLEAR_COLOUR_SIDE | ALPHA32_MASK;
 	}
+
+	// Other frame buffers supplied by the frontend still have the old overscan
+	GetVideo().InvalidateOtherFrameBuffers();
 }
 
 //===========================================================================
@@ -1926,6 +1948,7 @@ void NTSC_VideoClockResync(const uint32_t dwCyclesThisFrame)
 {
 	g_nVideoClockVert = (uint16_t)(dwCyclesThisFrame / VIDEO_SCANNER_MAX_HORZ) % g_videoScannerMaxVert;
 	g_nVideoClockHorz = (uint16_t)(dwCyclesThisFrame % VIDEO_SCANNER_MAX_HORZ);
+	g_bFrameBufferWholeFrame = false;	// some scan lines have been skipped
 }
 
 //===========================================================================
@@ -2330,10 +2353,28 @@ void NTSC_Destroy(void)
 	// After a VM restart, this will point to an old FrameBuffer
 	// - if it's now unmapped then this can cause a crash in NTSC_SetVideoMode()!
 	g_pVideoAddress = 0;
-	g_kFrameBufferWidth = 0;
+	g_nFrameBufferRowStep = 0;
+	g_bFrameBufferWholeFrame = false;
 	memset(g_pScanLines, 0, sizeof(g_pScanLines));
 }
 
+static void SetScanLines( uint8_t* pFramebuffer )
+{
+	for (int y = 0; y < (VIDEO_SCANNER_Y_DISPLAY_IIGS*2); y++)
+	{
+		uint32_t offset = sizeof(bgra_t) * GetVideo().GetFrameBufferScanLineOffset(y);
+		g_pScanLines[y] = (bgra_t*) (pFramebuffer + offset);
+	}
+}
+
+// Draw into another buffer with the same layout, from the current scanner position
+void NTSC_SetFrameBuffer( uint8_t* pFramebuffer )
+{
+	const uint8_t* pOldFramebuffer = (const uint8_t*) g_pScanLines[0] - sizeof(bgra_t) * GetVideo().GetFrameBufferScanLineOffset(0);
+	g_pVideoAddress = (bgra_t*) (pFramebuffer + ((const uint8_t*) g_pVideoAddress - pOldFramebuffer));
+	SetScanLines(pFramebuffer);
+}
+
 void NTSC_VideoInit( uint8_t* pFramebuffer ) // wsVideoInit
 {
 	make_csbits();
@@ -2342,15 +2383,10 @@ void NTSC_VideoInit( uint8_t* pFramebuffer ) // wsVideoInit
 	initChromaPhaseTables();
 	updateMonochromeTables( 0xFF, 0xFF, 0xFF );
 
-	g_kFrameBufferWidth = GetVideo().GetFrameBufferWidth();
+	g_nFrameBufferRowStep = GetVideo().GetFrameBufferRowStep();
+	g_bFrameBufferWholeFrame = false;
 
-	for (int y = 0; y < (VIDEO_SCANNER_Y_DISPLAY_IIGS*2); y++)
-	{
-		uint32_t offset = sizeof(bgra_t) * GetVideo().GetFrameBufferWidth()
-			* ((GetVideo().GetFrameBufferHeight() - 1) - y - GetVideo().GetFrameBufferBorderHeight())
-			+ (sizeof(bgra_t) * GetVideo().GetFrameBufferBorderWidth());
-		g_pScanLines[y] = (bgra_t*) (GetVideo().GetFrameBuffer() + offset);
-	}
+	SetScanLines(GetVideo().GetFrameBuffer());
 
 	g_pVideoAddress = g_pScanLines[0];
 
@@ -2430,6 +2466,7 @@ void NTSC_VideoReinitialize( uint32_t cyclesThisFrame, bool bInitVideoScannerAdd
 
 	g_nVideoClockVert = (uint16_t) (cyclesThisFrame / VIDEO_SCANNER_MAX_HORZ);
 	g_nVideoClockHorz = cyclesThisFrame % VIDEO_SCANNER_MAX_HORZ;
+	g_bFrameBufferWholeFrame = false;	// some scan lines may have been skipped
 
 	if (bInitVideoScannerAddress)		// GH#611
 		updateVideoScannerAddress();	// Pre-condition: g_nVideoClockVert
@@ -2506,19 +2543,27 @@ static void VideoUpdateCycles( int cyclesLeftToUpdate )
 		g_pFuncUpdateGraphicsScreen(cyclesLeftToUpdate);
 }
 
+//===========================================================================
+// No raster: only move the video scanner on, as VideoUpdateCycles() does
+static void VideoUpdateScanner( int cycles )
+{
+	const UINT pos = (g_nVideoClockVert * VIDEO_SCANNER_MAX_HORZ + g_nVideoClockHorz + cycles) % g_videoScanner6502Cycles;
+	g_nVideoClockVert = (uint16_t)(pos / VIDEO_SCANNER_MAX_HORZ);
+	g_nVideoClockHorz = (uint16_t)(pos % VIDEO_SCANNER_MAX_HORZ);
+}
+
 //===========================================================================
 void NTSC_VideoUpdateCycles( UINT cycles6502 )
 {
-#ifdef LOG_PERF_TIMINGS
-	extern UINT64 g_timeVideo;
-	PerfMarker perfMarker(g_timeVideo);
-#endif
+	PerfMarker perfMarker(PERF_VIDEO);
 
 	_ASSERT(cycles6502 && cycles6502 < g_videoScanner6502Cycles);	// Use NTSC_VideoRedrawWholeScreen() instead
 
+	void (*pFuncUpdateCycles)(int) = g_bVideoRaster ? VideoUpdateCycles : VideoUpdateScanner;
+
 	if (g_bDelayVideoMode)
 	{
-		VideoUpdateCycles(1);	// Video mode change is delayed by 1 cycle
+		pFuncUpdateCycles(1);	// Video mode change is delayed by 1 cycle
 
 		g_bDelayVideoMode = false;
 		NTSC_SetVideoMode(g_uNewVideoModeFlags);
@@ -2528,7 +2573,25 @@ void NTSC_VideoUpdateCycles( UINT cycles6502 )
 			return;
 	}
 
-	VideoUpdateCycles(cycles6502);
+	pFuncUpdateCycles(cycles6502);
+}
+
+//===========================================================================
+void NTSC_SetVideoRaster( bool bRaster )
+{
+	if (bRaster == g_bVideoRaster)
+		return;
+
+	g_bVideoRaster = bRaster;
+
+	// Back to pixels: the frame buffer and the pixel position (g_pVideoAddress) have not followed the scanner
+	if (bRaster)
+		NTSC_VideoRedrawWholeScreen();
+}
+
+bool NTSC_IsVideoRaster( void )
+{
+	return g_bVideoRaster;
 }
 
 //===========================================================================
@@ -2546,7 +2609,13 @@ void NTSC_VideoRedrawWholeScreen( void )
 	g_nVideoClockHorz = 0;
 	updateVideoScannerAddress();
 
+	g_bRedrawingWholeScreen = true;
 	VideoUpdateCycles(g_videoScanner6502Cycles);
+	g_bRedrawingWholeScreen = false;
+
+	// The frame is whole: hand it over now. The next buffer will only hold a whole frame after the scanner has been through the top
+	GetVideo().SwapFrameBuffer();
+	g_bFrameBufferWholeFrame = false;
 
 	VideoUpdateCycles(horz);	// Finally update to get to correct H-pos
 
@@ -16,11 +16,14 @@ void NTSC_GetVideoVertHorzForDebugger(uint16_t& vert, uint16_t& horz);
 uint16_t NTSC_GetVideoVertForDebugger(void);
 void NTSC_Destroy(void);
 void NTSC_VideoInit(uint8_t *pFramebuffer);
+void NTSC_SetFrameBuffer(uint8_t *pFramebuffer);
 void NTSC_VideoReinitialize(uint32_t cyclesThisFrame, bool bInitVideoScannerAddress);
 void NTSC_VideoInitAppleType(void);
 void NTSC_VideoInitChroma(void);
 void NTSC_VideoUpdateCycles(UINT cycles6502);
 void NTSC_VideoRedrawWholeScreen(void);
+void NTSC_SetVideoRaster(bool bRaster);	// false: keep the video scanner, but produce no pixels (NTSC_VideoRedrawWholeScreen() still does)
+bool NTSC_IsVideoRaster(void);
 
 void NTSC_SetRefreshRate(VideoRefreshRate_e rate);
 UINT NTSC_GetCyclesPerFrame(void);
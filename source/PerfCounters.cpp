@@ -0,0 +1,211 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2024, Tom Charlesworth, Michael Pohoreski, Nick Westgate
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Per-subsystem performance counters
+ *
+ * Author: Various
+ */
+
+#include "StdAfx.h"
+
+#include "PerfCounters.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PERF_USE_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PERF_USE_RDTSC
+#endif
+
+bool g_bPerfCounters = false;
+
+static const char* const g_perfCounterNames[PERF_NUM_COUNTERS] =
+{
+	"CPU",
+	"Video",
+	"Speaker",
+	"Mockingboard",
+	"Disk II",
+	"Cards",
+	"Sync events",
+	"Present",
+};
+
+struct PerfCounter
+{
+	std::atomic<UINT64> frame;		// ticks, since the last PerfCounters_EndFrame()
+	PerfCounterStats stats;
+	float history[PERF_HISTORY_SIZE];	// ms
+};
+
+static PerfCounter g_perfCounters[PERF_NUM_COUNTERS];
+static UINT64 g_perfFrames = 0;
+static UINT64 g_perfWallTime = 0;
+static UINT64 g_perfLastEndFrame = 0;		// ns
+static UINT64 g_perfLastEndFrameTicks = 0;
+static UINT g_perfHistoryPos = 0;
+
+static thread_local PerfMarker* g_pCurrentPerfMarker = NULL;
+
+static UINT64 GetNanoseconds(void)
+{
+	return (UINT64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Markers can be hit at every opcode (Video): on x86 the TSC is much cheaper to read than the clock
+// The ticks are converted to ns once per frame
+static inline UINT64 GetTicks(void)
+{
+#ifdef PERF_USE_RDTSC
+	return __rdtsc();
+#else
+	return GetNanoseconds();
+#endif
+}
+
+static UINT GetHistogramBin(const UINT64 ns)
+{
+	UINT64 us = ns / 1000;
+	UINT bin = 0;
+	while (us && bin < PERF_HISTOGRAM_BINS - 1)
+	{
+		us >>= 1;
+		++bin;
+	}
+	return bin;
+}
+
+//===========================================================================
+
+void PerfMarker::Start(void)
+{
+	m_parent = g_pCurrentPerfMarker;
+	g_pCurrentPerfMarker = this;
+	m_start = GetTicks();
+}
+
+void PerfMarker::Stop(void)
+{
+	const UINT64 elapsed = GetTicks() - m_start;
+	g_perfCounters[m_id].frame.fetch_add(elapsed - std::min(elapsed, m_children), std::memory_order_relaxed);
+
+	if (m_parent)
+		m_parent->m_children += elapsed;
+	g_pCurrentPerfMarker = m_parent;
+}
+
+//===========================================================================
+
+void PerfCounters_Enable(const bool enable)
+{
+	if (enable && !g_bPerfCounters)
+		PerfCounters_Reset();
+
+	g_bPerfCounters = enable;
+}
+
+void PerfCounters_Reset(void)
+{
+	for (UINT i = 0; i < PERF_NUM_COUNTERS; ++i)
+	{
+		PerfCounter& counter = g_perfCounters[i];
+		counter.frame = 0;
+		memset(&counter.stats, 0, sizeof(counter.stats));
+		std::fill(counter.history, counter.history + PERF_HISTORY_SIZE, 0.0f);
+	}
+
+	g_perfFrames = 0;
+	g_perfWallTime = 0;
+	g_perfHistoryPos = 0;
+	g_perfLastEndFrame = GetNanoseconds();
+	g_perfLastEndFrameTicks = GetTicks();
+}
+
+void PerfCounters_EndFrame(void)
+{
+	if (!g_bPerfCounters)
+		return;
+
+	const UINT64 now = GetNanoseconds();
+	const UINT64 nowTicks = GetTicks();
+	const UINT64 wallTime = now - g_perfLastEndFrame;
+	const UINT64 wallTicks = nowTicks - g_perfLastEndFrameTicks;
+	const double nsPerTick = wallTicks ? (double)wallTime / (double)wallTicks : 1.0;
+	g_perfWallTime += wallTime;
+	g_perfLastEndFrame = now;
+	g_perfLastEndFrameTicks = nowTicks;
+
+	for (UINT i = 0; i < PERF_NUM_COUNTERS; ++i)
+	{
+		PerfCounter& counter = g_perfCounters[i];
+		const UINT64 ns = (UINT64)(counter.frame.exchange(0, std::memory_order_relaxed) * nsPerTick);
+
+		counter.stats.total += ns;
+		counter.stats.last = ns;
+		counter.stats.max = std::max(counter.stats.max, ns);
+		++counter.stats.histogram[GetHistogramBin(ns)];
+		counter.history[g_perfHistoryPos] = ns / 1.0e6f;
+	}
+
+	g_perfHistoryPos = (g_perfHistoryPos + 1) % PERF_HISTORY_SIZE;
+	++g_perfFrames;
+}
+
+//===========================================================================
+
+const char* PerfCounters_GetName(const PerfCounterID id)
+{
+	return g_perfCounterNames[id];
+}
+
+void PerfCounters_GetStats(const PerfCounterID id, PerfCounterStats& stats)
+{
+	stats = g_perfCounters[id].stats;
+}
+
+void PerfCounters_GetHistory(const PerfCounterID id, float* ms)
+{
+	const float* history = g_perfCounters[id].history;
+	std::copy(history + g_perfHistoryPos, history + PERF_HISTORY_SIZE, ms);
+	std::copy(history, history + g_perfHistoryPos, ms + PERF_HISTORY_SIZE - g_perfHistoryPos);
+}
+
+UINT64 PerfCounters_GetFrames(void)
+{
+	return g_perfFrames;
+}
+
+UINT64 PerfCounters_GetWallTime(void)
+{
+	return g_perfWallTime;
+}
+
+UINT PerfCounters_GetHistogramBinLow(const UINT bin)
+{
+	return bin ? 1 << (bin - 1) : 0;
+}
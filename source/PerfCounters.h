@@ -0,0 +1,72 @@
+#pragma once
+
+// Time spent in each subsystem, accumulated per video frame
+// . always compiled in, but only measured while enabled (PerfCounters_Enable)
+// . markers nest: the time of an inner marker is not counted in the outer one (eg. Video inside CPU), so counters add up
+// . markers can run on any thread, PerfCounters_EndFrame() and PerfCounters_GetStats() must be called from the same thread
+
+enum PerfCounterID
+{
+	PERF_CPU,
+	PERF_VIDEO,				// NTSC_VideoUpdateCycles()
+	PERF_SPEAKER,
+	PERF_MOCKINGBOARD,		// AY8913 / SSI263 synthesis
+	PERF_DISK2,				// Disk II I/O
+	PERF_CARDS,				// CardManager::Update()
+	PERF_SYNC_EVENTS,		// callbacks of the SynchronousEventManager
+	PERF_PRESENT,			// frontend: copy to the screen
+	PERF_NUM_COUNTERS
+};
+
+const UINT PERF_HISTOGRAM_BINS = 18;	// per frame: < 1us, [1, 2)us, [2, 4)us ... >= 65536us
+const UINT PERF_HISTORY_SIZE = 128;		// last frames
+
+struct PerfCounterStats
+{
+	UINT64 total;		// ns, since the last PerfCounters_Reset()
+	UINT64 last;		// ns, in the last frame
+	UINT64 max;			// ns, in one frame
+	UINT64 histogram[PERF_HISTOGRAM_BINS];	// number of frames
+};
+
+extern bool g_bPerfCounters;
+
+void PerfCounters_Enable(const bool enable);
+void PerfCounters_Reset(void);
+void PerfCounters_EndFrame(void);
+
+const char* PerfCounters_GetName(const PerfCounterID id);
+void PerfCounters_GetStats(const PerfCounterID id, PerfCounterStats& stats);
+void PerfCounters_GetHistory(const PerfCounterID id, float* ms);	// PERF_HISTORY_SIZE values, oldest first
+UINT64 PerfCounters_GetFrames(void);
+UINT64 PerfCounters_GetWallTime(void);	// ns, between PerfCounters_Reset() and the last PerfCounters_EndFrame()
+UINT PerfCounters_GetHistogramBinLow(const UINT bin);	// us
+
+class PerfMarker
+{
+public:
+	PerfMarker(const PerfCounterID id)
+		: m_id(id)
+		, m_start(0)
+		, m_children(0)
+		, m_parent(NULL)
+	{
+		if (g_bPerfCounters)
+			Start();
+	}
+
+	~PerfMarker()
+	{
+		if (m_start)
+			Stop();
+	}
+
+private:
+	void Start(void);
+	void Stop(void);
+
+	const PerfCounterID m_id;
+	UINT64 m_start;			// ticks (TSC on x86, else ns)
+	UINT64 m_children;		// ticks, in nested markers
+	PerfMarker* m_parent;
+};
@@ -48,15 +48,20 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 
 #define DEFAULT_SNAPSHOT_NAME "SaveState.aws.yaml"
+#define BINARY_SNAPSHOT_EXT ".aws.bin"
 
 bool g_bSaveStateOnExit = false;
 
+static bool g_bSaveStateCompress = true;	// zlib compress memory chunks of binary save-states
+
 static std::string g_strSaveStateFilename;
 static std::string g_strSaveStatePathname;
 static std::string g_strSaveStatePath;
 
 static YamlHelper yamlHelper;
 
+static bool g_keptDiskCard[NUM_SLOTS];	// In-memory load: Disk II or HDD card not removed, as the state may have the same card in the same slot
+
 #define SS_FILE_VER 2
 
 // Unit version history:
@@ -93,6 +98,25 @@ void Snapshot_SetIgnoreHdcFirmware(const bool ignoreHdcFirmware)
 
 //-----------------------------------------------------------------------------
 
+bool Snapshot_GetCompress()
+{
+	return g_bSaveStateCompress;
+}
+
+void Snapshot_SetCompress(const bool compress)
+{
+	g_bSaveStateCompress = compress;
+}
+
+// Save in the binary format if the pathname ends in ".aws.bin" (loading detects the format from the file's content)
+bool Snapshot_IsBinaryPathname(const std::string& pathname)
+{
+	const std::string ext_bin = BINARY_SNAPSHOT_EXT;
+	return pathname.size() >= ext_bin.size() && pathname.compare(pathname.size() - ext_bin.size(), ext_bin.size(), ext_bin) == 0;
+}
+
+//-----------------------------------------------------------------------------
+
 static void Snapshot_SetPathname(const std::string& strPathname)
 {
 	if (strPathname.empty())
@@ -312,11 +336,17 @@ static void ParseSlots(YamlLoadHelper& yamlLoadHelper, UINT unitVersion)
 		{
 			SetExpansionMemType(type);	// calls GetCardMgr().Insert() & InsertAux()
 		}
+		else if (g_keptDiskCard[slot] && GetCardMgr().QuerySlot(slot) == type)
+		{
+			// Load into the kept card: its drives keep the disk images that are in the same drives in the state
+		}
 		else
 		{
 			GetCardMgr().Insert(slot, type);
 		}
 
+		g_keptDiskCard[slot] = false;
+
 		bRes = GetCardMgr().GetRef(slot).LoadSnapshot(yamlLoadHelper, cardVersion);
 
 		yamlLoadHelper.PopMap();
@@ -369,17 +399,27 @@ static void ParseUnit(void)
 	}
 }
 
-static void Snapshot_LoadState_v2(void)
+// pData == NULL: load from g_strSaveStatePathname
+static bool Snapshot_LoadState_v2(const BYTE* pData = NULL, const size_t size = 0)
 {
 	bool restart = false;	// Only need to restart if any VM state has change
+	bool res = false;
 	HCURSOR oldcursor = SetCursor(LoadCursor(0,IDC_WAIT));
 
 	FrameBase& frame = GetFrame();
 
 	try
 	{
-		if (!yamlHelper.InitParser(g_strSaveStatePathname.c_str()))
-			throw std::runtime_error("Failed to initialize parser or open file: " + g_strSaveStatePathname);
+		if (pData)
+		{
+			if (!yamlHelper.InitParser(pData, size))
+				throw std::runtime_error("Failed to initialize parser");
+		}
+		else
+		{
+			if (!yamlHelper.InitParser(g_strSaveStatePathname.c_str()))
+				throw std::runtime_error("Failed to initialize parser or open file: " + g_strSaveStatePathname);
+		}
 
 		if (yamlHelper.ParseFileHdr(SS_YAML_VALUE_AWSS) != SS_FILE_VER)
 			throw std::runtime_error("Version mismatch");
@@ -388,10 +428,19 @@ static void Snapshot_LoadState_v2(void)
 
 		restart = true;
 
+		const CConfigNeedingRestart configOld = CConfigNeedingRestart::Create();
+
 		//m_ConfigNew.m_bEnableTheFreezesF8Rom = ?;	// todo: when support saving config
 
+		// In-memory states are restored many times a second (rewind, run-ahead):
+		// keep the disk controllers, so that their images aren't closed, re-opened and read again (see ParseSlots())
 		for (UINT slot = SLOT0; slot < NUM_SLOTS; slot++)
-			GetCardMgr().Remove(slot);
+		{
+			const SS_CARDTYPE type = GetCardMgr().QuerySlot(slot);
+			g_keptDiskCard[slot] = pData && (type == CT_Disk2 || type == CT_GenericHDD);
+			if (!g_keptDiskCard[slot])
+				GetCardMgr().Remove(slot);
+		}
 		GetCardMgr().RemoveAux();
 
 		SetCopyProtectionDongleType(DT_EMPTY);
@@ -420,6 +469,16 @@ static void Snapshot_LoadState_v2(void)
 				throw std::runtime_error("Unknown top-level scalar: " + scalar);
 		}
 
+		// Remove any kept card that's not in the state
+		for (UINT slot = SLOT0; slot < NUM_SLOTS; slot++)
+		{
+			if (g_keptDiskCard[slot])
+			{
+				GetCardMgr().Remove(slot);
+				g_keptDiskCard[slot] = false;
+			}
+		}
+
 		// Refresh the volume of any new Mockingboard card (and its SSI263 or SC01 chips)
 		mockingboardCardManager.SetVolume(mockingboardCardManager.GetVolume(), GetPropertySheet().GetVolumeMax());
 		mockingboardCardManager.SetCumulativeCycles();
@@ -440,11 +499,22 @@ static void Snapshot_LoadState_v2(void)
 		if (g_nAppMode == MODE_DEBUG)
 			DebugDisplay(TRUE);
 
-		frame.Initialize(false);	// don't reset the video state
-		frame.ResizeWindow();
+		// In-memory states are restored many times a second (rewind, run-ahead):
+		// if the machine is unchanged, the frame buffer, character set and NTSC tables are still valid
+		if (pData && configNew == configOld)
+		{
+			GetVideo().VideoReinitialize(true);
+		}
+		else
+		{
+			frame.Initialize(false);	// don't reset the video state
+			frame.ResizeWindow();
+		}
 
 		// g_Apple2Type may've changed: so reload button bitmaps & redraw frame (title, buttons, leds, etc)
 		frame.FrameUpdateApple2Type();	// NB. Calls VideoRedrawScreen()
+
+		res = true;
 	}
 	catch(const std::exception & szMessage)
 	{
@@ -459,6 +529,8 @@ static void Snapshot_LoadState_v2(void)
 
 	SetCursor(oldcursor);
 	yamlHelper.FinaliseParser();
+
+	return res;
 }
 
 void Snapshot_LoadState()
@@ -480,58 +552,69 @@ void Snapshot_LoadState()
 	Snapshot_LoadState_v2();
 }
 
+// Load a YAML or binary save-state from memory: no file I/O (except for the disk images it references)
+bool Snapshot_LoadState(const BYTE* pData, const size_t size)
+{
+	return Snapshot_LoadState_v2(pData, size);
+}
+
 //-----------------------------------------------------------------------------
 
-void Snapshot_SaveState(void)
+static void Snapshot_SaveUnits(YamlSaveHelper& yamlSaveHelper)
 {
-	LogFileOutput("Saving Save-State to %s\n", g_strSaveStatePathname.c_str());
-	try
+	yamlSaveHelper.FileHdr(SS_FILE_VER);
+
+	// Unit: Apple2
 	{
-		YamlSaveHelper yamlSaveHelper(g_strSaveStatePathname);
-		yamlSaveHelper.FileHdr(SS_FILE_VER);
+		yamlSaveHelper.UnitHdr(GetSnapshotUnitApple2Name(), UNIT_APPLE2_VER);
+		YamlSaveHelper::Label state(yamlSaveHelper, "%s:\n", SS_YAML_KEY_STATE);
+
+		yamlSaveHelper.Save("%s: %s\n", SS_YAML_KEY_MODEL, GetApple2TypeAsString().c_str());
+		CpuSaveSnapshot(yamlSaveHelper);
+		JoySaveSnapshot(yamlSaveHelper);
+		KeybSaveSnapshot(yamlSaveHelper);
+		SpkrSaveSnapshot(yamlSaveHelper);
+		GetVideo().VideoSaveSnapshot(yamlSaveHelper);
+		MemSaveSnapshot(yamlSaveHelper);
+	}
 
-		// Unit: Apple2
-		{
-			yamlSaveHelper.UnitHdr(GetSnapshotUnitApple2Name(), UNIT_APPLE2_VER);
-			YamlSaveHelper::Label state(yamlSaveHelper, "%s:\n", SS_YAML_KEY_STATE);
-
-			yamlSaveHelper.Save("%s: %s\n", SS_YAML_KEY_MODEL, GetApple2TypeAsString().c_str());
-			CpuSaveSnapshot(yamlSaveHelper);
-			JoySaveSnapshot(yamlSaveHelper);
-			KeybSaveSnapshot(yamlSaveHelper);
-			SpkrSaveSnapshot(yamlSaveHelper);
-			GetVideo().VideoSaveSnapshot(yamlSaveHelper);
-			MemSaveSnapshot(yamlSaveHelper);
-		}
+	// Unit: Aux slot
+	MemSaveSnapshotAux(yamlSaveHelper);
 
-		// Unit: Aux slot
-		MemSaveSnapshotAux(yamlSaveHelper);
+	// Unit: Slots
+	{
+		yamlSaveHelper.UnitHdr(GetSnapshotUnitSlotsName(), UNIT_SLOTS_VER);
+		YamlSaveHelper::Label state(yamlSaveHelper, "%s:\n", SS_YAML_KEY_STATE);
 
-		// Unit: Slots
-		{
-			yamlSaveHelper.UnitHdr(GetSnapshotUnitSlotsName(), UNIT_SLOTS_VER);
-			YamlSaveHelper::Label state(yamlSaveHelper, "%s:\n", SS_YAML_KEY_STATE);
+		GetCardMgr().SaveSnapshot(yamlSaveHelper);
+	}
 
-			GetCardMgr().SaveSnapshot(yamlSaveHelper);
-		}
+	// Unit: Game I/O Connector
+	if (GetCopyProtectionDongleType() != DT_EMPTY)
+	{
+		yamlSaveHelper.UnitHdr(GetSnapshotUnitGameIOConnectorName(), UNIT_GAME_IO_CONNECTOR_VER);
+		YamlSaveHelper::Label unit(yamlSaveHelper, "%s:\n", SS_YAML_KEY_STATE);
 
-		// Unit: Game I/O Connector
-		if (GetCopyProtectionDongleType() != DT_EMPTY)
-		{
-			yamlSaveHelper.UnitHdr(GetSnapshotUnitGameIOConnectorName(), UNIT_GAME_IO_CONNECTOR_VER);
-			YamlSaveHelper::Label unit(yamlSaveHelper, "%s:\n", SS_YAML_KEY_STATE);
+		CopyProtectionDongleSaveSnapshot(yamlSaveHelper);
+	}
 
-			CopyProtectionDongleSaveSnapshot(yamlSaveHelper);
-		}
+	// Miscellaneous
+	if (MemHasNoSlotClock())
+	{
+		yamlSaveHelper.UnitHdr(GetSnapshotUnitMiscName(), UNIT_MISC_VER);
+		YamlSaveHelper::Label state(yamlSaveHelper, "%s:\n", SS_YAML_KEY_STATE);
 
-		// Miscellaneous
-		if (MemHasNoSlotClock())
-		{
-			yamlSaveHelper.UnitHdr(GetSnapshotUnitMiscName(), UNIT_MISC_VER);
-			YamlSaveHelper::Label state(yamlSaveHelper, "%s:\n", SS_YAML_KEY_STATE);
+		NoSlotClockSaveSnapshot(yamlSaveHelper);
+	}
+}
 
-			NoSlotClockSaveSnapshot(yamlSaveHelper);
-		}
+void Snapshot_SaveState(void)
+{
+	LogFileOutput("Saving Save-State to %s\n", g_strSaveStatePathname.c_str());
+	try
+	{
+		YamlSaveHelper yamlSaveHelper(g_strSaveStatePathname, Snapshot_IsBinaryPathname(g_strSaveStatePathname), g_bSaveStateCompress);
+		Snapshot_SaveUnits(yamlSaveHelper);
 	}
 	catch(const std::exception & szMessage)
 	{
@@ -542,6 +625,44 @@ void Snapshot_SaveState(void)
 	}
 }
 
+// Save an (uncompressed) binary save-state to memory: no file I/O
+bool Snapshot_SaveState(std::vector<BYTE>& buffer)
+{
+	try
+	{
+		YamlSaveHelper yamlSaveHelper(buffer);
+		Snapshot_SaveUnits(yamlSaveHelper);
+	}
+	catch(const std::exception & szMessage)
+	{
+		GetFrame().FrameMessageBox(
+					szMessage.what(),
+					"Save State",
+					MB_ICONEXCLAMATION | MB_SETFOREGROUND);
+		return false;
+	}
+
+	return true;
+}
+
+// Upper bound of Snapshot_SaveState(buffer)'s size, without saving: depends only on the configuration
+size_t Snapshot_GetSizeBound(void)
+{
+	const size_t kBankSize = 64*1024;
+	const size_t kUnitBound = 64*1024;			// scalars, keys & small memory blocks of a unit or card (in total ~10K for an enhanced //e)
+	const size_t kSlot0MemoryBound = 128*1024;	// Saturn 128K
+	const size_t kCardMemoryBound = 64*1024;	// VidHD 38K, Uthernet II 32K, Disk II 2 tracks
+
+	size_t size = kUnitBound + (1 + GetRamWorksMemorySize()) * kBankSize;	// main + aux memory
+	for (UINT slot = SLOT0; slot < NUM_SLOTS; slot++)
+	{
+		if (GetCardMgr().QuerySlot(slot) != CT_Empty)
+			size += kUnitBound + (slot == SLOT0 ? kSlot0MemoryBound : kCardMemoryBound);
+	}
+
+	return size;
+}
+
 //-----------------------------------------------------------------------------
 
 void Snapshot_Startup()
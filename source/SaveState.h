@@ -10,8 +10,15 @@ void Snapshot_GetDefaultFilenameAndPath(std::string& defaultFilename, std::strin
 void Snapshot_UpdatePath(void);
 void Snapshot_LoadState();
 void Snapshot_SaveState();
+bool Snapshot_LoadState(const BYTE* pData, const size_t size);
+bool Snapshot_SaveState(std::vector<BYTE>& buffer);
+size_t Snapshot_GetSizeBound(void);
 void Snapshot_Startup();
 void Snapshot_Shutdown();
 
+bool Snapshot_GetCompress();
+void Snapshot_SetCompress(const bool compress);
+bool Snapshot_IsBinaryPathname(const std::string& pathname);
+
 bool Snapshot_GetIgnoreHdcFirmware();
 void Snapshot_SetIgnoreHdcFirmware(const bool ignoreHdcFirmware);
@@ -19,6 +19,9 @@ public:
 
 	virtual HRESULT GetStatus(LPDWORD lpdwStatus) = 0;
 	virtual HRESULT Restore() = 0;
+
+	// Bytes waiting to be played, or -1 if only the play & write cursors are known
+	virtual LONG GetBytesQueued() { return -1; }
 };
 
 // this must be reimplemented in each platform
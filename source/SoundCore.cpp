@@ -34,6 +34,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Log.h"
 #include "Speaker.h"
 
+#include <mutex>
+
 //-------------------------------------
 
 // Used for muting & fading:
@@ -42,6 +44,10 @@ static const UINT uMAX_VOICES = NUM_SLOTS * 2 + 1 + 1;	// 8x (2x SSI263) + spkr
 UINT g_uNumVoices = 0;
 static VOICE* g_pVoices[uMAX_VOICES] = {NULL};
 
+// Held while voices are (un)registered, and by lookups from other threads (eg. the UI, see SoundCore_GetLatencyStats())
+// . the emulation thread registers the voices, so its own walks of g_pVoices don't need it
+static std::mutex g_voicesMutex;
+
 static VOICE* g_pSpeakerVoice = NULL;
 
 //-----------------------------------------------------------------------------
@@ -157,10 +163,14 @@ HRESULT DSGetSoundBuffer(VOICE* pVoice, uint32_t dwBufferSize, uint32_t nSampleR
 		return E_FAIL;
 
 	pVoice->lpDSBvoice = soundBuffer;
+	pVoice->latency.Init(dwBufferSize, nSampleRate, nChannels);
 
-	_ASSERT(g_uNumVoices < uMAX_VOICES);
-	if(g_uNumVoices < uMAX_VOICES)
-		g_pVoices[g_uNumVoices++] = pVoice;
+	{
+		std::lock_guard<std::mutex> lock(g_voicesMutex);
+		_ASSERT(g_uNumVoices < uMAX_VOICES);
+		if(g_uNumVoices < uMAX_VOICES)
+			g_pVoices[g_uNumVoices++] = pVoice;
+	}
 
 	if(pVoice->bIsSpeaker)
 		g_pSpeakerVoice = pVoice;
@@ -173,14 +183,17 @@ void DSReleaseSoundBuffer(VOICE* pVoice)
 	if(pVoice->bIsSpeaker)
 		g_pSpeakerVoice = NULL;
 
-	for(UINT i=0; i<g_uNumVoices; i++)
 	{
-		if(g_pVoices[i] == pVoice)
+		std::lock_guard<std::mutex> lock(g_voicesMutex);
+		for(UINT i=0; i<g_uNumVoices; i++)
 		{
-			g_pVoices[i] = g_pVoices[g_uNumVoices-1];
-			g_pVoices[g_uNumVoices-1] = NULL;
-			g_uNumVoices--;
-			break;
+			if(g_pVoices[i] == pVoice)
+			{
+				g_pVoices[i] = g_pVoices[g_uNumVoices-1];
+				g_pVoices[g_uNumVoices-1] = NULL;
+				g_uNumVoices--;
+				break;
+			}
 		}
 	}
 
@@ -495,6 +508,167 @@ void SoundCore_SetErrorMax(const int nErrorMax)
 
 //=============================================================================
 
+static UINT g_uTargetLatency = 0;	// ms
+
+UINT SoundCore_GetTargetLatency()
+{
+	return g_uTargetLatency;
+}
+
+void SoundCore_SetTargetLatency(const UINT ms)
+{
+	g_uTargetLatency = ms;
+	LogFileOutput("SoundCore: target latency = %u ms\n", ms);
+}
+
+bool SoundCore_GetLatencyStats(const SoundBuffer* pBuffer, SoundLatencyController::Stats& stats)
+{
+	std::lock_guard<std::mutex> lock(g_voicesMutex);	// called from the UI thread: the voice can't be released meanwhile
+	for (UINT i=0; i<g_uNumVoices; i++)
+	{
+		if (g_pVoices[i]->lpDSBvoice.get() == pBuffer)
+		{
+			stats = g_pVoices[i]->latency.GetStats();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+
+// Time constants, in seconds
+static const double kLatencyProportional = 0.5;	// a queue error of E is corrected at E/0.5 per second
+static const double kLatencyIntegral = 5.0;		// absorbs the drift between the emulated & audio device clocks
+static const double kLatencySmoothing = 0.05;	// the device's callbacks make the queue depth a saw-tooth
+static const double kLatencyStable = 10.0;		// without underruns, before the target starts to return
+static const double kLatencyReturn = 30.0;
+static const double kLatencyMaxCorrection = 0.05;
+static const double kLatencyMaxIntegral = 0.02;
+
+static double ClampLatency(double value, double limit)
+{
+	return std::max(-limit, std::min(limit, value));
+}
+
+SoundLatencyController::SoundLatencyController(void)
+{
+	m_bytesPerSecond = 0.0;
+	m_sampleRate = 0.0;
+	m_bufferSize = 0.0;
+	Reset();
+}
+
+void SoundLatencyController::Init(uint32_t dwBufferSize, uint32_t nSampleRate, int nChannels)
+{
+	m_sampleRate = nSampleRate;
+	m_bytesPerSecond = (double)nSampleRate * nChannels * sizeof(short);
+	m_bufferSize = dwBufferSize / m_bytesPerSecond;
+	Reset();
+}
+
+void SoundLatencyController::Reset(void)
+{
+	m_target = 0.0;
+	m_latency = 0.0;
+	m_integral = 0.0;
+	m_residual = 0.0;
+	m_stableTime = 0.0;
+	m_primed = false;
+
+	m_statTargetMs = 0.0f;
+	m_statLatencyMs = 0.0f;
+	m_statFill = 0.0f;
+	m_statCorrection = 0.0f;
+	m_statUnderruns = 0;
+}
+
+bool SoundLatencyController::Update(SoundBuffer& buffer, int nBytesRemaining, UINT nNumSamples, bool bUnderrun, int& nNumSamplesError, bool pendingWrites/*=false*/)
+{
+	if (m_bytesPerSecond <= 0.0)
+		return false;
+
+	// Prefer the real queue depth: the voice's write offset is only an estimate of where the device will play
+	const LONG queued = pendingWrites ? nBytesRemaining : buffer.GetBytesQueued();
+	const double latency = (queued >= 0 ? queued : nBytesRemaining) / m_bytesPerSecond;
+	const double period = nNumSamples / m_sampleRate;
+
+	if (m_latency == 0.0)
+		m_latency = latency;
+	else
+		m_latency += (latency - m_latency) * std::min(1.0, period / kLatencySmoothing);
+
+	const double requested = std::min(SoundCore_GetTargetLatency() / 1000.0, m_bufferSize / 2);
+	if (requested <= 0.0)
+	{
+		m_target = 0.0;
+		m_integral = 0.0;
+		m_residual = 0.0;
+		m_primed = false;
+		Publish(0.0);
+		return false;
+	}
+
+	if (m_target < requested)
+		m_target = requested;
+
+	m_stableTime += period;
+	if ((bUnderrun || queued == 0) && m_primed && m_stableTime > 1.0)
+	{
+		// Back off, but not more than once a second: a single glitch in the host can starve the device several times
+		m_target = std::min(m_target * 1.5, m_bufferSize / 2);
+		m_stableTime = 0.0;
+		m_statUnderruns++;
+	}
+	else if (m_stableTime > kLatencyStable && m_target > requested)
+	{
+		m_target -= (m_target - requested) * std::min(1.0, period / kLatencyReturn);
+	}
+
+	if (!m_primed && m_latency >= m_target)
+		m_primed = true;
+
+	// PI: the integral only winds up once the queue has first been filled
+	const double error = m_target - m_latency;
+	const double proportional = ClampLatency(error / kLatencyProportional, kLatencyMaxCorrection);
+	if (m_primed)
+	{
+		m_integral += error * period / (kLatencyProportional * kLatencyIntegral);
+		m_integral = ClampLatency(m_integral, kLatencyMaxIntegral);
+	}
+	const double correction = ClampLatency(proportional + m_integral, kLatencyMaxCorrection);
+
+	// Carry the fractional samples over, so that small corrections are not lost
+	m_residual += correction * nNumSamples;
+	nNumSamplesError = (int) m_residual;
+	m_residual -= nNumSamplesError;
+
+	Publish(correction);
+	return true;
+}
+
+void SoundLatencyController::Publish(double correction)
+{
+	m_statTargetMs = (float) (m_target * 1000.0);
+	m_statLatencyMs = (float) (m_latency * 1000.0);
+	m_statFill = m_bufferSize > 0.0 ? (float) (m_latency / m_bufferSize) : 0.0f;
+	m_statCorrection = (float) correction;
+}
+
+SoundLatencyController::Stats SoundLatencyController::GetStats(void) const
+{
+	Stats stats;
+	stats.targetMs = m_statTargetMs;
+	stats.latencyMs = m_statLatencyMs;
+	stats.fill = m_statFill;
+	stats.correction = m_statCorrection;
+	stats.underruns = m_statUnderruns;
+	return stats;
+}
+
+//=============================================================================
+
 // Use DWORD_PTR according to IReferenceClock from <strmif.h>.
 static DWORD_PTR g_pdwAdviseCookie = 0; // Not really used as pointer.
 static IReferenceClock *g_pRefClock = NULL;
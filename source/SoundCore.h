@@ -6,6 +6,56 @@
 
 #include "SoundBuffer.h"
 
+#include <atomic>
+
+// Closed-loop control of the audio queued in a voice's ring-buffer, ie. the latency added by the emulator.
+// Enabled by SoundCore_SetTargetLatency(ms > 0), otherwise the voice keeps AppleWin's heuristic (1/4 to 1/2 full).
+// A PI controller on the smoothed queue depth sets the voice's sample error (for the speaker: g_nCpuCyclesFeedback).
+// After an underrun the target backs off, then it slowly returns to the requested latency.
+class SoundLatencyController
+{
+public:
+	struct Stats
+	{
+		float targetMs;		// current target (>= the requested latency, after underruns)
+		float latencyMs;	// smoothed queue depth
+		float fill;			// queue depth / ring-buffer size
+		float correction;	// relative rate correction (eg. 0.001 = 0.1% more samples)
+		UINT underruns;		// seen by the controller
+	};
+
+	SoundLatencyController(void);
+
+	void Init(uint32_t dwBufferSize, uint32_t nSampleRate, int nChannels);
+	void Reset(void);
+
+	// Measures the queue after nNumSamples have been produced
+	// Returns false if not enabled, else sets nNumSamplesError: the correction for the next period
+	// . pendingWrites: the caller has writes still queued (MB audio thread), so only nBytesRemaining is up to date
+	bool Update(SoundBuffer& buffer, int nBytesRemaining, UINT nNumSamples, bool bUnderrun, int& nNumSamplesError, bool pendingWrites = false);
+	Stats GetStats(void) const;
+
+private:
+	void Publish(double correction);
+
+	double m_sampleRate;
+	double m_bytesPerSecond;
+	double m_bufferSize;	// in seconds
+	double m_target;		// in seconds
+	double m_latency;		// in seconds
+	double m_integral;
+	double m_residual;
+	double m_stableTime;	// since the last back-off
+	bool m_primed;			// target reached since Reset()
+
+	// read by the UI
+	std::atomic<float> m_statTargetMs;
+	std::atomic<float> m_statLatencyMs;
+	std::atomic<float> m_statFill;
+	std::atomic<float> m_statCorrection;
+	std::atomic<UINT> m_statUnderruns;
+};
+
 struct VOICE
 {
 	std::shared_ptr<SoundBuffer> lpDSBvoice;
@@ -17,6 +67,7 @@ struct VOICE
 	bool bIsSpeaker;
 	bool bRecentlyActive;	// (Speaker only) false after 0.2s of speaker inactivity
 	std::string name;
+	SoundLatencyController latency;
 
 	VOICE(void)
 	{
@@ -56,6 +107,10 @@ void SoundCore_SetErrorInc(const int nErrorInc);
 int SoundCore_GetErrorMax();
 void SoundCore_SetErrorMax(const int nErrorMax);
 
+UINT SoundCore_GetTargetLatency();
+void SoundCore_SetTargetLatency(const UINT ms);	// 0 = AppleWin's heuristic
+bool SoundCore_GetLatencyStats(const SoundBuffer* pBuffer, SoundLatencyController::Stats& stats);
+
 void SoundCore_StopTimer();
 
 LONG NewVolume(uint32_t dwVolume, uint32_t dwVolumeMax);
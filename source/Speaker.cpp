@@ -34,6 +34,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Interface.h"
 #include "Log.h"
 #include "Memory.h"
+#include "PerfCounters.h"
 #include "SoundCore.h"
 #include "YamlHelper.h"
 #include "Riff.h"
@@ -68,13 +69,10 @@ const short		SPKR_DATA_INIT = (short)0x8000;
 short		g_nSpeakerData	= SPKR_DATA_INIT;
 static UINT		g_nBufferIdx	= 0;		// Sample index
 
-static short*	g_pRemainderBuffer = NULL;
-static UINT		g_nRemainderBufferSize;		// Setup in SpkrInitialize()
-static UINT		g_nRemainderBufferIdx;		// Setup in SpkrInitialize()
-
 // Application-wide globals:
 SoundType_e		soundtype		= SOUND_WAVE;
 double		    g_fClksPerSpkrSample;		// Setup in SetClksPerSpkrSample()
+static UINT		g_nClksPerSpkrSample;		// Setup in SetClksPerSpkrSample()
 
 // Allow temporary quietening of speaker (8 bit DAC)
 bool			g_bQuieterSpeaker = false;
@@ -190,24 +188,106 @@ static void SetClksPerSpkrSample()
 	// Use integer value: Better for MJ Mahon's RT.SYNTH.DSK (integer multiples of 1.023MHz Clk)
 	// . 23 clks @ 1.023MHz
 	g_fClksPerSpkrSample = (double) (UINT) (g_fCurrentCLK6502 / (double)SPKR_SAMPLE_RATE);
+
+	g_nClksPerSpkrSample = g_fClksPerSpkrSample >= 1.0 ? (UINT) g_fClksPerSpkrSample : 1;
 }
 
 //=============================================================================
+//
+// Band-limited synthesis
+//
+// SpkrToggle() only records the cycle of each edge. UpdateSpkr() then renders all
+// the samples up to the current cycle in one pass:
+// - each edge adds a band-limited impulse of its level change (a windowed sinc, for
+//   the edge's cycle within the sample) into g_nBlepDiff[],
+// - each sample is the running sum of g_nBlepDiff[], ie. band-limited steps.
+// This replaces a per-cycle box filter, which aliases badly (especially when the
+// 6502 runs faster than 1MHz).
+// The output is delayed by SPKR_BLEP_TAPS/2 samples (0.2ms).
+//
+// The band-limited steps of a square wave overshoot by up to ~22%, so the output
+// has SPKR_BLEP_GAIN headroom instead of being clipped (clipping brings back aliases).
+//
+
+static const UINT SPKR_BLEP_TAPS = 16;
+static const double SPKR_BLEP_CUTOFF = 0.40;	// fraction of SPKR_SAMPLE_RATE (~17.6KHz, -60dB at 24.1KHz)
+static const int SPKR_BLEP_ONE = 1 << 13;		// each phase of the kernel sums to exactly this (levels fit in 32 bits)
+static const int SPKR_BLEP_GAIN_NUM = 2;		// SPKR_BLEP_GAIN = 2/3
+static const int SPKR_BLEP_GAIN_DEN = 3;
+static const UINT SPKR_BLEP_BUFFER = 1024;		// samples, before moving the pending taps back to the start
+
+static std::vector<int> g_blepKernel;			// [g_nClksPerSpkrSample][SPKR_BLEP_TAPS]: one phase per cycle
+static int g_nBlepDiff[SPKR_BLEP_BUFFER + SPKR_BLEP_TAPS];	// level changes, per sample
+static UINT g_nBlepIdx = 0;
+static int g_nBlepLevel = 0;					// running sum (scaled by SPKR_BLEP_ONE)
+static short g_nBlepLastData = SPKR_DATA_INIT;		// level of the last rendered edge
 
-static void InitRemainderBuffer()
+struct SpkrEdge
 {
-	delete [] g_pRemainderBuffer;
+	unsigned __int64 cycle;
+	short level;			// g_nSpeakerData after the edge
+	bool resetDCFilter;
+};
 
-	SetClksPerSpkrSample();
+static const UINT SPKR_MAX_EDGES = 4096;	// else rendered early
+static SpkrEdge g_spkrEdges[SPKR_MAX_EDGES];
+static UINT g_nSpkrNumEdges = 0;
 
-	g_nRemainderBufferSize = (UINT) g_fClksPerSpkrSample;
-	if ((double)g_nRemainderBufferSize < g_fClksPerSpkrSample)
-		g_nRemainderBufferSize++;
+static void MakeBlepKernel(const UINT nPhases)
+{
+	const double pi = 3.14159265358979323846;
+	const double center = SPKR_BLEP_TAPS / 2.0;
+	const double window = center + 0.5;		// half-width: the taps are in (-center-1, center]
 
-	g_pRemainderBuffer = new short [g_nRemainderBufferSize];
-	memset(g_pRemainderBuffer, 0, g_nRemainderBufferSize);
+	g_blepKernel.resize(nPhases * SPKR_BLEP_TAPS);
 
-	g_nRemainderBufferIdx = 0;
+	for (UINT p = 0; p < nPhases; p++)
+	{
+		const double frac = (double)p / nPhases;	// position of the edge in its sample
+		int* pKernel = &g_blepKernel[p * SPKR_BLEP_TAPS];
+
+		double kernel[SPKR_BLEP_TAPS];
+		double sum = 0.0;
+		for (UINT k = 0; k < SPKR_BLEP_TAPS; k++)
+		{
+			// from the edge to the middle of sample k
+			const double t = k + 0.5 - frac - center;
+			const double x = 2.0 * SPKR_BLEP_CUTOFF * t;
+			const double sinc = (x == 0.0) ? 1.0 : sin(pi * x) / (pi * x);
+			const double blackman = 0.42 + 0.5 * cos(pi * t / window) + 0.08 * cos(2.0 * pi * t / window);
+			kernel[k] = sinc * blackman;
+			sum += kernel[k];
+		}
+
+		int total = 0;
+		for (UINT k = 0; k < SPKR_BLEP_TAPS; k++)
+		{
+			pKernel[k] = (int) floor(kernel[k] / sum * SPKR_BLEP_ONE + 0.5);
+			total += pKernel[k];
+		}
+
+		// Exact sum, so that the running sum ends on the new level (no drift)
+		pKernel[SPKR_BLEP_TAPS / 2] += SPKR_BLEP_ONE - total;
+	}
+}
+
+static void ResetSpkrSynth(void)
+{
+	memset(g_nBlepDiff, 0, sizeof(g_nBlepDiff));
+	g_nBlepIdx = 0;
+	g_nBlepLevel = g_nSpeakerData * SPKR_BLEP_ONE;
+	g_nBlepLastData = g_nSpeakerData;
+	g_nSpkrNumEdges = 0;
+}
+
+static void InitSpkrSynth()
+{
+	SetClksPerSpkrSample();
+
+	if (g_blepKernel.size() != g_nClksPerSpkrSample * SPKR_BLEP_TAPS)
+		MakeBlepKernel(g_nClksPerSpkrSample);
+
+	ResetSpkrSynth();
 }
 
 //
@@ -225,10 +305,8 @@ void SpkrDestroy ()
 	if(soundtype == SOUND_WAVE)
 	{
 		delete [] g_pSpeakerBuffer;
-		delete [] g_pRemainderBuffer;
-		
+
 		g_pSpeakerBuffer = NULL;
-		g_pRemainderBuffer = NULL;
 	}
 }
 
@@ -274,7 +352,7 @@ void SpkrInitialize ()
 
 	if (soundtype == SOUND_WAVE)
 	{
-		InitRemainderBuffer();
+		InitSpkrSynth();
 
 		g_pSpeakerBuffer = new short [SPKR_SAMPLE_RATE * g_nSPKR_NumChannels];	// Buffer can hold a max of 1 seconds worth of samples
 	}
@@ -287,7 +365,7 @@ void SpkrReinitialize ()
 {
 	if (soundtype == SOUND_WAVE)
 	{
-		InitRemainderBuffer();
+		InitSpkrSynth();
 	}
 }
 
@@ -299,7 +377,7 @@ void SpkrReset()
 	g_nSpkrQuietCycleCount = 0;
 	g_bSpkrToggleFlag = false;
 
-	InitRemainderBuffer();
+	InitSpkrSynth();
 	Spkr_SubmitWaveBuffer(NULL, 0);
 	Spkr_SetActive(false);
 	Spkr_Unmute();
@@ -318,85 +396,106 @@ void SpkrSetEmulationType (SoundType_e newtype)
 
 //=============================================================================
 
-static void ReinitRemainderBuffer(UINT nCyclesRemaining)
+static void RenderSpkrSamples(UINT nNumSamples)
 {
-	if(nCyclesRemaining == 0)
-		return;
+	while (nNumSamples)
+	{
+		if (g_nBlepIdx == SPKR_BLEP_BUFFER)
+		{
+			memcpy(g_nBlepDiff, &g_nBlepDiff[SPKR_BLEP_BUFFER], SPKR_BLEP_TAPS * sizeof(g_nBlepDiff[0]));
+			memset(&g_nBlepDiff[SPKR_BLEP_BUFFER], 0, SPKR_BLEP_TAPS * sizeof(g_nBlepDiff[0]));
+			g_nBlepIdx = 0;
+		}
 
-	for(g_nRemainderBufferIdx=0; g_nRemainderBufferIdx<nCyclesRemaining; g_nRemainderBufferIdx++)
-		g_pRemainderBuffer[g_nRemainderBufferIdx] = g_nSpeakerData;
+		const UINT nCount = std::min(nNumSamples, SPKR_BLEP_BUFFER - g_nBlepIdx);
+		int* pDiff = &g_nBlepDiff[g_nBlepIdx];
+		g_nBlepIdx += nCount;
+		nNumSamples -= nCount;
 
-	_ASSERT(g_nRemainderBufferIdx < g_nRemainderBufferSize);
-}
+		// Samples past a full speaker buffer are dropped
+		const UINT nRoom = g_nBufferIdx < SPKR_SAMPLE_RATE - 1 ? SPKR_SAMPLE_RATE - 1 - g_nBufferIdx : 0;
+		const UINT nStore = std::min(nCount, nRoom);
+		int level = g_nBlepLevel;	// locals: the compiler can't tell that pDiff doesn't alias them
+		short* pBuffer = &g_pSpeakerBuffer[g_nBufferIdx * g_nSPKR_NumChannels];
 
-static void UpdateRemainderBuffer(ULONG* pnCycleDiff)
-{
-	if(g_nRemainderBufferIdx)
-	{
-		while((g_nRemainderBufferIdx < g_nRemainderBufferSize) && *pnCycleDiff)
+		for (UINT i = 0; i < nStore; i++)
 		{
-			g_pRemainderBuffer[g_nRemainderBufferIdx] = g_nSpeakerData;
-			g_nRemainderBufferIdx++;
-			(*pnCycleDiff)--;
+			level += pDiff[i];
+			pDiff[i] = 0;
+
+			int sample = level * SPKR_BLEP_GAIN_NUM / (SPKR_BLEP_ONE * SPKR_BLEP_GAIN_DEN);
+			if (sample > 32767) sample = 32767;
+			if (sample < -32768) sample = -32768;
+
+			const short filtered = DCFilter((short)sample);
+			for (UINT c = 0; c < g_nSPKR_NumChannels; c++)
+				*pBuffer++ = filtered;
 		}
 
-		if(g_nRemainderBufferIdx == g_nRemainderBufferSize)
+		for (UINT i = nStore; i < nCount; i++)
 		{
-			g_nRemainderBufferIdx = 0;
-			signed long nSampleMean = 0;
-			for(UINT i=0; i<g_nRemainderBufferSize; i++)
-				nSampleMean += (signed long) g_pRemainderBuffer[i];
-			nSampleMean /= (signed long) g_nRemainderBufferSize;
-
-			if (g_nBufferIdx < SPKR_SAMPLE_RATE - 1)
-			{
-				if (g_nSPKR_NumChannels == 1)
-				{
-					g_pSpeakerBuffer[g_nBufferIdx] = DCFilter((short)nSampleMean);
-				}
-				else
-				{
-					const short sample = DCFilter((short)nSampleMean);
-					g_pSpeakerBuffer[g_nBufferIdx * 2 + 0] = sample;
-					g_pSpeakerBuffer[g_nBufferIdx * 2 + 1] = sample;
-				}
-				g_nBufferIdx++;
-			}
+			level += pDiff[i];
+			pDiff[i] = 0;
 		}
+
+		g_nBlepLevel = level;
+		g_nBufferIdx += nStore;
 	}
 }
 
 static void UpdateSpkr()
 {
-  if(!g_bFullSpeed || SoundCore_GetTimerState())
-  {
-	  ULONG nCycleDiff = (ULONG) (g_nCumulativeCycles - g_nSpkrLastCycle);
+	// The last edge's level: g_nSpeakerData may have been changed since (eg. by the SAM card)
+	if (g_nSpkrNumEdges)
+		g_spkrEdges[g_nSpkrNumEdges - 1].level = g_nSpeakerData;
 
-	  UpdateRemainderBuffer(&nCycleDiff);
+	if (g_bFullSpeed && !SoundCore_GetTimerState())
+	{
+		ResetSpkrSynth();
+		g_nSpkrLastCycle = g_nCumulativeCycles;
+		return;
+	}
 
-	  ULONG nNumSamples = (ULONG) ((double)nCycleDiff / g_fClksPerSpkrSample);
+	if (g_nCumulativeCycles < g_nSpkrLastCycle)	// eg. after loading an old save-state
+		g_nSpkrLastCycle = g_nCumulativeCycles;
 
-	  ULONG nCyclesRemaining = (ULONG) ((double)nCycleDiff - (double)nNumSamples * g_fClksPerSpkrSample);
+	// g_nSpkrLastCycle is the start of the next sample
+	// . nPhase: cycles from the start of the current sample to /cycle/
+	const UINT nClks = g_nClksPerSpkrSample;
+	unsigned __int64 cycle = g_nSpkrLastCycle;
+	UINT nPhase = 0;
 
-	  while ((nNumSamples--) && (g_nBufferIdx < SPKR_SAMPLE_RATE - 1))
-	  {
-		  if (g_nSPKR_NumChannels == 1)
-		  {
-			  g_pSpeakerBuffer[g_nBufferIdx] = DCFilter(g_nSpeakerData);
-		  }
-		  else
-		  {
-			  const short sample = DCFilter(g_nSpeakerData);
-			  g_pSpeakerBuffer[g_nBufferIdx * 2 + 0] = sample;
-			  g_pSpeakerBuffer[g_nBufferIdx * 2 + 1] = sample;
-		  }
-		  g_nBufferIdx++;
-	  }
+	for (UINT i = 0; i < g_nSpkrNumEdges; i++)
+	{
+		const SpkrEdge& edge = g_spkrEdges[i];
+		if (edge.cycle > cycle)
+		{
+			nPhase += (UINT) (edge.cycle - cycle);
+			cycle = edge.cycle;
+			if (nPhase >= nClks)
+			{
+				RenderSpkrSamples(nPhase / nClks);
+				nPhase %= nClks;
+			}
+		}
 
-	  ReinitRemainderBuffer(nCyclesRemaining);	// Partially fill 1Mhz sample buffer
-  }
+		const int delta = edge.level - g_nBlepLastData;
+		g_nBlepLastData = edge.level;
+
+		const int* pKernel = &g_blepKernel[nPhase * SPKR_BLEP_TAPS];
+		int* pDiff = &g_nBlepDiff[g_nBlepIdx];
+		for (UINT k = 0; k < SPKR_BLEP_TAPS; k++)
+			pDiff[k] += delta * pKernel[k];
 
-  g_nSpkrLastCycle = g_nCumulativeCycles;
+		if (edge.resetDCFilter)
+			ResetDCFilter();
+	}
+
+	g_nSpkrNumEdges = 0;
+
+	nPhase += (UINT) (g_nCumulativeCycles - cycle);
+	RenderSpkrSamples(nPhase / nClks);
+	g_nSpkrLastCycle = g_nCumulativeCycles - nPhase % nClks;
 }
 
 //=============================================================================
@@ -424,20 +523,26 @@ BYTE __stdcall SpkrToggle (WORD, WORD, BYTE, BYTE, ULONG nExecutedCycles)
   {
 	  CpuCalcCycles(nExecutedCycles);
 
-	  UpdateSpkr();
+	  if (g_nSpkrNumEdges == SPKR_MAX_EDGES)
+		  UpdateSpkr();
+	  else if (g_nSpkrNumEdges)
+		  g_spkrEdges[g_nSpkrNumEdges - 1].level = g_nSpeakerData;	// in case it was changed since (eg. by the SAM card)
 
       short speakerDriveLevel = SPKR_DATA_INIT;
       if (g_bQuieterSpeaker)	// quieten the speaker if 8 bit DAC in use
         speakerDriveLevel /= 4;	// NB. Don't shift -ve number right: undefined behaviour (MSDN says: implementation-dependent)
 
-      // When full-speed: Don't ResetDCFilter(), otherwise get occasional clicks when speaker toggled
-      if (!g_bFullSpeed)
-        ResetDCFilter();
-
       if (g_nSpeakerData == speakerDriveLevel)
         g_nSpeakerData = ~speakerDriveLevel;
       else
         g_nSpeakerData = speakerDriveLevel;
+
+      // Rendered by the next UpdateSpkr()
+      SpkrEdge& edge = g_spkrEdges[g_nSpkrNumEdges++];
+      edge.cycle = g_nCumulativeCycles;
+      edge.level = g_nSpeakerData;
+      // When full-speed: Don't ResetDCFilter(), otherwise get occasional clicks when speaker toggled
+      edge.resetDCFilter = !g_bFullSpeed;
   }
 
   return MemReadFloatingBus(nExecutedCycles);
@@ -448,10 +553,7 @@ BYTE __stdcall SpkrToggle (WORD, WORD, BYTE, BYTE, ULONG nExecutedCycles)
 // Called by ContinueExecution()
 void SpkrUpdate (uint32_t totalcycles)
 {
-#ifdef LOG_PERF_TIMINGS
-	extern UINT64 g_timeSpeaker;
-	PerfMarker perfMarker(g_timeSpeaker);
-#endif
+	PerfMarker perfMarker(PERF_SPEAKER);
 
   if(!g_bSpkrToggleFlag)
   {
@@ -732,6 +834,7 @@ static ULONG Spkr_SubmitWaveBuffer(short* pSpeakerBuffer, ULONG nNumSamples)
 		// Re-init from SpkrReset()
 		dwByteOffset = (uint32_t)-1;
 		nNumSamplesError = 0;
+		SpeakerVoice.latency.Reset();
 
 		// Don't call DSZeroVoiceBuffer() - get noise with "VIA AC'97 Enhanced Audio Controller"
 		// . I guess SpeakerVoice.Stop() isn't really working and the new zero buffer causes noise corruption when submitted.
@@ -805,13 +908,16 @@ static ULONG Spkr_SubmitWaveBuffer(short* pSpeakerBuffer, ULONG nNumSamples)
 		nBytesRemaining = g_dwDSSpkrBufferSize;		// Case when complete buffer is to be played
 
 	// Calc correction factor so that play-buffer doesn't under/overflow
-	const int nErrorInc = SoundCore_GetErrorInc();
-	if(nBytesRemaining < g_dwDSSpkrBufferSize / 4)
-		nNumSamplesError += nErrorInc;				// < 1/4 of play-buffer remaining (need *more* data)
-	else if(nBytesRemaining > g_dwDSSpkrBufferSize / 2)
-		nNumSamplesError -= nErrorInc;				// > 1/2 of play-buffer remaining (need *less* data)
-	else
-		nNumSamplesError = 0;						// Acceptable amount of data in buffer
+	if (!SpeakerVoice.latency.Update(*SpeakerVoice.lpDSBvoice, nBytesRemaining, nNumSamples, bBufferError, nNumSamplesError))
+	{
+		const int nErrorInc = SoundCore_GetErrorInc();
+		if(nBytesRemaining < g_dwDSSpkrBufferSize / 4)
+			nNumSamplesError += nErrorInc;				// < 1/4 of play-buffer remaining (need *more* data)
+		else if(nBytesRemaining > g_dwDSSpkrBufferSize / 2)
+			nNumSamplesError -= nErrorInc;				// > 1/2 of play-buffer remaining (need *less* data)
+		else
+			nNumSamplesError = 0;						// Acceptable amount of data in buffer
+	}
 
 	const int nErrorMax = SoundCore_GetErrorMax();				// Cap feedback to +/-nMaxError units
 	if(nNumSamplesError < -nErrorMax) nNumSamplesError = -nErrorMax;
@@ -1027,6 +1133,7 @@ void SpkrLoadSnapshot(YamlLoadHelper& yamlLoadHelper)
 		return;
 
 	g_nSpkrLastCycle = yamlLoadHelper.LoadUint64(SS_YAML_KEY_LASTCYCLE);
+	ResetSpkrSynth();
 
 	yamlLoadHelper.PopMap();
 }
@@ -43,6 +43,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "SynchronousEventManager.h"
 #include "CPU.h"
+#include "PerfCounters.h"
 
 void SynchronousEventManager::Insert(SyncEvent* pNewEvent)
 {
@@ -151,7 +152,10 @@ void SynchronousEventManager::Update(int cycles, ULONG uExecutedCycles)
 
 		int cyclesUnderflowed = -pCurrEvent->m_cyclesRemaining;
 
-		pCurrEvent->m_cyclesRemaining = pCurrEvent->m_callback(pCurrEvent->m_id, cycles, uExecutedCycles);
+		{
+			PerfMarker perfMarker(PERF_SYNC_EVENTS);
+			pCurrEvent->m_cyclesRemaining = pCurrEvent->m_callback(pCurrEvent->m_id, cycles, uExecutedCycles);
+		}
 		m_syncEventHead = pCurrEvent->m_next;	// unlink this event
 
 		pCurrEvent->m_active = false;
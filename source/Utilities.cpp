@@ -31,6 +31,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Core.h"
 #include "CardManager.h"
 #include "CPU.h"
+#include "DiskImage.h"
 #include "Joystick.h"
 #include "Log.h"
 #include "ParallelPrinter.h"
@@ -206,6 +207,9 @@ void LoadConfiguration(bool loadImages)
 	if(REGLOAD(REGVALUE_SAVE_STATE_ON_EXIT, &dwTmp))
 		g_bSaveStateOnExit = dwTmp ? true : false;
 
+	if(REGLOAD(REGVALUE_SAVE_STATE_COMPRESS, &dwTmp))
+		Snapshot_SetCompress(dwTmp ? true : false);
+
 	if(REGLOAD(REGVALUE_PDL_XTRIM, &dwTmp))
 		JoySetTrim((short)dwTmp, true);
 	if(REGLOAD(REGVALUE_PDL_YTRIM, &dwTmp))
@@ -288,6 +292,15 @@ void LoadConfiguration(bool loadImages)
 	REGLOAD(REGVALUE_MB_VOLUME, &dwTmp);
 	GetCardMgr().GetMockingboardCardMgr().SetVolume(dwTmp, GetPropertySheet().GetVolumeMax());
 
+	// Set before inserting any harddisk/disk images, as it's only applied when an image is opened
+	uint32_t dwImageOverlay;
+	REGLOAD_DEFAULT(REGVALUE_DISK_IMAGE_OVERLAY, &dwImageOverlay, 0);
+	ImageSetOverlay(dwImageOverlay ? true : false);
+
+	char szOverlaySession[MAX_PATH];
+	RegLoadString(REG_CONFIG, REGVALUE_DISK_IMAGE_OVERLAY_SESSION, 1, szOverlaySession, MAX_PATH, "");
+	ImageSetOverlaySession(szOverlaySession);
+
 	// Load save-state pathname *before* inserting any harddisk/disk images (for both init & reinit cases)
 	// NB. inserting harddisk/disk can change snapshot pathname
 	RegLoadString(REG_CONFIG, REGVALUE_SAVESTATE_FILENAME, 1, szFilename, MAX_PATH, "");	// Can be pathname or just filename
@@ -325,6 +338,10 @@ void LoadConfiguration(bool loadImages)
 	REGLOAD_DEFAULT(REGVALUE_ENHANCE_DISK_SPEED, &dwEnhanceDisk, 1);
 	GetCardMgr().GetDisk2CardMgr().SetEnhanceDisk(dwEnhanceDisk ? true : false);
 
+	uint32_t dwFastLoad;
+	REGLOAD_DEFAULT(REGVALUE_DISK_FAST_LOAD, &dwFastLoad, 0);
+	GetCardMgr().GetDisk2CardMgr().SetFastLoad(dwFastLoad ? true : false);
+
 	//
 
 	if (GetCardMgr().IsParallelPrinterCardInstalled())
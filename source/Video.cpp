@@ -140,13 +140,39 @@ int Video::GetFrameBufferCentringValue(void)
 
 	if (HasVidHD())
 	{
-		value -= GetFrameBufferCentringOffsetY() * GetFrameBufferWidth();
+		value += GetFrameBufferCentringOffsetY() * GetFrameBufferRowStep();
 		value += GetFrameBufferCentringOffsetX();
 	}
 
 	return value;
 }
 
+void Video::SetFrameBufferLayout(bool topDown, UINT pitch)
+{
+	m_frameBufferTopDown = topDown;
+	m_frameBufferPitch = pitch;
+}
+
+UINT Video::GetFrameBufferPitch(void)
+{
+	// the width changes with VidHD
+	return std::max(m_frameBufferPitch, GetFrameBufferWidth());
+}
+
+int Video::GetFrameBufferRowStep(void)
+{
+	const int pitch = GetFrameBufferPitch();
+	return m_frameBufferTopDown ? pitch : -pitch;
+}
+
+UINT Video::GetFrameBufferScanLineOffset(UINT y)
+{
+	const UINT row = m_frameBufferTopDown
+		? GetFrameBufferBorderHeight() + y
+		: (GetFrameBufferHeight() - 1) - y - GetFrameBufferBorderHeight();
+	return row * GetFrameBufferPitch() + GetFrameBufferBorderWidth();
+}
+
 //===========================================================================
 
 void Video::VideoReinitialize(bool bInitVideoScannerAddress)
@@ -562,17 +588,13 @@ void Video::Video_MakeScreenShot(FILE *pFile, const VideoScreenShot_e ScreenShot
 	// Write Pixel Data
 	// No need to use GetDibBits() since we already have http://msdn.microsoft.com/en-us/library/ms532334.aspx
 	// @reference: "Storing an Image" http://msdn.microsoft.com/en-us/library/ms532340(VS.85).aspx
+	// The bitmap is bottom-up: start from the last scanline and move up
+	const int rowStep = GetFrameBufferRowStep();
 	pSrc = (uint32_t*) g_pFramebufferbits;
 
-	int xSrc = GetFrameBufferBorderWidth();
-	int ySrc = GetFrameBufferBorderHeight();
-
-	pSrc += xSrc;								// Skip left border
-	pSrc += ySrc * GetFrameBufferWidth();		// Skip top border
-
 	if( ScreenShotType == SCREENSHOT_280x192 )
 	{
-		pSrc += GetFrameBufferWidth();	// Start on odd scanline (otherwise for 50% scanline mode get an all black image!)
+		pSrc += GetFrameBufferScanLineOffset(GetFrameBufferBorderlessHeight() - 2);	// Start on odd scanline (otherwise for 50% scanline mode get an all black image!)
 
 		uint32_t  aScanLine[kVideoWidthIIgs / 2];	// Big enough to contain both a 280 or 320 line
 		uint32_t *pDst;
@@ -589,16 +611,18 @@ void Video::Video_MakeScreenShot(FILE *pFile, const VideoScreenShot_e ScreenShot
 				pSrc += 2; // skip odd pixels
 			}
 			fwrite( aScanLine, sizeof(uint32_t), GetFrameBufferBorderlessWidth()/2, pFile );
-			pSrc += GetFrameBufferWidth();			// scan lines doubled - skip odd ones
-			pSrc += GetFrameBufferBorderWidth()*2;	// Skip right border & next line's left border
+			pSrc -= GetFrameBufferBorderlessWidth();	// Back to the left edge
+			pSrc -= rowStep * 2;						// scan lines doubled - skip odd ones
 		}
 	}
 	else
 	{
+		pSrc += GetFrameBufferScanLineOffset(GetFrameBufferBorderlessHeight() - 1);
+
 		for( UINT y = 0; y < GetFrameBufferBorderlessHeight(); y++ )
 		{
 			fwrite( pSrc, sizeof(uint32_t), GetFrameBufferBorderlessWidth(), pFile );
-			pSrc += GetFrameBufferWidth();
+			pSrc -= rowStep;
 		}
 	}
 
@@ -870,7 +894,31 @@ void Video::VideoRefreshBuffer(uint32_t uRedrawWholeScreenVideoMode, bool bRedra
 void Video::ClearFrameBuffer(void)
 {
 	UINT32* frameBuffer = (UINT32*)GetFrameBuffer();
-	std::fill(frameBuffer, frameBuffer + GetFrameBufferWidth() * GetFrameBufferHeight(), OPAQUE_BLACK);
+	std::fill(frameBuffer, frameBuffer + GetFrameBufferPitch() * GetFrameBufferHeight(), OPAQUE_BLACK);
+	InvalidateOtherFrameBuffers();
+}
+
+void Video::SwapFrameBuffer(void)
+{
+	uint8_t* frameBuffer = GetFrame().VideoSwapFrameBuffer(GetFrameBuffer());
+	if (frameBuffer == GetFrameBuffer())
+		return;
+
+	SetFrameBuffer(frameBuffer);
+	NTSC_SetFrameBuffer(frameBuffer);
+
+	// Not everything is redrawn every frame (eg. borders, VidHD margins)
+	if (std::find(m_validFrameBuffers.begin(), m_validFrameBuffers.end(), frameBuffer) == m_validFrameBuffers.end())
+	{
+		UINT32* pixels = (UINT32*)frameBuffer;
+		std::fill(pixels, pixels + GetFrameBufferPitch() * GetFrameBufferHeight(), OPAQUE_BLACK);
+		m_validFrameBuffers.push_back(frameBuffer);
+	}
+}
+
+void Video::InvalidateOtherFrameBuffers(void)
+{
+	m_validFrameBuffers.assign(1, GetFrameBuffer());
 }
 
 // Called when entering debugger, and after viewing Apple II video screen from debugger
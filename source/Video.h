@@ -197,6 +197,8 @@ public:
 		g_videoRomSize = 0;
 		g_videoRomRockerSwitch = false;
 		m_hasVidHD = false;
+		m_frameBufferTopDown = false;
+		m_frameBufferPitch = 0;
 	}
 
 	~Video(void){}
@@ -217,6 +219,14 @@ public:
 	UINT GetFrameBufferCentringOffsetY(void);
 	int GetFrameBufferCentringValue(void);
 
+	// layout of the video buffer: bottom-up like a Windows DIB (default) or top-down, rows are GetFrameBufferPitch() pixels apart
+	// pitch == 0 means GetFrameBufferWidth(). Must be set before Initialize()
+	void SetFrameBufferLayout(bool topDown, UINT pitch = 0);
+	bool IsFrameBufferTopDown(void) { return m_frameBufferTopDown; }
+	UINT GetFrameBufferPitch(void);
+	int GetFrameBufferRowStep(void);				// in pixels, from one scanline to the one below it
+	UINT GetFrameBufferScanLineOffset(UINT y);		// in pixels, from the start of the video buffer to the left edge of scanline y (excluding borders)
+
 	COLORREF GetMonochromeRGB(void) { return g_nMonochromeRGB; }
 	void SetMonochromeRGB(COLORREF colorRef) { g_nMonochromeRGB = colorRef; }
 
@@ -226,6 +236,11 @@ public:
 	void ClearFrameBuffer(void);
 	void ClearSHRResidue(void);
 
+	// Called when a whole frame has been drawn: see FrameBase::VideoSwapFrameBuffer()
+	void SwapFrameBuffer(void);
+	// The content of the frame buffers other than the current one is obsolete: clear them before drawing into them
+	void InvalidateOtherFrameBuffers(void);
+
 	enum VideoScanner_e {VS_FullAddr, VS_PartialAddrV, VS_PartialAddrH};
 	WORD VideoGetScannerAddress(uint32_t nCycles, VideoScanner_e videoScannerAddr = VS_FullAddr);
 	bool VideoGetVblBarEx(const uint32_t dwCyclesThisFrame);
@@ -300,6 +315,9 @@ private:
 	bool g_bVideoScannerNTSC;	// NTSC video scanning (or PAL)
 	COLORREF g_nMonochromeRGB;	// saved to Registry
 	bool m_hasVidHD;
+	bool m_frameBufferTopDown;
+	UINT m_frameBufferPitch;
+	std::vector<uint8_t*> m_validFrameBuffers;	// frame buffers which do not need to be cleared before they are drawn into
 
 	static const UINT kVideoRomSize8K = kVideoRomSize4K*2;
 	static const UINT kVideoRomSize16K = kVideoRomSize8K*2;
@@ -40,6 +40,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Mockingboard.h"
 #include "MouseInterface.h"
 #include "ParallelPrinter.h"
+#include "PerfCounters.h"
 #include "Registry.h"
 #include "Riff.h"
 #include "SaveState.h"
@@ -137,10 +138,6 @@ static bool g_uModeStepping_LastGetKey_ScrollLock = false;
 
 static void ContinueExecution(void)
 {
-#ifdef LOG_PERF_TIMINGS
-	PerfMarker* pPerfMarkerTotal = new PerfMarker(g_timeTotal);
-#endif
-
 	_ASSERT(g_nAppMode == MODE_RUNNING || g_nAppMode == MODE_STEPPING);
 
 	const double fUsecPerSec        = 1.e6;
@@ -256,20 +253,18 @@ static void ContinueExecution(void)
 	const UINT dwClksPerFrame = NTSC_GetCyclesPerFrame();
 	if (g_dwCyclesThisFrame >= dwClksPerFrame && !GetVideo().VideoGetVblBarEx(g_dwCyclesThisFrame))
 	{
-#ifdef LOG_PERF_TIMINGS
-		PerfMarker perfMarkerVideoRefresh(g_timeVideoRefresh);
-#endif
 		g_dwCyclesThisFrame -= dwClksPerFrame;
 
-		if (g_bFullSpeed)
-			GetFrame().VideoRedrawScreenDuringFullSpeed(g_dwCyclesThisFrame);
-		else
-			GetFrame().VideoPresentScreen(); // Just copy the output of our Apple framebuffer to the system Back Buffer
-	}
+		{
+			PerfMarker perfMarkerVideoRefresh(PERF_PRESENT);
+			if (g_bFullSpeed)
+				GetFrame().VideoRedrawScreenDuringFullSpeed(g_dwCyclesThisFrame);
+			else
+				GetFrame().VideoPresentScreen(); // Just copy the output of our Apple framebuffer to the system Back Buffer
+		}
 
-#ifdef LOG_PERF_TIMINGS
-	delete pPerfMarkerTotal;	// Explicitly call dtor *before* SysClk_WaitTimer()
-#endif
+		PerfCounters_EndFrame();
+	}
 
 	if ((g_nAppMode == MODE_RUNNING && !g_bFullSpeed) || bModeStepping_WaitTimer)
 	{
@@ -26,16 +26,205 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "YamlHelper.h"
 #include "Log.h"
 
+#include "zlib.h"
+
 #include <sstream>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define YAML_HEX_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define YAML_HEX_SSE2
+#endif
+
+//-------------------------------------
+
+// Hex conversion of memory blocks: SSE2 (or AVX2) where the compiler targets it, else a table per byte.
+// Output is uppercase, as the original per-byte code; input accepts both cases.
+
+static const char g_szHex[] = "0123456789ABCDEF";
+
+#if defined(YAML_HEX_SSE2) || defined(YAML_HEX_AVX2)
+
+// 16 nibbles (0..15) -> 16 ASCII hex digits
+static inline __m128i NibblesToHex(const __m128i n)
+{
+	const __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(n, _mm_set1_epi8(9)), _mm_set1_epi8('A' - '0' - 10));
+	return _mm_add_epi8(_mm_add_epi8(n, _mm_set1_epi8('0')), letter);
+}
+
+// 16 bytes -> 32 chars
+static inline void HexEncode16(const BYTE* pSrc, char* pDst)
+{
+	const __m128i v = _mm_loadu_si128((const __m128i*)pSrc);
+	const __m128i mask = _mm_set1_epi8(0x0F);
+	const __m128i hi = NibblesToHex(_mm_and_si128(_mm_srli_epi16(v, 4), mask));
+	const __m128i lo = NibblesToHex(_mm_and_si128(v, mask));
+	_mm_storeu_si128((__m128i*)pDst, _mm_unpacklo_epi8(hi, lo));
+	_mm_storeu_si128((__m128i*)(pDst + 16), _mm_unpackhi_epi8(hi, lo));
+}
+
+// 16 ASCII chars -> 16 nibbles, or false if any is not a hex digit
+static inline bool HexToNibbles(const __m128i c, __m128i& n)
+{
+	// unsigned range checks: x in [a,b] <=> max(x,a) == x && min(x,b) == x
+	const __m128i l = _mm_or_si128(c, _mm_set1_epi8(0x20));	// lower case
+	const __m128i isDigit = _mm_and_si128(
+		_mm_cmpeq_epi8(_mm_max_epu8(c, _mm_set1_epi8('0')), c),
+		_mm_cmpeq_epi8(_mm_min_epu8(c, _mm_set1_epi8('9')), c));
+	const __m128i isLetter = _mm_and_si128(
+		_mm_cmpeq_epi8(_mm_max_epu8(l, _mm_set1_epi8('a')), l),
+		_mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8('f')), l));
+
+	if (_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) != 0xFFFF)
+		return false;
+
+	const __m128i digit = _mm_and_si128(isDigit, _mm_sub_epi8(c, _mm_set1_epi8('0')));
+	const __m128i letter = _mm_and_si128(isLetter, _mm_sub_epi8(l, _mm_set1_epi8('a' - 10)));
+	n = _mm_or_si128(digit, letter);
+	return true;
+}
+
+// 16 nibbles (in byte pairs: hi, lo) -> 8 bytes in the low byte of each 16-bit lane
+static inline __m128i PackNibbles(const __m128i n)
+{
+	const __m128i hi = _mm_and_si128(_mm_slli_epi16(n, 4), _mm_set1_epi16(0x00F0));
+	return _mm_or_si128(hi, _mm_srli_epi16(n, 8));
+}
+
+// 32 chars -> 16 bytes
+static inline bool HexDecode16(const char* pSrc, BYTE* pDst)
+{
+	__m128i n0, n1;
+	if (!HexToNibbles(_mm_loadu_si128((const __m128i*)pSrc), n0) ||
+		!HexToNibbles(_mm_loadu_si128((const __m128i*)(pSrc + 16)), n1))
+		return false;
+
+	_mm_storeu_si128((__m128i*)pDst, _mm_packus_epi16(PackNibbles(n0), PackNibbles(n1)));
+	return true;
+}
+
+#endif
+
+#if defined(YAML_HEX_AVX2)
+
+static inline __m256i NibblesToHex(const __m256i n)
+{
+	const __m256i letter = _mm256_and_si256(_mm256_cmpgt_epi8(n, _mm256_set1_epi8(9)), _mm256_set1_epi8('A' - '0' - 10));
+	return _mm256_add_epi8(_mm256_add_epi8(n, _mm256_set1_epi8('0')), letter);
+}
+
+// 32 bytes -> 64 chars
+static inline void HexEncode32(const BYTE* pSrc, char* pDst)
+{
+	const __m256i v = _mm256_loadu_si256((const __m256i*)pSrc);
+	const __m256i mask = _mm256_set1_epi8(0x0F);
+	const __m256i hi = NibblesToHex(_mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+	const __m256i lo = NibblesToHex(_mm256_and_si256(v, mask));
+	// unpack works within each 128-bit lane: bytes 0-7 & 16-23, then 8-15 & 24-31
+	const __m256i a = _mm256_unpacklo_epi8(hi, lo);
+	const __m256i b = _mm256_unpackhi_epi8(hi, lo);
+	_mm256_storeu_si256((__m256i*)pDst, _mm256_permute2x128_si256(a, b, 0x20));
+	_mm256_storeu_si256((__m256i*)(pDst + 32), _mm256_permute2x128_si256(a, b, 0x31));
+}
+
+static inline bool HexToNibbles(const __m256i c, __m256i& n)
+{
+	const __m256i l = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+	const __m256i isDigit = _mm256_and_si256(
+		_mm256_cmpeq_epi8(_mm256_max_epu8(c, _mm256_set1_epi8('0')), c),
+		_mm256_cmpeq_epi8(_mm256_min_epu8(c, _mm256_set1_epi8('9')), c));
+	const __m256i isLetter = _mm256_and_si256(
+		_mm256_cmpeq_epi8(_mm256_max_epu8(l, _mm256_set1_epi8('a')), l),
+		_mm256_cmpeq_epi8(_mm256_min_epu8(l, _mm256_set1_epi8('f')), l));
+
+	if (_mm256_movemask_epi8(_mm256_or_si256(isDigit, isLetter)) != -1)
+		return false;
+
+	const __m256i digit = _mm256_and_si256(isDigit, _mm256_sub_epi8(c, _mm256_set1_epi8('0')));
+	const __m256i letter = _mm256_and_si256(isLetter, _mm256_sub_epi8(l, _mm256_set1_epi8('a' - 10)));
+	n = _mm256_or_si256(digit, letter);
+	return true;
+}
+
+static inline __m256i PackNibbles(const __m256i n)
+{
+	const __m256i hi = _mm256_and_si256(_mm256_slli_epi16(n, 4), _mm256_set1_epi16(0x00F0));
+	return _mm256_or_si256(hi, _mm256_srli_epi16(n, 8));
+}
+
+// 64 chars -> 32 bytes
+static inline bool HexDecode32(const char* pSrc, BYTE* pDst)
+{
+	__m256i n0, n1;
+	if (!HexToNibbles(_mm256_loadu_si256((const __m256i*)pSrc), n0) ||
+		!HexToNibbles(_mm256_loadu_si256((const __m256i*)(pSrc + 32)), n1))
+		return false;
+
+	// pack works within each 128-bit lane, so restore the order of the 64-bit quarters
+	const __m256i packed = _mm256_packus_epi16(PackNibbles(n0), PackNibbles(n1));
+	_mm256_storeu_si256((__m256i*)pDst, _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+	return true;
+}
+
+#endif
+
+// Write 2*size chars (no terminator)
+static void HexEncode(const BYTE* pSrc, char* pDst, size_t size)
+{
+#if defined(YAML_HEX_AVX2)
+	for (; size >= 32; size -= 32, pSrc += 32, pDst += 64)
+		HexEncode32(pSrc, pDst);
+#endif
+#if defined(YAML_HEX_SSE2) || defined(YAML_HEX_AVX2)
+	for (; size >= 16; size -= 16, pSrc += 16, pDst += 32)
+		HexEncode16(pSrc, pDst);
+#endif
+	for (; size; size--)
+	{
+		const BYTE d = *pSrc++;
+		*pDst++ = g_szHex[d >> 4];
+		*pDst++ = g_szHex[d & 0xf];
+	}
+}
+
+// Decode whole 16 byte blocks from the 2*size chars, stopping at the first block holding a non-hex char.
+// Returns the number of bytes decoded: the caller converts (and validates) the remainder.
+static size_t HexDecodeBlocks(const char* pSrc, BYTE* pDst, size_t size)
+{
+	size_t done = 0;
+#if defined(YAML_HEX_AVX2)
+	for (; done + 32 <= size; done += 32)
+	{
+		if (!HexDecode32(pSrc + 2*done, pDst + done))
+			return done;
+	}
+#endif
+#if defined(YAML_HEX_SSE2) || defined(YAML_HEX_AVX2)
+	for (; done + 16 <= size; done += 16)
+	{
+		if (!HexDecode16(pSrc + 2*done, pDst + done))
+			return done;
+	}
+#endif
+	return done;
+}
+
 int YamlHelper::InitParser(const char* pPathname)
 {
-	m_hFile = fopen(pPathname, "r");
+	m_hFile = fopen(pPathname, "rb");
 	if (m_hFile == NULL)
 	{
 		return 0;
 	}
 
+	char magic[4];
+	if (fread(magic, 1, sizeof(magic), m_hFile) == sizeof(magic) && memcmp(magic, SS_BIN_MAGIC, sizeof(magic)) == 0)
+		return InitBinaryFile();
+
+	rewind(m_hFile);
+
 	if (!yaml_parser_initialize(&m_parser))
 	{
 		return 0;
@@ -56,6 +245,86 @@ void YamlHelper::FinaliseParser(void)
 
 	yaml_event_delete(&m_newEvent);
 	yaml_parser_delete(&m_parser);
+
+	m_bBinary = false;
+	m_binaryFile.clear();
+	m_pBinary = NULL;
+	m_binarySize = 0;
+	m_binaryPos = 0;
+	m_bBinaryMapPending = false;
+}
+
+int YamlHelper::InitParser(const BYTE* pData, const size_t size)
+{
+	if (size >= 4 && memcmp(pData, SS_BIN_MAGIC, 4) == 0)
+		return InitBinary(pData, size);
+
+	if (!yaml_parser_initialize(&m_parser))
+	{
+		return 0;
+	}
+
+	yaml_parser_set_input_string(&m_parser, pData, size);
+
+	return 1;
+}
+
+int YamlHelper::InitBinaryFile(void)
+{
+	if (fseek(m_hFile, 0, SEEK_END) != 0)
+		return 0;
+
+	const long size = ftell(m_hFile);
+	if (size < 0 || fseek(m_hFile, 0, SEEK_SET) != 0)
+		return 0;
+
+	m_binaryFile.resize(size);
+	if (fread(m_binaryFile.data(), 1, size, m_hFile) != (size_t)size)
+		return 0;
+
+	return InitBinary(m_binaryFile.data(), m_binaryFile.size());
+}
+
+// Pre: pData starts with SS_BIN_MAGIC
+int YamlHelper::InitBinary(const BYTE* pData, const size_t size)
+{
+	m_bBinary = true;
+	m_pBinary = pData;
+	m_binarySize = size;
+	m_binaryPos = sizeof(SS_BIN_MAGIC) - 1;
+
+	if (GetBinaryUint32() != SS_BIN_FORMAT_VER)
+		throw std::runtime_error("Binary save-state: unsupported format version");
+
+	return 1;
+}
+
+const BYTE* YamlHelper::GetBinaryBytes(const size_t size)
+{
+	if (size > m_binarySize - m_binaryPos)
+		throw std::runtime_error("Binary save-state: unexpected end of file");
+
+	const BYTE* pData = m_pBinary + m_binaryPos;
+	m_binaryPos += size;
+	return pData;
+}
+
+BYTE YamlHelper::GetBinaryByte(void)
+{
+	return *GetBinaryBytes(1);
+}
+
+UINT YamlHelper::GetBinaryUint32(void)
+{
+	const BYTE* pData = GetBinaryBytes(4);
+	return pData[0] | (pData[1] << 8) | (pData[2] << 16) | ((UINT)pData[3] << 24);
+}
+
+std::string YamlHelper::GetBinaryKey(void)
+{
+	const BYTE* pSize = GetBinaryBytes(2);
+	const UINT size = pSize[0] | (pSize[1] << 8);
+	return std::string((const char*)GetBinaryBytes(size), size);
 }
 
 UINT YamlHelper::ParseFileHdr(const char* tag)
@@ -101,6 +370,20 @@ void YamlHelper::GetNextEvent(void)
 
 int YamlHelper::GetScalar(std::string& scalar)
 {
+	if (m_bBinary)
+	{
+		// Only maps at the top-level of a binary save-state (ie. File_hdr & each Unit)
+		const BYTE chunk = GetBinaryByte();
+		if (chunk == SS_BIN_CHUNK_EOF || chunk == SS_BIN_CHUNK_MAP_END)
+			return 0;
+		if (chunk != SS_BIN_CHUNK_MAP)
+			throw std::runtime_error("Binary save-state: unexpected chunk");
+
+		scalar = m_scalarName = GetBinaryKey();
+		m_bBinaryMapPending = true;
+		return 1;
+	}
+
 	int res = 1;
 	bool bDone = false;
 
@@ -135,6 +418,14 @@ int YamlHelper::GetScalar(std::string& scalar)
 
 void YamlHelper::GetMapStartEvent(void)
 {
+	if (m_bBinary)
+	{
+		if (!m_bBinaryMapPending)
+			throw std::runtime_error("Binary save-state: unexpected chunk");
+		m_bBinaryMapPending = false;
+		return;
+	}
+
 	GetNextEvent();
 
 	if (m_newEvent.type != YAML_MAPPING_START_EVENT)
@@ -146,6 +437,9 @@ void YamlHelper::GetMapStartEvent(void)
 
 int YamlHelper::ParseMap(MapYaml& mapYaml)
 {
+	if (m_bBinary)
+		return ParseMapBinary(mapYaml);
+
 	mapYaml.clear();
 
 	const char*& pValue = (const char*&) m_newEvent.data.scalar.value;
@@ -206,6 +500,46 @@ int YamlHelper::ParseMap(MapYaml& mapYaml)
 	return res;
 }
 
+int YamlHelper::ParseMapBinary(MapYaml& mapYaml)
+{
+	mapYaml.clear();
+
+	while (true)
+	{
+		const BYTE chunk = GetBinaryByte();
+		if (chunk == SS_BIN_CHUNK_MAP_END)
+			return 1;
+		if (chunk == SS_BIN_CHUNK_EOF)
+			return 0;
+
+		MapValue& mapValue = mapYaml[GetBinaryKey()];
+		mapValue.subMap = NULL;
+
+		switch (chunk)
+		{
+		case SS_BIN_CHUNK_MAP:
+			mapValue.subMap = new MapYaml;
+			if (!ParseMapBinary(*mapValue.subMap))
+				throw std::runtime_error("ParseMap: premature end of file during map parsing");
+			break;
+		case SS_BIN_CHUNK_SCALAR:
+			{
+				const UINT size = GetBinaryUint32();
+				mapValue.value.assign((const char*)GetBinaryBytes(size), size);
+			}
+			break;
+		case SS_BIN_CHUNK_MEMORY:
+			mapValue.memory.method = GetBinaryByte();
+			mapValue.memory.rawSize = GetBinaryUint32();
+			mapValue.memory.size = GetBinaryUint32();
+			mapValue.memory.pData = GetBinaryBytes(mapValue.memory.size);
+			break;
+		default:
+			throw std::runtime_error("Binary save-state: unexpected chunk");
+		}
+	}
+}
+
 std::string YamlHelper::GetMapValue(MapYaml& mapYaml, const std::string& key, bool& bFound)
 {
 	MapYaml::const_iterator iter = mapYaml.find(key);
@@ -286,6 +620,31 @@ UINT YamlHelper::LoadMemory(MapYaml& mapYaml, const LPBYTE pMemBase, const size_
 		LPBYTE pDst = (LPBYTE) (pMemBase + addr);
 		const LPBYTE pDstEnd = (LPBYTE) (pMemBase + kAddrSpaceSize + offset);
 
+		const MapMemory& memory = it->second.memory;
+		if (memory.pData)	// binary save-state: the whole block in one chunk
+		{
+			if (memory.rawSize > (size_t)(pDstEnd - pDst))
+				throw std::runtime_error("Memory: data overflowed address space on address: " + it->first);
+
+			if (memory.method == SS_BIN_MEMORY_STORED && memory.size == memory.rawSize)
+			{
+				memcpy(pDst, memory.pData, memory.rawSize);
+			}
+			else if (memory.method == SS_BIN_MEMORY_ZLIB)
+			{
+				uLongf rawSize = memory.rawSize;
+				if (uncompress(pDst, &rawSize, memory.pData, memory.size) != Z_OK || rawSize != memory.rawSize)
+					throw std::runtime_error("Memory: failed to decompress data on address: " + it->first);
+			}
+			else
+			{
+				throw std::runtime_error("Memory: unsupported data on address: " + it->first);
+			}
+
+			bytes += memory.rawSize;
+			continue;
+		}
+
 		if (it->second.subMap)
 			throw std::runtime_error("Memory: unexpected sub-map");
 
@@ -294,7 +653,16 @@ UINT YamlHelper::LoadMemory(MapYaml& mapYaml, const LPBYTE pMemBase, const size_
 		if (len & 1)
 			throw std::runtime_error("Memory: hex data must be an even number of nibbles on line address: " + it->first);
 
-		for (UINT i = 0; i<len; i+=2)
+		const size_t lineBytes = len / 2;
+		if (lineBytes > (size_t)(pDstEnd - pDst))
+			throw std::runtime_error("Memory: hex data overflowed address space on line address: " + it->first);
+
+		const size_t decoded = HexDecodeBlocks(pValue, pDst, lineBytes);
+		pValue += 2*decoded;
+		pDst += decoded;
+		bytes += decoded;
+
+		for (size_t i = 2*decoded; i<len; i+=2)
 		{
 			if (pDst >= pDstEnd)
 				throw std::runtime_error("Memory: hex data overflowed address space on line address: " + it->first);
@@ -422,11 +790,17 @@ void YamlLoadHelper::LoadMemory(std::vector<BYTE>& memory, const size_t size, co
 
 void YamlSaveHelper::Save(const char* format, ...)
 {
-	fwrite(m_szIndent, 1, m_indent, m_hFile);
-
 	va_list vl;
 	va_start(vl, format);
-	vfprintf(m_hFile, format, vl);
+	if (m_bBinary)
+	{
+		SaveBinaryLine(StrFormatV(format, vl));
+	}
+	else
+	{
+		fwrite(m_szIndent, 1, m_indent, m_hFile);
+		vfprintf(m_hFile, format, vl);
+	}
 	va_end(vl);
 }
 
@@ -548,60 +922,77 @@ void YamlSaveHelper::SaveMemory(const LPBYTE pMemBase, const UINT uMemSize, cons
 	if (uMemSize & 7)
 		throw std::runtime_error("Memory: size must be multiple of 8");
 
+	if (m_bBinary)
+	{
+		const LPBYTE pMem = pMemBase + offset;
+
+		std::vector<BYTE> compressed;
+		if (m_bCompressMemory)
+		{
+			uLongf size = compressBound(uMemSize);
+			compressed.resize(size);
+			if (compress2(compressed.data(), &size, pMem, uMemSize, Z_BEST_SPEED) == Z_OK && size < uMemSize)
+				compressed.resize(size);
+			else
+				compressed.clear();	// incompressible, so store it
+		}
+
+		m_binary.push_back(SS_BIN_CHUNK_MEMORY);
+		PutBinaryKey(WordToHexStr(offset));	// same as the address of the first YAML line
+		if (compressed.empty())
+		{
+			m_binary.push_back(SS_BIN_MEMORY_STORED);
+			PutBinaryUint32(uMemSize);
+			PutBinaryUint32(uMemSize);
+			m_binary.insert(m_binary.end(), pMem, pMem + uMemSize);
+		}
+		else
+		{
+			m_binary.push_back(SS_BIN_MEMORY_ZLIB);
+			PutBinaryUint32(uMemSize);
+			PutBinaryUint32(compressed.size());
+			m_binary.insert(m_binary.end(), compressed.begin(), compressed.end());
+		}
+		return;
+	}
+
 	const UINT kIndent = m_indent;
 
 	const UINT kStride = 64;
-	const char szHex[] = "0123456789ABCDEF"; 
+	const UINT kEnd = uMemSize + offset;
 
-	size_t lineSize = kIndent+6+2*kStride+2;	// "AAAA: 00010203...3F\n\00" = 6+ 2*64 +2
-	char* const pLine = new char [lineSize];
+	// Format the whole block, then write it in one go
+	const UINT kNumLines = (uMemSize + kStride - 1) / kStride;
+	std::vector<char> text(kNumLines * (kIndent+6+2*kStride+1));	// "AAAA: 00010203...3F\n" = 6+ 2*64 +1
+	char* pDst = text.data();
 
-	for (uint32_t addr = offset; addr < (uMemSize + offset); addr += kStride)
+	for (uint32_t addr = offset; addr < kEnd; addr += kStride)
 	{
-		char* pDst = pLine;
-		for (UINT i=0; i<kIndent; i++)
-			*pDst++ = ' ';
-		*pDst++ = szHex[ (addr>>12)&0xf ];
-		*pDst++ = szHex[ (addr>>8)&0xf ];
-		*pDst++ = szHex[ (addr>>4)&0xf ];
-		*pDst++ = szHex[  addr&0xf ];
+		memset(pDst, ' ', kIndent);
+		pDst += kIndent;
+		*pDst++ = g_szHex[ (addr>>12)&0xf ];
+		*pDst++ = g_szHex[ (addr>>8)&0xf ];
+		*pDst++ = g_szHex[ (addr>>4)&0xf ];
+		*pDst++ = g_szHex[  addr&0xf ];
 		*pDst++ = ':';
 		*pDst++ = ' ';
 
-		LPBYTE pMem = pMemBase + addr;
-
-		for (UINT i=0; i<kStride; i+=8)
-		{
-			if (addr + i >= (uMemSize + offset))	// Support short final line (still multiple of 8 bytes)
-			{
-				lineSize = lineSize - 2*kStride + 2*i;
-				break;
-			}
-
-			BYTE d;
-			d = *pMem++; *pDst++ = szHex[d>>4]; *pDst++ = szHex[d&0xf];
-			d = *pMem++; *pDst++ = szHex[d>>4]; *pDst++ = szHex[d&0xf];
-			d = *pMem++; *pDst++ = szHex[d>>4]; *pDst++ = szHex[d&0xf];
-			d = *pMem++; *pDst++ = szHex[d>>4]; *pDst++ = szHex[d&0xf];
-
-			d = *pMem++; *pDst++ = szHex[d>>4]; *pDst++ = szHex[d&0xf];
-			d = *pMem++; *pDst++ = szHex[d>>4]; *pDst++ = szHex[d&0xf];
-			d = *pMem++; *pDst++ = szHex[d>>4]; *pDst++ = szHex[d&0xf];
-			d = *pMem++; *pDst++ = szHex[d>>4]; *pDst++ = szHex[d&0xf];
-		}
+		const UINT lineBytes = std::min(kStride, kEnd - addr);	// Support short final line (still multiple of 8 bytes)
+		HexEncode(pMemBase + addr, pDst, lineBytes);
+		pDst += 2*lineBytes;
 
 		*pDst++ = '\n';
-		*pDst = 0;	// For debugger
-
-		fwrite(pLine, 1, lineSize-1, m_hFile);	// -1 so don't write null terminator
 	}
 
-	delete [] pLine;
+	fwrite(text.data(), 1, pDst - text.data(), m_hFile);
 }
 
 void YamlSaveHelper::FileHdr(UINT version)
 {
-	fprintf(m_hFile, "%s:\n", SS_YAML_KEY_FILEHDR);
+	if (m_bBinary)
+		SaveBinaryTopLevelMap(SS_YAML_KEY_FILEHDR);
+	else
+		fprintf(m_hFile, "%s:\n", SS_YAML_KEY_FILEHDR);
 	m_indent = 2;
 	SaveString(SS_YAML_KEY_TAG, SS_YAML_VALUE_AWSS);
 	SaveInt(SS_YAML_KEY_VERSION, version);
@@ -609,8 +1000,99 @@ void YamlSaveHelper::FileHdr(UINT version)
 
 void YamlSaveHelper::UnitHdr(const std::string& type, UINT version)
 {
-	fprintf(m_hFile, "\n%s:\n", SS_YAML_KEY_UNIT);
+	if (m_bBinary)
+		SaveBinaryTopLevelMap(SS_YAML_KEY_UNIT);
+	else
+		fprintf(m_hFile, "\n%s:\n", SS_YAML_KEY_UNIT);
 	m_indent = 2;
 	SaveString(SS_YAML_KEY_TYPE, type.c_str());
 	SaveInt(SS_YAML_KEY_VERSION, version);
 }
+
+//
+
+void YamlSaveHelper::BinaryHdr(void)
+{
+	m_binary.insert(m_binary.end(), SS_BIN_MAGIC, SS_BIN_MAGIC + 4);
+	PutBinaryUint32(SS_BIN_FORMAT_VER);
+}
+
+void YamlSaveHelper::PutBinaryUint32(UINT value)
+{
+	m_binary.push_back(value & 0xff);
+	m_binary.push_back((value >> 8) & 0xff);
+	m_binary.push_back((value >> 16) & 0xff);
+	m_binary.push_back((value >> 24) & 0xff);
+}
+
+void YamlSaveHelper::PutBinaryKey(const std::string& key)
+{
+	if (key.size() > 0xffff)
+		throw std::runtime_error("Binary save-state: key too long");
+
+	m_binary.push_back(key.size() & 0xff);
+	m_binary.push_back((key.size() >> 8) & 0xff);
+	m_binary.insert(m_binary.end(), key.begin(), key.end());
+}
+
+// Convert a "key: value" line (as formatted for YAML) to a scalar chunk
+void YamlSaveHelper::SaveBinaryLine(const std::string& line)
+{
+	const size_t colon = line.find(": ");
+	if (colon == std::string::npos)
+		throw std::runtime_error("Binary save-state: expected 'key: value' but got: " + line);
+
+	std::string value = line.substr(colon + 2);
+	if (!value.empty() && value[0] == '"')
+	{
+		const size_t quote = value.rfind('"');
+		value = value.substr(1, quote - 1);			// NB. quote > 0, as SaveString() always closes the quotes
+	}
+	else
+	{
+		const size_t comment = value.find(" #");
+		if (comment != std::string::npos)
+			value.erase(comment);
+		value.erase(value.find_last_not_of(" \n") + 1);	// NB. npos+1 == 0
+	}
+
+	m_binary.push_back(SS_BIN_CHUNK_SCALAR);
+	PutBinaryKey(line.substr(0, colon));
+	PutBinaryUint32(value.size());
+	m_binary.insert(m_binary.end(), value.begin(), value.end());
+}
+
+void YamlSaveHelper::SaveBinaryLabel(const std::string& label)
+{
+	// "key:\n" starts a map, otherwise it's a scalar (eg. "State: null\n")
+	const bool isMap = label.size() >= 2 && label.compare(label.size() - 2, 2, ":\n") == 0;
+	if (isMap)
+	{
+		m_binary.push_back(SS_BIN_CHUNK_MAP);
+		PutBinaryKey(label.substr(0, label.size() - 2));
+	}
+	else
+	{
+		SaveBinaryLine(label);
+	}
+
+	m_binaryLabelIsMap.push_back(isMap);
+}
+
+void YamlSaveHelper::SaveBinaryLabelEnd(void)
+{
+	_ASSERT(!m_binaryLabelIsMap.empty());
+	if (m_binaryLabelIsMap.back())
+		m_binary.push_back(SS_BIN_CHUNK_MAP_END);
+	m_binaryLabelIsMap.pop_back();
+}
+
+void YamlSaveHelper::SaveBinaryTopLevelMap(const char* key)
+{
+	if (m_bBinaryTopLevelMap)
+		m_binary.push_back(SS_BIN_CHUNK_MAP_END);
+
+	m_binary.push_back(SS_BIN_CHUNK_MAP);
+	PutBinaryKey(key);
+	m_bBinaryTopLevelMap = true;
+}
@@ -15,13 +15,44 @@
 
 #define SS_YAML_VALUE_AWSS "AppleWin Save State"
 
+// Binary save-state (.aws.bin):
+// . Same tree of maps & scalars as the YAML save-state, but each map/scalar is a chunk (tag, key, payload)
+// . Each memory block (YamlSaveHelper::SaveMemory) is a single chunk, optionally zlib compressed
+// . All integers are little-endian
+#define SS_BIN_MAGIC "AWSB"
+#define SS_BIN_FORMAT_VER 1
+
+enum BinChunk_e
+{
+	SS_BIN_CHUNK_MAP = 'M',		// key; followed by the map's chunks and SS_BIN_CHUNK_MAP_END
+	SS_BIN_CHUNK_MAP_END = 'E',
+	SS_BIN_CHUNK_SCALAR = 'S',	// key, UINT32 length, value
+	SS_BIN_CHUNK_MEMORY = 'B',	// key (hex address), BYTE method, UINT32 raw size, UINT32 stored size, data
+	SS_BIN_CHUNK_EOF = 'Z'
+};
+
+enum BinMemoryMethod_e
+{
+	SS_BIN_MEMORY_STORED = 0,
+	SS_BIN_MEMORY_ZLIB = 1
+};
+
 struct MapValue;
 typedef std::map<std::string, MapValue> MapYaml;
 
+struct MapMemory	// binary save-state only: points into YamlHelper's file buffer
+{
+	const BYTE* pData = NULL;
+	UINT size = 0;		// stored size
+	UINT rawSize = 0;
+	BYTE method = SS_BIN_MEMORY_STORED;
+};
+
 struct MapValue
 {
 	std::string value;
 	MapYaml* subMap;
+	MapMemory memory;
 };
 
 class YamlHelper
@@ -30,7 +61,12 @@ friend class YamlLoadHelper;	// YamlLoadHelper can access YamlHelper's private m
 
 public:
 	YamlHelper(void) :
-		m_hFile(NULL)
+		m_hFile(NULL),
+		m_bBinary(false),
+		m_pBinary(NULL),
+		m_binarySize(0),
+		m_binaryPos(0),
+		m_bBinaryMapPending(false)
 	{
 		memset(&m_parser, 0, sizeof(m_parser));
 		memset(&m_newEvent, 0, sizeof(m_newEvent));
@@ -43,6 +79,7 @@ public:
 	}
 
 	int InitParser(const char* pPathname);
+	int InitParser(const BYTE* pData, const size_t size);	// YAML or binary save-state in memory (must outlive parsing)
 	void FinaliseParser(void);
 
 	UINT ParseFileHdr(const char* tag);
@@ -60,6 +97,14 @@ private:
 
 	void MakeAsciiToHexTable(void);
 
+	int InitBinaryFile(void);
+	int InitBinary(const BYTE* pData, const size_t size);
+	const BYTE* GetBinaryBytes(const size_t size);
+	BYTE GetBinaryByte(void);
+	UINT GetBinaryUint32(void);
+	std::string GetBinaryKey(void);
+	int ParseMapBinary(MapYaml& mapYaml);
+
 	yaml_parser_t m_parser;
 	yaml_event_t m_newEvent;
 
@@ -69,6 +114,13 @@ private:
 	char m_AsciiToHex[256];
 
 	MapYaml m_mapYaml;
+
+	bool m_bBinary;
+	std::vector<BYTE> m_binaryFile;	// whole file (if not parsing from memory)
+	const BYTE* m_pBinary;
+	size_t m_binarySize;
+	size_t m_binaryPos;
+	bool m_bBinaryMapPending;		// GetScalar() returned a map's key, so GetMapStartEvent() is next
 };
 
 // -----
@@ -175,15 +227,19 @@ private:
 class YamlSaveHelper
 {
 public:
-	YamlSaveHelper(const std::string & pathname) :
+	YamlSaveHelper(const std::string & pathname, const bool binary=false, const bool compressMemory=false) :
 		m_hFile(NULL),
 		m_indent(0),
 		m_pWcStr(NULL),
 		m_wcStrSize(0),
 		m_pMbStr(NULL),
-		m_mbStrSize(0)
+		m_mbStrSize(0),
+		m_bBinary(binary),
+		m_bCompressMemory(compressMemory),
+		m_bBinaryTopLevelMap(false),
+		m_pBuffer(NULL)
 	{
-		m_hFile = fopen(pathname.c_str(), "wt");
+		m_hFile = fopen(pathname.c_str(), binary ? "wb" : "wt");
 
 		// todo: handle ERROR_ALREADY_EXISTS - ask if user wants to replace existing file
 		// - at this point any old file will have been truncated to zero
@@ -191,6 +247,14 @@ public:
 		if(m_hFile == NULL)
 			throw std::runtime_error("Save error");
 
+		memset(m_szIndent, ' ', kMaxIndent);
+
+		if (m_bBinary)
+		{
+			BinaryHdr();
+			return;
+		}
+
 		_tzset();
 		time_t ltime;
 		time(&ltime);
@@ -199,20 +263,49 @@ public:
 		fprintf(m_hFile, "# Date-stamp: %s\n", err == 0 ? timebuf : "Error: Datestamp\n\n");
 
 		fprintf(m_hFile, "---\n");
+	}
 
-		//
-
+	// Binary save-state to memory (no file I/O), uncompressed. NB. buffer's capacity is reused.
+	YamlSaveHelper(std::vector<BYTE>& buffer) :
+		m_hFile(NULL),
+		m_indent(0),
+		m_pWcStr(NULL),
+		m_wcStrSize(0),
+		m_pMbStr(NULL),
+		m_mbStrSize(0),
+		m_bBinary(true),
+		m_bCompressMemory(false),
+		m_bBinaryTopLevelMap(false),
+		m_pBuffer(&buffer)
+	{
 		memset(m_szIndent, ' ', kMaxIndent);
+
+		m_binary.swap(buffer);
+		m_binary.clear();
+		BinaryHdr();
 	}
 
 	~YamlSaveHelper()
 	{
+		if (m_bBinary)
+		{
+			if (m_bBinaryTopLevelMap)
+				m_binary.push_back(SS_BIN_CHUNK_MAP_END);
+			m_binary.push_back(SS_BIN_CHUNK_EOF);
+		}
+
 		if (m_hFile)
 		{
-			fprintf(m_hFile, "...\n");
+			if (m_bBinary)
+				fwrite(m_binary.data(), 1, m_binary.size(), m_hFile);
+			else
+				fprintf(m_hFile, "...\n");
 			fclose(m_hFile);
 		}
 
+		if (m_pBuffer)
+			m_pBuffer->swap(m_binary);
+
 		delete[] m_pWcStr;
 		delete[] m_pMbStr;
 	}
@@ -241,11 +334,17 @@ public:
 		Label(YamlSaveHelper& rYamlSaveHelper, const char* format, ...)  ATTRIBUTE_FORMAT_PRINTF(3, 4) :  // 1 is "this"
 			yamlSaveHelper(rYamlSaveHelper)
 		{
-			fwrite(yamlSaveHelper.m_szIndent, 1, yamlSaveHelper.m_indent, yamlSaveHelper.m_hFile);
-
 			va_list vl;
 			va_start(vl, format);
-			vfprintf(yamlSaveHelper.m_hFile, format, vl);
+			if (yamlSaveHelper.m_bBinary)
+			{
+				yamlSaveHelper.SaveBinaryLabel(StrFormatV(format, vl));
+			}
+			else
+			{
+				fwrite(yamlSaveHelper.m_szIndent, 1, yamlSaveHelper.m_indent, yamlSaveHelper.m_hFile);
+				vfprintf(yamlSaveHelper.m_hFile, format, vl);
+			}
 			va_end(vl);
 
 			yamlSaveHelper.m_indent += 2;
@@ -254,6 +353,9 @@ public:
 
 		~Label(void)
 		{
+			if (yamlSaveHelper.m_bBinary)
+				yamlSaveHelper.SaveBinaryLabelEnd();
+
 			yamlSaveHelper.m_indent -= 2;
 			_ASSERT(yamlSaveHelper.m_indent >= 0);
 		}
@@ -278,6 +380,14 @@ public:
 	void UnitHdr(const std::string & type, UINT version);
 
 private:
+	void BinaryHdr(void);
+	void PutBinaryUint32(UINT value);
+	void PutBinaryKey(const std::string& key);
+	void SaveBinaryLine(const std::string& line);
+	void SaveBinaryLabel(const std::string& label);
+	void SaveBinaryLabelEnd(void);
+	void SaveBinaryTopLevelMap(const char* key);
+
 	FILE* m_hFile;
 
 	int m_indent;
@@ -288,4 +398,11 @@ private:
 	int m_wcStrSize;
 	LPSTR m_pMbStr;
 	int m_mbStrSize;
+
+	const bool m_bBinary;
+	const bool m_bCompressMemory;
+	std::vector<BYTE> m_binary;			// written to file (or handed to m_pBuffer) on destruction
+	std::vector<bool> m_binaryLabelIsMap;	// per open Label: false if it was a "key: value" label (eg. "State: null")
+	bool m_bBinaryTopLevelMap;			// a FileHdr() or UnitHdr() map is open
+	std::vector<BYTE>* m_pBuffer;		// memory target
 };
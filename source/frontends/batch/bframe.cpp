@@ -0,0 +1,125 @@
+#include "StdAfx.h"
+#include "frontends/batch/bframe.h"
+#include "frontends/common2/programoptions.h"
+
+#include "Core.h"
+#include "CPU.h"
+#include "Interface.h"
+#include "Log.h"
+#include "Memory.h"
+#include "NTSC.h"
+
+#include <algorithm>
+
+namespace
+{
+
+    common2::EmulatorOptions getBatchOptions(const common2::EmulatorOptions &options)
+    {
+        common2::EmulatorOptions batchOptions = options;
+        // nobody looks at the pixels: the screen is drawn only for the results
+        batchOptions.videoRaster = false;
+        return batchOptions;
+    }
+
+    char mapCharacter(BYTE ch)
+    {
+        // inverse and flashing characters are shown as normal ones
+        ch &= 0x7F;
+        if (ch < 0x20)
+        {
+            ch += 0x40;
+        }
+        return ch;
+    }
+
+} // namespace
+
+namespace ba2
+{
+
+    BFrame::BFrame(const common2::EmulatorOptions &options)
+        : common2::GNUFrame(getBatchOptions(options))
+    {
+    }
+
+    void BFrame::VideoPresentScreen()
+    {
+    }
+
+    int BFrame::FrameMessageBox(LPCSTR lpText, LPCSTR lpCaption, UINT uType)
+    {
+        LogFileOutput("MessageBox:\n%s\n%s\n\n", lpCaption, lpText);
+        return IDOK;
+    }
+
+    std::shared_ptr<SoundBuffer> BFrame::CreateSoundBuffer(
+        uint32_t dwBufferSize, uint32_t nSampleRate, int nChannels, const char *pszVoiceName)
+    {
+        return nullptr;
+    }
+
+    void BFrame::Run(const uint64_t cycles)
+    {
+        // in chunks of a video frame, to keep the cards updated as often as in the other frontends
+        const uint64_t target = g_nCumulativeCycles + cycles;
+        while (g_nCumulativeCycles < target)
+        {
+            const uint64_t chunk = std::min<uint64_t>(target - g_nCumulativeCycles, NTSC_GetCyclesPerFrame());
+            Execute(uint32_t(chunk));
+        }
+    }
+
+    bool BFrame::RunUntilPC(const uint16_t pc, const uint64_t maxCycles)
+    {
+        const uint64_t target = g_nCumulativeCycles + maxCycles;
+        do
+        {
+            if (g_nCumulativeCycles >= target)
+            {
+                return false;
+            }
+            // 0 cycles = 1 opcode
+            Execute(0);
+        } while (regs.pc != pc);
+        return true;
+    }
+
+    uint64_t BFrame::GetScreenHash()
+    {
+        VideoRedrawScreen();
+
+        // FNV-1a
+        Video &video = GetVideo();
+        const uint32_t *frameBuffer = reinterpret_cast<const uint32_t *>(video.GetFrameBuffer());
+        uint64_t hash = 14695981039346656037ULL;
+        for (UINT y = 0; y < video.GetFrameBufferBorderlessHeight(); ++y)
+        {
+            const uint32_t *row = frameBuffer + video.GetFrameBufferScanLineOffset(y);
+            for (UINT x = 0; x < video.GetFrameBufferBorderlessWidth(); ++x)
+            {
+                hash = (hash ^ row[x]) * 1099511628211ULL;
+            }
+        }
+        return hash;
+    }
+
+    std::string BFrame::GetTextLine(const int row) const
+    {
+        Video &video = GetVideo();
+        const bool page2 = video.VideoGetSWPAGE2() && !video.VideoGetSW80STORE();
+        const uint16_t address = (page2 ? 0x0800 : 0x0400) + ((row & 7) << 7) + ((row >> 3) * 40);
+
+        std::string line;
+        for (int x = 0; x < 40; ++x)
+        {
+            if (video.VideoGetSW80COL())
+            {
+                line += mapCharacter(*MemGetAuxPtr(address + x));
+            }
+            line += mapCharacter(*MemGetMainPtr(address + x));
+        }
+        return line;
+    }
+
+} // namespace ba2
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "frontends/common2/gnuframe.h"
+
+#include <cstdint>
+#include <string>
+
+namespace ba2
+{
+
+    // A frame without a window: the machine runs without raster, and the screen is only drawn on request.
+    class BFrame : public common2::GNUFrame
+    {
+    public:
+        BFrame(const common2::EmulatorOptions &options);
+
+        void VideoPresentScreen() override;
+        int FrameMessageBox(LPCSTR lpText, LPCSTR lpCaption, UINT uType) override;
+
+        std::shared_ptr<SoundBuffer> CreateSoundBuffer(
+            uint32_t dwBufferSize, uint32_t nSampleRate, int nChannels, const char *pszVoiceName) override;
+
+        // run for the given number of cycles, or until an opcode leaves the PC here (true)
+        void Run(const uint64_t cycles);
+        bool RunUntilPC(const uint16_t pc, const uint64_t maxCycles);
+
+        // redraw the whole screen and hash its visible part
+        uint64_t GetScreenHash();
+        // the text page, as displayed (40 or 80 columns)
+        std::string GetTextLine(const int row) const;
+    };
+
+} // namespace ba2
@@ -0,0 +1,310 @@
+#include "StdAfx.h"
+#include "frontends/batch/job.h"
+#include "frontends/batch/bframe.h"
+#include "frontends/common2/utils.h"
+
+#include "linux/keyboardbuffer.h"
+
+#include "CardManager.h"
+#include "CPU.h"
+#include "Disk.h"
+#include "Memory.h"
+#include "NTSC.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+
+    // a token ends at a blank, unless it is in double quotes (with \n, \t, \" and \\ escapes)
+    std::vector<std::string> splitLine(const std::string &line)
+    {
+        std::vector<std::string> tokens;
+        size_t i = 0;
+        while (i < line.size())
+        {
+            if (isspace(line[i]))
+            {
+                ++i;
+                continue;
+            }
+
+            std::string token;
+            bool quoted = false;
+            while (i < line.size() && (quoted || !isspace(line[i])))
+            {
+                const char c = line[i++];
+                if (c == '"')
+                {
+                    quoted = !quoted;
+                }
+                else if (c == '\\' && quoted && i < line.size())
+                {
+                    const char e = line[i++];
+                    token += e == 'n' ? '\n' : e == 't' ? '\t' : e;
+                }
+                else
+                {
+                    token += c;
+                }
+            }
+            if (quoted)
+            {
+                throw std::runtime_error("Unterminated quotes");
+            }
+            tokens.push_back(token);
+        }
+        return tokens;
+    }
+
+    void addOutputs(const std::string &value, std::vector<std::string> &outputs)
+    {
+        std::istringstream stream(value);
+        std::string output;
+        while (std::getline(stream, output, ','))
+        {
+            if (output != "screen" && output != "text" && output.rfind("mem:", 0) != 0)
+            {
+                throw std::runtime_error("Invalid output: " + output);
+            }
+            outputs.push_back(output);
+        }
+    }
+
+    ba2::Job parseJob(const std::vector<std::string> &tokens)
+    {
+        ba2::Job job;
+        job.name = tokens[0];
+
+        for (size_t i = 1; i < tokens.size(); ++i)
+        {
+            const std::string &token = tokens[i];
+            const size_t equal = token.find('=');
+            if (equal == std::string::npos)
+            {
+                throw std::runtime_error("Expected key=value: " + token);
+            }
+            const std::string key = token.substr(0, equal);
+            const std::string value = token.substr(equal + 1);
+
+            if (key == "disk1")
+            {
+                job.disk1 = value;
+            }
+            else if (key == "disk2")
+            {
+                job.disk2 = value;
+            }
+            else if (key == "keys")
+            {
+                job.keys = value;
+            }
+            else if (key == "paste")
+            {
+                job.paste = value;
+            }
+            else if (key == "cycles")
+            {
+                job.cycles = std::stoull(value);
+            }
+            else if (key == "pc")
+            {
+                job.pc = std::stoul(value, nullptr, 16);
+            }
+            else if (key == "text")
+            {
+                job.text = value;
+            }
+            else if (key == "out")
+            {
+                addOutputs(value, job.outputs);
+            }
+            else if (key == "bmp")
+            {
+                job.bmp = value;
+            }
+            else
+            {
+                throw std::runtime_error("Unknown key: " + key);
+            }
+        }
+
+        if (job.outputs.empty())
+        {
+            job.outputs.push_back("screen");
+        }
+        return job;
+    }
+
+    void insertDisk(const int drive, const std::string &filename)
+    {
+        CardManager &cardManager = GetCardMgr();
+        if (cardManager.QuerySlot(SLOT6) != CT_Disk2)
+        {
+            throw std::runtime_error("No Disk II card in slot 6");
+        }
+
+        // the image is shared by all the jobs
+        Disk2InterfaceCard *card2 = dynamic_cast<Disk2InterfaceCard *>(cardManager.GetObj(SLOT6));
+        const ImageError_e error = card2->InsertDisk(drive, filename, IMAGE_FORCE_WRITE_PROTECTED, IMAGE_DONT_CREATE);
+        if (error != eIMAGE_ERROR_NONE)
+        {
+            throw std::runtime_error("Cannot insert disk: " + filename);
+        }
+    }
+
+    bool isTextOnScreen(const ba2::BFrame &frame, const std::string &text)
+    {
+        for (int row = 0; row < 24; ++row)
+        {
+            if (frame.GetTextLine(row).find(text) != std::string::npos)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void dumpMemory(const std::string &prefix, const std::string &output, std::ostream &result)
+    {
+        // mem:ADDR:LEN (hex)
+        const size_t colon = output.find(':', 4);
+        if (colon == std::string::npos)
+        {
+            throw std::runtime_error("Expected mem:ADDR:LEN: " + output);
+        }
+        const uint32_t begin = std::stoul(output.substr(4, colon - 4), nullptr, 16);
+        const uint32_t end = std::min<uint32_t>(0x10000, begin + std::stoul(output.substr(colon + 1), nullptr, 16));
+
+        result << std::hex << std::uppercase << std::setfill('0');
+        for (uint32_t address = begin; address < end; address += 16)
+        {
+            result << prefix << "mem " << std::setw(4) << address << ":";
+            for (uint32_t i = address; i < std::min(end, address + 16); ++i)
+            {
+                result << " " << std::setw(2) << int(*MemGetMainPtr(i));
+            }
+            result << std::endl;
+        }
+        result << std::dec << std::nouppercase << std::setfill(' ');
+    }
+
+} // namespace
+
+namespace ba2
+{
+
+    std::vector<Job> readJobs(const std::string &filename)
+    {
+        std::ifstream file(filename);
+        if (!file)
+        {
+            throw std::runtime_error("Cannot open jobs file: " + filename);
+        }
+
+        std::vector<Job> jobs;
+        std::string line;
+        size_t lineNumber = 0;
+        while (std::getline(file, line))
+        {
+            ++lineNumber;
+            const size_t first = line.find_first_not_of(" \t");
+            if (first == std::string::npos || line[first] == '#')
+            {
+                continue;
+            }
+
+            try
+            {
+                jobs.push_back(parseJob(splitLine(line)));
+            }
+            catch (const std::exception &e)
+            {
+                throw std::runtime_error(filename + ":" + std::to_string(lineNumber) + ": " + e.what());
+            }
+        }
+        return jobs;
+    }
+
+    std::string runJob(BFrame &frame, const Job &job)
+    {
+        const std::string prefix = "[" + job.name + "] ";
+
+        if (!job.disk1.empty())
+        {
+            insertDisk(DRIVE_1, job.disk1);
+        }
+        if (!job.disk2.empty())
+        {
+            insertDisk(DRIVE_2, job.disk2);
+        }
+        addTextToBuffer(job.keys.c_str());
+        if (!job.paste.empty() && !common2::pasteFile(job.paste))
+        {
+            throw std::runtime_error("Cannot read paste file: " + job.paste);
+        }
+
+        // the stop conditions are checked at every opcode (pc) or every video frame (text)
+        const uint64_t start = g_nCumulativeCycles;
+        const uint64_t target = start + job.cycles;
+        std::string stop = "cycles";
+        while (g_nCumulativeCycles < target)
+        {
+            const uint64_t cycles = std::min<uint64_t>(target - g_nCumulativeCycles, NTSC_GetCyclesPerFrame());
+            if (job.pc)
+            {
+                if (frame.RunUntilPC(*job.pc, cycles))
+                {
+                    stop = "pc";
+                    break;
+                }
+            }
+            else
+            {
+                frame.Run(cycles);
+            }
+
+            if (!job.text.empty() && isTextOnScreen(frame, job.text))
+            {
+                stop = "text";
+                break;
+            }
+        }
+
+        std::ostringstream result;
+        result << prefix << "stop=" << stop << " cycles=" << (g_nCumulativeCycles - start) << " pc=" << std::hex
+               << std::uppercase << std::setw(4) << std::setfill('0') << regs.pc << std::dec << std::nouppercase
+               << std::setfill(' ') << std::endl;
+
+        for (const std::string &output : job.outputs)
+        {
+            if (output == "screen")
+            {
+                result << prefix << "screen=" << std::hex << std::setw(16) << std::setfill('0') << frame.GetScreenHash()
+                       << std::dec << std::setfill(' ') << std::endl;
+            }
+            else if (output == "text")
+            {
+                for (int row = 0; row < 24; ++row)
+                {
+                    result << prefix << "text |" << frame.GetTextLine(row) << "|" << std::endl;
+                }
+            }
+            else
+            {
+                dumpMemory(prefix, output, result);
+            }
+        }
+
+        if (!job.bmp.empty())
+        {
+            frame.Video_RedrawAndTakeScreenShot(job.bmp.c_str());
+        }
+
+        return result.str();
+    }
+
+} // namespace ba2
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ba2
+{
+
+    class BFrame;
+
+    // One line of the jobs file:
+    //   name key=value key="quoted value" ...
+    // Keys: disk1, disk2, keys, paste, cycles, pc, text, out, bmp (see README.md).
+    struct Job
+    {
+        std::string name;
+
+        std::string disk1;
+        std::string disk2;
+        std::string keys;  // typed in, "\n" is Return
+        std::string paste; // text file typed in as the Apple reads it (after keys)
+
+        uint64_t cycles = 1020484;  // stop after (about 1 second)
+        std::optional<uint16_t> pc; // or when the PC gets here
+        std::string text;           // or when this appears on the text screen
+
+        std::vector<std::string> outputs; // screen, text, mem:ADDR:LEN
+        std::string bmp;                  // save a screenshot here
+    };
+
+    std::vector<Job> readJobs(const std::string &filename);
+
+    // run a job on the current machine, the result is a few lines, each starting with the job name
+    std::string runJob(BFrame &frame, const Job &job);
+
+} // namespace ba2
@@ -0,0 +1,229 @@
+#include "StdAfx.h"
+
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Core.h"
+#include "CardManager.h"
+#include "CPU.h"
+#include "Disk.h"
+#include "Harddisk.h"
+#include "Memory.h"
+
+#include "linux/context.h"
+#include "frontends/common2/fileregistry.h"
+#include "frontends/common2/programoptions.h"
+#include "frontends/common2/argparser.h"
+#include "frontends/common2/commoncontext.h"
+#include "frontends/batch/bframe.h"
+#include "frontends/batch/job.h"
+
+namespace
+{
+
+    void warmUp(const common2::EmulatorOptions &options, ba2::BFrame &frame)
+    {
+        if (options.warmupPC)
+        {
+            // without --warmup-cycles there is no limit
+            const uint64_t maxCycles = options.warmupCycles ? options.warmupCycles : UINT64_MAX;
+            if (!frame.RunUntilPC(*options.warmupPC, maxCycles))
+            {
+                throw std::runtime_error("Warm-up did not reach the PC");
+            }
+        }
+        else
+        {
+            frame.Run(options.warmupCycles);
+        }
+        std::cerr << "Warm-up: " << g_nCumulativeCycles << " cycles" << std::endl;
+    }
+
+    // the warm-up disk images: the workers must not share the file offsets, nor write to the images
+    void detachDisks()
+    {
+        CardManager &cardManager = GetCardMgr();
+        for (UINT slot = SLOT0; slot < NUM_SLOTS; ++slot)
+        {
+            bool ok = true;
+            switch (cardManager.QuerySlot(slot))
+            {
+            case CT_Disk2:
+                ok = dynamic_cast<Disk2InterfaceCard *>(cardManager.GetObj(slot))->DetachImages();
+                break;
+            case CT_GenericHDD:
+                ok = dynamic_cast<HarddiskInterfaceCard *>(cardManager.GetObj(slot))->DetachImages();
+                break;
+            default:
+                break;
+            }
+            if (!ok)
+            {
+                throw std::runtime_error("Cannot reopen the disk images");
+            }
+        }
+    }
+
+    std::string readResult(FILE *file)
+    {
+        std::string result;
+        rewind(file);
+        char buffer[4096];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            result.append(buffer, n);
+        }
+        fclose(file);
+        return result;
+    }
+
+    // each job runs in its own process, forked from the warmed-up machine: jobs do not see each other
+    // (the disk writes of a job stay in its process)
+    // the results are printed in the order of the jobs file
+    bool runJobs(const std::vector<ba2::Job> &jobs, const size_t maxWorkers, ba2::BFrame &frame)
+    {
+        std::vector<std::string> results(jobs.size());
+        std::vector<bool> done(jobs.size(), false);
+        std::map<pid_t, std::pair<size_t, FILE *>> workers;
+
+        bool ok = true;
+        size_t next = 0;
+        size_t printed = 0;
+
+        while (printed < jobs.size())
+        {
+            while (next < jobs.size() && workers.size() < maxWorkers)
+            {
+                FILE *file = tmpfile();
+                if (!file)
+                {
+                    throw std::runtime_error("Cannot create a temporary file");
+                }
+
+                std::cout.flush();
+                std::cerr.flush();
+                fflush(nullptr); // or the workers would write the parent's buffered data again
+                const pid_t pid = fork();
+                if (pid < 0)
+                {
+                    throw std::runtime_error("Cannot fork");
+                }
+
+                if (pid == 0)
+                {
+                    // the worker: skip all destructors (they would save the registry)
+                    int status = 0;
+                    std::string result;
+                    try
+                    {
+                        // the Apple memory is a shared mapping: without this, the workers would write into each other
+                        if (!MemUnshareImage())
+                        {
+                            throw std::runtime_error("Cannot copy the Apple memory");
+                        }
+                        // each job sees the disks as they were after the warm-up
+                        detachDisks();
+                        result = ba2::runJob(frame, jobs[next]);
+                    }
+                    catch (const std::exception &e)
+                    {
+                        result = "[" + jobs[next].name + "] error=" + e.what() + "\n";
+                        status = 1;
+                    }
+                    fwrite(result.data(), 1, result.size(), file);
+                    fflush(file);
+                    _exit(status);
+                }
+
+                workers[pid] = std::make_pair(next, file);
+                ++next;
+            }
+
+            int status;
+            const pid_t pid = wait(&status);
+            const auto it = workers.find(pid);
+            if (it == workers.end())
+            {
+                throw std::runtime_error("Lost a worker");
+            }
+
+            const size_t index = it->second.first;
+            results[index] = readResult(it->second.second);
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            {
+                if (results[index].empty())
+                {
+                    results[index] = "[" + jobs[index].name + "] error=worker failed\n";
+                }
+                ok = false;
+            }
+            done[index] = true;
+            workers.erase(it);
+
+            while (printed < jobs.size() && done[printed])
+            {
+                std::cout << results[printed];
+                results[printed].clear();
+                ++printed;
+            }
+        }
+        std::cout.flush();
+
+        return ok;
+    }
+
+    int run_batch(int argc, char *const argv[])
+    {
+        common2::EmulatorOptions options;
+        options.noAudio = true;
+        const bool run = getEmulatorOptions(argc, argv, common2::OptionsType::applebatch, "batch", options);
+
+        if (!run)
+            return 1;
+
+        if (options.batchJobs.empty())
+        {
+            std::cerr << "A jobs file is needed: --jobs" << std::endl;
+            return 1;
+        }
+
+        // the workers are forked: there must be no other threads
+        options.mockingboardAudioThread = false;
+        options.diskLibrary.clear();
+
+        const std::vector<ba2::Job> jobs = ba2::readJobs(options.batchJobs);
+        const size_t workers =
+            options.batchWorkers ? options.batchWorkers : std::max(1u, std::thread::hardware_concurrency());
+
+        const LoggerContext loggerContext(options.log);
+        const RegistryContext registryContext(CreateFileRegistry(options));
+        const std::shared_ptr<ba2::BFrame> frame = std::make_shared<ba2::BFrame>(options);
+
+        const common2::CommonInitialisation init(frame, std::shared_ptr<Paddle>(), options);
+
+        warmUp(options, *frame);
+
+        const bool ok = runJobs(jobs, workers, *frame);
+        return ok ? 0 : 2;
+    }
+
+} // namespace
+
+int main(int argc, char *const argv[])
+{
+    try
+    {
+        return run_batch(argc, argv);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
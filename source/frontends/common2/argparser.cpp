@@ -45,6 +45,28 @@ namespace
     constexpr int NO_VIDEO_UPDATE = 1024;
     constexpr int EV_DEVICE_NAME = 1025;
 
+    constexpr int DISK_LIBRARY = 1026;
+
+    constexpr int CONVERT_STATE = 1027;
+    constexpr int REWIND = 1028;
+
+    constexpr int MB_AUDIO_THREAD = 1029;
+    constexpr int AUDIO_LATENCY = 1030;
+
+    constexpr int EMULATION_THREAD = 1031;
+    constexpr int FULL_SPEED_VIDEO = 1032;
+
+    constexpr int BATCH_JOBS = 1033;
+    constexpr int BATCH_WORKERS = 1034;
+    constexpr int WARMUP_CYCLES = 1035;
+    constexpr int WARMUP_PC = 1036;
+
+    constexpr int RECORD_INPUT = 1037;
+    constexpr int REPLAY_INPUT = 1038;
+    constexpr int SEED = 1039;
+    constexpr int PASTE = 1040;
+    constexpr int PERF_COUNTERS = 1041;
+
     struct OptionData_t
     {
         const char *name;
@@ -150,7 +172,11 @@ namespace common2
 
         const std::string configurationFileDefault = options.configurationFile.string();
         const std::string audioBufferDefault = std::to_string(options.audioBuffer);
+        const std::string audioLatencyDefault = std::to_string(options.audioLatency);
         const std::string glSwapIntervalDefault = std::to_string(options.glSwapInterval);
+        const std::string rewindDefault = std::to_string(options.rewindBuffer);
+        const std::string fullSpeedVideoDefault = std::to_string(options.fullSpeedVideoBudget);
+        const std::string batchWorkersDefault = std::to_string(options.batchWorkers);
 
         // clang-format off
 
@@ -172,8 +198,10 @@ namespace common2
                  {"fixed-speed",             no_argument,          FIXED_SPEED,      "Fixed (non-adaptive) speed"},
                  {"headless",                no_argument,          HEADLESS,         "Headless: disable video (freewheel)"},
                  {"benchmark",               no_argument,          'b',              "Benchmark emulator"},
+                 {"perf-counters",           no_argument,          PERF_COUNTERS,    "Measure the time spent in each subsystem"},
                  {"no-squaring",             no_argument,          NO_SQUARING,      "Gamepad range is (already) a square"},
                  {"nat",                     required_argument,    SLIRP_NAT,        "SLIRP PortFwd (e.g. 0,tcp,,8080,,http)"},
+                 {"paste",                   required_argument,    PASTE,            "Type the text file at full speed (e.g. a BASIC listing)"},
              }},
             {"Disk",
              {
@@ -181,11 +209,20 @@ namespace common2
                  {"d2",                      required_argument,    '2',              "Disk in S6D2 drive"},
                  {"h1",                      required_argument,    DISK_H1,          "Hard Disk in 1st drive"},
                  {"h2",                      required_argument,    DISK_H2,          "Hard Disk in 1st drive"},
+                 {"disk-library",            required_argument,    DISK_LIBRARY,     "Index disk images in folder (repeatable)"},
              }},
             {"Snapshot",
              {
                  {"state-filename",          required_argument,    'f',              "Set snapshot filename"},
                  {"load-state",              required_argument,    's',              "Load snapshot from file"},
+                 {"convert-state",           required_argument,    CONVERT_STATE,    "Save loaded snapshot to file and quit (.aws.bin = binary)"},
+                 {"rewind",                  required_argument,    REWIND,           "Rewind history (MB, 0 = off)", rewindDefault.c_str()},
+             }},
+            {"Input recording",
+             {
+                 {"record",                  required_argument,    RECORD_INPUT,     "Record the input (cycle stamped) to file"},
+                 {"replay",                  required_argument,    REPLAY_INPUT,     "Replay the input from file"},
+                 {"seed",                    required_argument,    SEED,             "Fixed seed for rand() and memory init (reproducible runs)"},
              }},
             {"Memory",
              {
@@ -197,8 +234,10 @@ namespace common2
              {
                  {"no-audio",                no_argument,          NO_AUDIO,         "Disable audio"},
                  {"audio-buffer",            required_argument,    AUDIO_BUFFER,     "Audio buffer (ms)", audioBufferDefault.c_str()},
+                 {"audio-latency",           required_argument,    AUDIO_LATENCY,    "Target audio latency (ms, 0 = auto)", audioLatencyDefault.c_str()},
                  {"wav-speaker",             required_argument,    WAV_SPEAKER,      "Speaker wav output filename"},
                  {"wav-mockingboard",        required_argument,    WAV_MOCKINGBOARD, "Mockingboard wav output filename"},
+                 {"mb-audio-thread",         no_argument,          MB_AUDIO_THREAD,  "Synthesize Mockingboard audio on a separate thread"},
              }},
         };
 
@@ -214,13 +253,25 @@ namespace common2
                  {"game-controller",         required_argument,    GAME_CONTROLLER,  "SDL_GameControllerOpen"},
                  {"game-mapping-file",       required_argument,    MAPPING_FILE,     "SDL_GameControllerAddMappingsFromFile"},
                  {"audio-device",            required_argument,    AUDIO_DEVICE,     "Audio device name"},
+                 {"emulation-thread",        no_argument,          EMULATION_THREAD, "Run the emulator on its own thread"},
+                 {"full-speed-video",        required_argument,    FULL_SPEED_VIDEO, "Max time redrawing at full speed (%, 0 = none)", fullSpeedVideoDefault.c_str()},
+             }},
+        };
+
+        const std::vector<std::pair<std::string, std::vector<OptionData_t>>> applebatchOptions = {
+            {"applebatch",
+             {
+                 {"jobs",                    required_argument,    BATCH_JOBS,       "Jobs file (one job per line)"},
+                 {"workers",                 required_argument,    BATCH_WORKERS,    "Worker processes (0 = one per core)", batchWorkersDefault.c_str()},
+                 {"warmup-cycles",           required_argument,    WARMUP_CYCLES,    "Cycles to run before forking the workers"},
+                 {"warmup-pc",               required_argument,    WARMUP_PC,        "Run until PC (hex) before forking the workers"},
              }},
         };
 
         const std::vector<std::pair<std::string, std::vector<OptionData_t>>> applenOptions = {
             {"applen",
              {
-                 {"no-video-update",         no_argument,          NO_VIDEO_UPDATE,  "Do not execute NTSC code"},
+                 {"no-video-update",         no_argument,          NO_VIDEO_UPDATE,  "Deprecated, no effect: the video is never rastered"},
                  {"ev-device-name",          required_argument,    EV_DEVICE_NAME,   "Gamepad ev-device name"},
              }},
         };
@@ -235,6 +286,10 @@ namespace common2
         {
             allOptions.insert(allOptions.end(), applenOptions.begin(), applenOptions.end());
         }
+        else if (type == OptionsType::applebatch)
+        {
+            allOptions.insert(allOptions.end(), applebatchOptions.begin(), applebatchOptions.end());
+        }
 
         std::vector<option> longOptions;
         std::string shortOptions;
@@ -350,6 +405,22 @@ namespace common2
                 options.hardDisk2 = optarg;
                 break;
             }
+            case DISK_LIBRARY:
+            {
+                options.diskLibrary.emplace_back(optarg);
+                break;
+            }
+            case CONVERT_STATE:
+            {
+                // loading the snapshot changes the current directory
+                options.convertSnapshotFilename = std::filesystem::absolute(optarg).string();
+                break;
+            }
+            case REWIND:
+            {
+                options.rewindBuffer = std::stoul(optarg);
+                break;
+            }
             case MEM_CLEAR:
             {
                 const int memclear = std::stoi(optarg);
@@ -379,6 +450,11 @@ namespace common2
                 options.audioBuffer = std::stoul(optarg);
                 break;
             }
+            case AUDIO_LATENCY:
+            {
+                options.audioLatency = std::stoul(optarg);
+                break;
+            }
             case WAV_SPEAKER:
             {
                 options.wavFileSpeaker = optarg;
@@ -389,6 +465,66 @@ namespace common2
                 options.wavFileMockingboard = optarg;
                 break;
             }
+            case MB_AUDIO_THREAD:
+            {
+                options.mockingboardAudioThread = true;
+                break;
+            }
+            case EMULATION_THREAD:
+            {
+                options.emulationThread = true;
+                break;
+            }
+            case FULL_SPEED_VIDEO:
+            {
+                options.fullSpeedVideoBudget = std::stoul(optarg);
+                break;
+            }
+            case BATCH_JOBS:
+            {
+                options.batchJobs = optarg;
+                break;
+            }
+            case BATCH_WORKERS:
+            {
+                options.batchWorkers = std::stoul(optarg);
+                break;
+            }
+            case WARMUP_CYCLES:
+            {
+                options.warmupCycles = std::stoull(optarg);
+                break;
+            }
+            case WARMUP_PC:
+            {
+                options.warmupPC = std::stoul(optarg, nullptr, 16);
+                break;
+            }
+            case RECORD_INPUT:
+            {
+                options.recordInput = optarg;
+                break;
+            }
+            case REPLAY_INPUT:
+            {
+                options.replayInput = optarg;
+                break;
+            }
+            case SEED:
+            {
+                options.seed = std::stoul(optarg);
+                break;
+            }
+            case PASTE:
+            {
+                options.pasteFile = optarg;
+                break;
+            }
+            case PERF_COUNTERS:
+            {
+                options.perfCounters = true;
+                break;
+            }
             case SDL_DRIVER:
             {
                 options.sdlDriver = std::stoi(optarg);
@@ -436,7 +572,8 @@ namespace common2
             }
             case NO_VIDEO_UPDATE:
             {
-                options.noVideoUpdate = true;
+                // kept for existing scripts: applen always runs without raster (see videoRaster)
+                options.videoRaster = false;
                 break;
             }
             case EV_DEVICE_NAME:
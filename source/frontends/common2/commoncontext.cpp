@@ -3,6 +3,11 @@
 #include "frontends/common2/programoptions.h"
 #include "frontends/common2/utils.h"
 #include "linux/linuxframe.h"
+#include "linux/inputrecorder.h"
+
+#include "PerfCounters.h"
+
+#include <random>
 
 namespace common2
 {
@@ -12,15 +17,46 @@ namespace common2
         : Initialisation(frame, paddle)
     {
         applyOptions(options);
+
+        // the seed must be set before the machine is initialised (random memory pattern)
+        InputRecorder &recorder = InputRecorder::instance();
+        std::optional<uint32_t> seed = options.seed;
+        if (!options.replayInput.empty())
+        {
+            seed = recorder.startReplay(options.replayInput);
+        }
+        else if (!options.recordInput.empty() && !seed)
+        {
+            seed = std::random_device()();
+        }
+        if (seed)
+        {
+            InputRecorder::setFixedSeed(*seed);
+        }
+
+        PerfCounters_Enable(options.perfCounters);
+
         myFrame->Begin();
         setSnapshotFilename(options.snapshotFilename);
         if (options.loadSnapshot)
         {
             myFrame->LoadSnapshot();
         }
+
+        if (options.replayInput.empty() && !options.recordInput.empty())
+        {
+            recorder.startRecording(options.recordInput, *seed);
+        }
+
+        // after the recording starts, so the paste is part of it
+        if (!options.pasteFile.empty() && !pasteFile(options.pasteFile))
+        {
+            throw std::runtime_error("Cannot read paste file: " + options.pasteFile);
+        }
     }
     CommonInitialisation::~CommonInitialisation()
     {
+        InputRecorder::instance().stop();
         myFrame->End();
     }
 
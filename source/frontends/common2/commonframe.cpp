@@ -1,6 +1,9 @@
 #include "StdAfx.h"
 #include "frontends/common2/commonframe.h"
 #include "frontends/common2/programoptions.h"
+#include "frontends/common2/rewind.h"
+#include "linux/inputrecorder.h"
+#include "linux/keyboardbuffer.h"
 
 #include <thread>
 
@@ -21,15 +24,20 @@ namespace common2
     CommonFrame::CommonFrame(const EmulatorOptions &options)
         : LinuxFrame(options.autoBoot)
         , mySpeed(options.fixedSpeed)
+        , myFullSpeedVideo(options.fullSpeedVideoBudget)
         , mySynchroniseWithTimer(options.syncWithTimer)
-        , myAllowVideoUpdate(!options.noVideoUpdate)
+        , myVideoRaster(options.videoRaster && !options.headless)
+        , myRewindBuffer(0)
+        , myRewinding(false)
     {
         myLastSync = std::chrono::steady_clock::now();
+        SetRewindBuffer(options.rewindBuffer);
     }
 
     void CommonFrame::Begin()
     {
         LinuxFrame::Begin();
+        NTSC_SetVideoRaster(myVideoRaster);
         ResetSpeed();
         ResetHardware();
     }
@@ -47,7 +55,7 @@ namespace common2
             {
                 // entering full speed
                 GetCardMgr().GetMockingboardCardMgr().MuteControl(true);
-                VideoRedrawScreenDuringFullSpeed(0, true);
+                myFullSpeedVideo.reset();
             }
             else
             {
@@ -65,7 +73,7 @@ namespace common2
         return (g_dwSpeed == SPEED_MAX) ||
                (GetCardMgr().GetDisk2CardMgr().IsConditionForFullSpeed() && !Spkr_IsActive() &&
                 !GetCardMgr().GetMockingboardCardMgr().IsActiveToPreventFullSpeed()) ||
-               IsDebugSteppingAtFullSpeed();
+               IsDebugSteppingAtFullSpeed() || isPasting();
     }
 
     void CommonFrame::ExecuteOneFrame(const int64_t microseconds)
@@ -76,7 +84,18 @@ namespace common2
         {
         case MODE_RUNNING:
         {
-            ExecuteInRunningMode(microseconds);
+            if (myRewinding && myRewind)
+            {
+                StepBack();
+            }
+            else
+            {
+                ExecuteInRunningMode(microseconds);
+                if (myRewind)
+                {
+                    myRewind->frame();
+                }
+            }
             break;
         }
         case MODE_STEPPING:
@@ -111,18 +130,28 @@ namespace common2
 
     void CommonFrame::Execute(const uint32_t cyclesToExecute)
     {
-        const bool bVideoUpdate = myAllowVideoUpdate && !g_bFullSpeed;
+        // without raster the video scanner still runs: VBL and the floating bus do not depend on the pixels
+        const bool bVideoUpdate = !g_bFullSpeed;
         const UINT dwClksPerFrame = NTSC_GetCyclesPerFrame();
 
         // do it in the same batches as AppleWin (1 ms)
         const uint32_t fExecutionPeriodClks = g_fCurrentCLK6502 * (1.0 / 1000.0); // 1 ms
 
+        InputRecorder &recorder = InputRecorder::instance();
+
         uint32_t totalCyclesExecuted = 0;
         // check at the end because we want to always execute at least 1 cycle even for "0"
         do
         {
             _ASSERT(cyclesToExecute >= totalCyclesExecuted);
-            const uint32_t thisCyclesToExecute = std::min(fExecutionPeriodClks, cyclesToExecute - totalCyclesExecuted);
+            uint32_t thisCyclesToExecute = std::min(fExecutionPeriodClks, cyclesToExecute - totalCyclesExecuted);
+            if (recorder.isReplaying())
+            {
+                // stop exactly where the next event was recorded
+                recorder.update();
+                const uint64_t untilNextEvent = recorder.getNextCycle() - g_nCumulativeCycles;
+                thisCyclesToExecute = std::min<uint64_t>(thisCyclesToExecute, untilNextEvent);
+            }
             const uint32_t executedCycles = CpuExecute(thisCyclesToExecute, bVideoUpdate);
             totalCyclesExecuted += executedCycles;
 
@@ -188,6 +217,45 @@ namespace common2
         ResetHardware();
     }
 
+    void CommonFrame::SetRewindBuffer(const size_t megabytes)
+    {
+        if (megabytes != myRewindBuffer)
+        {
+            myRewindBuffer = megabytes;
+            if (megabytes)
+            {
+                myRewind = std::make_shared<Rewind>(
+                    Rewind::ourDefaultInterval, Rewind::ourDefaultKeyframe, megabytes * 1024 * 1024);
+            }
+            else
+            {
+                myRewind.reset();
+            }
+        }
+    }
+
+    const std::shared_ptr<Rewind> &CommonFrame::GetRewind() const
+    {
+        return myRewind;
+    }
+
+    void CommonFrame::SetRewinding(const bool value)
+    {
+        myRewinding = value;
+    }
+
+    void CommonFrame::StepBack()
+    {
+        if (myRewind->rewind())
+        {
+            ResetSpeed();
+            ResetHardware();
+            // nothing has run yet, so draw the restored screen
+            Video &video = GetVideo();
+            video.VideoRefreshBuffer(video.GetVideoMode(), true);
+        }
+    }
+
     void CommonFrame::SyncVideoPresentScreen(const int64_t microseconds)
     {
         if (mySynchroniseWithTimer)
@@ -200,6 +268,21 @@ namespace common2
         VideoPresentScreen();
     }
 
+    void CommonFrame::RedrawScreenDuringFullSpeed()
+    {
+        if (myFullSpeedVideo.isRedrawDue())
+        {
+            const auto start = std::chrono::steady_clock::now();
+            VideoRedrawScreenAfterFullSpeed(g_dwCyclesThisFrame);
+            myFullSpeedVideo.redrawn(start);
+        }
+        else if (myFullSpeedVideo.isPresentDue())
+        {
+            // only the NTSC redraw is skipped: the last frame (and the UI over it) is still presented
+            VideoPresentScreen();
+        }
+    }
+
 } // namespace common2
 
 void SingleStep(bool /* bReinit */)
@@ -6,10 +6,14 @@
 #include "Configuration/Config.h"
 
 #include "frontends/common2/speed.h"
+#include "frontends/common2/fullspeedvideo.h"
+
+#include <memory>
 
 namespace common2
 {
     struct EmulatorOptions;
+    class Rewind;
 
     class CommonFrame : public LinuxFrame
     {
@@ -26,6 +30,10 @@ namespace common2
         // it acts as a syncronisation point (sa2 (in qemu) and applen)
         void SyncVideoPresentScreen(const int64_t microseconds);
 
+        // at full speed, in place of SyncVideoPresentScreen(): redraws the screen if it changed and the budget allows,
+        // otherwise presents the last frame at the host refresh rate
+        void RedrawScreenDuringFullSpeed();
+
         void ChangeMode(const AppMode_e mode);
         void TogglePaused();
         void SingleStep();
@@ -35,6 +43,12 @@ namespace common2
 
         void LoadSnapshot() override;
 
+        // rewind history, 0 = disabled (resizing it discards the history)
+        void SetRewindBuffer(const size_t megabytes);
+        const std::shared_ptr<Rewind> &GetRewind() const;
+        // while set, each frame steps back in the history instead of running
+        void SetRewinding(const bool value);
+
     protected:
         virtual void SetFullSpeed(const bool value);
         virtual bool CanDoFullSpeed();
@@ -44,14 +58,21 @@ namespace common2
         void Execute(const uint32_t uCycles);
 
         Speed mySpeed;
+        FullSpeedVideo myFullSpeedVideo;
 
         // used to synchronise if OpenGL cannot do it (or without it)
         bool mySynchroniseWithTimer;
         std::chrono::time_point<std::chrono::steady_clock> myLastSync;
 
     private:
-        const bool myAllowVideoUpdate;
+        void StepBack();
+
+        const bool myVideoRaster;
         CConfigNeedingRestart myHardwareConfig;
+
+        size_t myRewindBuffer;
+        std::shared_ptr<Rewind> myRewind;
+        bool myRewinding;
     };
 
 } // namespace common2
@@ -0,0 +1,596 @@
+#include "StdAfx.h"
+#include "frontends/common2/disklibrary.h"
+
+#include "Disk.h"
+#include "DiskImage.h"
+#include "DiskImageHelper.h"
+#include "Log.h"
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+
+    const int CACHE_VERSION = 1;
+
+    const char *getImageTypeName(const eImageType type)
+    {
+        switch (type)
+        {
+        case eImageDO:
+            return "DO";
+        case eImagePO:
+            return "PO";
+        case eImageNIB1:
+            return "NIB";
+        case eImageNIB2:
+            return "NB2";
+        case eImageHDV:
+            return "HDV";
+        case eImageIIE:
+            return "IIE";
+        case eImageAPL:
+            return "APL";
+        case eImagePRG:
+            return "PRG";
+        case eImageWOZ1:
+            return "WOZ1";
+        case eImageWOZ2:
+            return "WOZ2";
+        default:
+            return "";
+        }
+    }
+
+    std::string toHex(const uint64_t value)
+    {
+        std::ostringstream hex;
+        hex << std::hex << std::setw(16) << std::setfill('0') << value;
+        return hex.str();
+    }
+
+    // FNV-1a
+    bool hashFile(const std::filesystem::path &path, uint64_t &hash)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+
+        hash = 0xcbf29ce484222325ULL;
+        std::vector<char> buffer(64 * 1024);
+        while (file)
+        {
+            file.read(buffer.data(), buffer.size());
+            const std::streamsize count = file.gcount();
+            for (std::streamsize i = 0; i < count; ++i)
+            {
+                hash ^= static_cast<uint8_t>(buffer[i]);
+                hash *= 0x100000001b3ULL;
+            }
+        }
+        return true;
+    }
+
+    bool getFileStatus(const std::filesystem::path &path, uint64_t &size, int64_t &mtime)
+    {
+        std::error_code ec;
+        size = std::filesystem::file_size(path, ec);
+        if (ec)
+        {
+            return false;
+        }
+        mtime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        return !ec;
+    }
+
+    // ProDOS volume directory key block: storage type $F + name length, then the name
+    std::string getProDOSVolumeName(const BYTE *block)
+    {
+        const BYTE storageType = block[4] >> 4;
+        const BYTE length = block[4] & 0x0F;
+        if (storageType != 0xF || length == 0)
+        {
+            return std::string();
+        }
+
+        std::string name = "/";
+        for (BYTE i = 0; i < length; ++i)
+        {
+            const char c = block[5 + i];
+            if (!(isupper(c) || isdigit(c) || c == '.'))
+            {
+                return std::string();
+            }
+            name += c;
+        }
+        return name;
+    }
+
+    // DOS 3.3 VTOC: check a few fields which never change
+    int getDOSVolume(const BYTE *vtoc)
+    {
+        const bool isVTOC = vtoc[0x27] == 0x7A && (vtoc[0x35] == 13 || vtoc[0x35] == 16) && vtoc[0x36] == 0x00 &&
+                            vtoc[0x37] == 0x01 && vtoc[0x01] > 0 && vtoc[0x01] < TRACKS_MAX;
+        return isVTOC ? vtoc[0x06] : -1;
+    }
+
+    void readVolumeInfo(ImageInfo &info, common2::DiskLibraryEntry &entry)
+    {
+        const UINT TRACK_SIZE = TRACK_DENIBBLIZED_SIZE;
+        const UINT SECTOR_SIZE = 256;
+
+        if (entry.floppy)
+        {
+            const eImageType type = info.pImageType->GetType();
+            if ((type != eImageDO && type != eImagePO) || !info.pImageBuffer ||
+                info.uImageSize < info.uOffset + TRACK_SIZE * 18)
+            {
+                return;
+            }
+
+            const BYTE *image = info.pImageBuffer + info.uOffset;
+
+            // DOS T$11 S0 is at the same offset in both orders
+            entry.dosVolume = getDOSVolume(image + 0x11 * TRACK_SIZE);
+
+            // ProDOS block 2 = T0 DOS sectors B & A
+            BYTE block[HD_BLOCK_SIZE];
+            if (type == eImagePO)
+            {
+                memcpy(block, image + 2 * HD_BLOCK_SIZE, HD_BLOCK_SIZE);
+            }
+            else
+            {
+                memcpy(block, image + 0xB * SECTOR_SIZE, SECTOR_SIZE);
+                memcpy(block + SECTOR_SIZE, image + 0xA * SECTOR_SIZE, SECTOR_SIZE);
+            }
+            entry.volumeName = getProDOSVolumeName(block);
+        }
+        else
+        {
+            BYTE block[HD_BLOCK_SIZE];
+            if (info.pImageType->Read(&info, 2, block))
+            {
+                entry.volumeName = getProDOSVolumeName(block);
+            }
+        }
+    }
+
+    std::string getWOZCreator(const ImageInfo &info)
+    {
+        // the INFO chunk must be the 1st chunk: 12 bytes header + 8 bytes chunk header
+        const UINT INFO_OFFSET = 12 + 8;
+        const UINT CREATOR_OFFSET = INFO_OFFSET + 5;
+        const UINT CREATOR_SIZE = 32;
+        if (!info.pImageBuffer || info.uImageSize < CREATOR_OFFSET + CREATOR_SIZE ||
+            memcmp(info.pImageBuffer + 12, "INFO", 4) != 0)
+        {
+            return std::string();
+        }
+
+        std::string creator(reinterpret_cast<const char *>(info.pImageBuffer + CREATOR_OFFSET), CREATOR_SIZE);
+        const size_t last = creator.find_last_not_of(' ');
+        creator.erase(last == std::string::npos ? 0 : last + 1);
+        return creator;
+    }
+
+    bool openImage(CImageHelperBase &helper, const std::string &path, ImageInfo &info)
+    {
+        info.bWriteProtected = true; // never modify the image
+        info.pImageHelper = &helper;
+        std::string filenameInZip;
+        return helper.Open(path.c_str(), &info, IMAGE_DONT_CREATE, filenameInZip) == eIMAGE_ERROR_NONE;
+    }
+
+    boost::property_tree::ptree entryToTree(const common2::DiskLibraryEntry &entry)
+    {
+        boost::property_tree::ptree tree;
+        tree.put("size", entry.size);
+        tree.put("valid", entry.valid);
+        tree.put("floppy", entry.floppy);
+        tree.put("type", entry.imageType);
+        tree.put("tracks", entry.numTracks);
+        tree.put("bitTiming", int(entry.optimalBitTiming));
+        tree.put("bootSectorFormat", int(entry.bootSectorFormat));
+        tree.put("bootSector13", entry.bootSectorFormat13);
+        tree.put("creator", entry.wozCreator);
+        tree.put("volumeName", entry.volumeName);
+        tree.put("dosVolume", entry.dosVolume);
+        return tree;
+    }
+
+    common2::DiskLibraryEntry treeToEntry(const boost::property_tree::ptree &tree, const uint64_t hash)
+    {
+        common2::DiskLibraryEntry entry;
+        entry.hash = hash;
+        entry.size = tree.get<uint64_t>("size");
+        entry.valid = tree.get<bool>("valid");
+        entry.floppy = tree.get<bool>("floppy");
+        entry.imageType = tree.get<std::string>("type");
+        entry.numTracks = tree.get<uint32_t>("tracks");
+        entry.optimalBitTiming = tree.get<int>("bitTiming");
+        entry.bootSectorFormat = tree.get<int>("bootSectorFormat");
+        entry.bootSectorFormat13 = tree.get<bool>("bootSector13");
+        entry.wozCreator = tree.get<std::string>("creator");
+        entry.volumeName = tree.get<std::string>("volumeName");
+        entry.dosVolume = tree.get<int>("dosVolume");
+        return entry;
+    }
+
+} // namespace
+
+namespace common2
+{
+
+    struct DiskLibrary::Detector
+    {
+        Detector()
+        {
+            myFloppy.SetInteractive(false);
+            myHardDisk.SetInteractive(false);
+        }
+
+        // same order as the frontends: try a floppy first
+        void detect(const std::string &path, DiskLibraryEntry &entry)
+        {
+            {
+                ImageInfo info;
+                if (openImage(myFloppy, path, info))
+                {
+                    // as ImageOpen(): a HDV is not a floppy, and neither is an image without tracks
+                    if (info.pImageType->GetType() != eImageHDV && info.uNumTracks)
+                    {
+                        entry.valid = true;
+                        entry.floppy = true;
+                        entry.imageType = getImageTypeName(info.pImageType->GetType());
+                        entry.numTracks = info.uNumTracks;
+                        if (ImageIsWOZ(&info))
+                        {
+                            entry.optimalBitTiming = ImageGetOptimalBitTiming(&info);
+                            entry.bootSectorFormat = info.bootSectorFormat;
+                            entry.bootSectorFormat13 = ImageIsBootSectorFormatSector13(&info);
+                            entry.wozCreator = getWOZCreator(info);
+                        }
+                        readVolumeInfo(info, entry);
+                    }
+                    myFloppy.Close(&info);
+                    if (entry.valid)
+                    {
+                        return;
+                    }
+                }
+            }
+
+            ImageInfo info;
+            if (openImage(myHardDisk, path, info))
+            {
+                entry.valid = true;
+                entry.floppy = false;
+                entry.imageType = getImageTypeName(info.pImageType->GetType());
+                readVolumeInfo(info, entry);
+                myHardDisk.Close(&info);
+            }
+        }
+
+    private:
+        CDiskImageHelper myFloppy;
+        CHardDiskImageHelper myHardDisk;
+    };
+
+    DiskLibrary::DiskLibrary(const std::filesystem::path &cacheFile)
+        : myCacheFile(cacheFile)
+        , myDirty(false)
+        , myScanning(false)
+    {
+        load();
+    }
+
+    DiskLibrary::~DiskLibrary()
+    {
+        if (myBackgroundScan.joinable())
+        {
+            myBackgroundScan.join();
+        }
+        save();
+    }
+
+    bool DiskLibrary::hasImageExtension(const std::filesystem::path &path)
+    {
+        static const char *extensions[] = {".bin", ".do",  ".dsk", ".nib", ".po",  ".gz",  ".woz",
+                                           ".zip", ".2mg", ".2img", ".iie", ".apl", ".hdv"};
+
+        const std::string extension = path.extension().string();
+        for (const char *valid : extensions)
+        {
+            if (!strcasecmp(extension.c_str(), valid))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool DiskLibrary::findCached(
+        const std::string &path, const uint64_t size, const int64_t mtime, DiskLibraryEntry &entry)
+    {
+        std::lock_guard<std::mutex> lock(myMutex);
+        const auto itPath = myPaths.find(path);
+        if (itPath == myPaths.end() || itPath->second.size != size || itPath->second.mtime != mtime)
+        {
+            return false;
+        }
+
+        const auto itEntry = myEntries.find(itPath->second.hash);
+        if (itEntry == myEntries.end())
+        {
+            return false;
+        }
+
+        entry = itEntry->second;
+        return true;
+    }
+
+    bool DiskLibrary::indexFile(const std::filesystem::path &path, Detector &detector, DiskLibraryEntry &entry)
+    {
+        const std::string pathname = path.string();
+
+        uint64_t size;
+        int64_t mtime;
+        if (!getFileStatus(path, size, mtime))
+        {
+            return false;
+        }
+
+        if (findCached(pathname, size, mtime, entry))
+        {
+            return true;
+        }
+
+        uint64_t hash;
+        if (!hashFile(path, hash))
+        {
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(myMutex);
+            myPaths[pathname] = {size, mtime, hash};
+            myDirty = true;
+
+            const auto it = myEntries.find(hash);
+            if (it != myEntries.end() && it->second.size == size)
+            {
+                // same content, different (or touched) file
+                entry = it->second;
+                return true;
+            }
+        }
+
+        entry = DiskLibraryEntry();
+        entry.hash = hash;
+        entry.size = size;
+        detector.detect(pathname, entry);
+
+        std::lock_guard<std::mutex> lock(myMutex);
+        myEntries[hash] = entry;
+        return true;
+    }
+
+    bool DiskLibrary::lookup(const std::filesystem::path &path, DiskLibraryEntry &entry)
+    {
+        Detector detector;
+        return indexFile(path, detector, entry);
+    }
+
+    bool DiskLibrary::lookupCached(const std::filesystem::path &path, DiskLibraryEntry &entry)
+    {
+        uint64_t size;
+        int64_t mtime;
+        return getFileStatus(path, size, mtime) && findCached(path.string(), size, mtime, entry);
+    }
+
+    void DiskLibrary::scan(const std::vector<std::filesystem::path> &paths, size_t numberOfThreads)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::filesystem::path> files;
+        for (const std::filesystem::path &path : paths)
+        {
+            std::error_code ec;
+            if (std::filesystem::is_directory(path, ec))
+            {
+                const auto options = std::filesystem::directory_options::skip_permission_denied;
+                for (auto it = std::filesystem::recursive_directory_iterator(path, options, ec);
+                     it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+                {
+                    if (ec)
+                    {
+                        break;
+                    }
+                    if (it->is_regular_file(ec) && hasImageExtension(it->path()))
+                    {
+                        files.push_back(it->path());
+                    }
+                }
+            }
+            else if (std::filesystem::is_regular_file(path, ec))
+            {
+                files.push_back(path);
+            }
+        }
+
+        if (numberOfThreads == 0)
+        {
+            numberOfThreads = std::max(1U, std::thread::hardware_concurrency());
+        }
+        numberOfThreads = std::min(numberOfThreads, files.size());
+
+        std::atomic<size_t> next(0);
+        const auto worker = [this, &files, &next]()
+        {
+            Detector detector;
+            for (size_t i = next++; i < files.size(); i = next++)
+            {
+                DiskLibraryEntry entry;
+                indexFile(files[i], detector, entry);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < numberOfThreads; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+
+        const auto end = std::chrono::steady_clock::now();
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        LogFileOutput(
+            "DiskLibrary: %zu file(s) indexed in %d ms (%zu thread(s))\n", files.size(), int(elapsed), numberOfThreads);
+    }
+
+    void DiskLibrary::scanInBackground(const std::vector<std::filesystem::path> &paths)
+    {
+        std::lock_guard<std::mutex> lock(myMutex);
+        myPending.insert(myPending.end(), paths.begin(), paths.end());
+        if (!myScanning)
+        {
+            // the previous scan (if any) has found nothing left to do: it is returning, join() does not wait
+            if (myBackgroundScan.joinable())
+            {
+                myBackgroundScan.join();
+            }
+            myScanning = true;
+            myBackgroundScan = std::thread(&DiskLibrary::scanPending, this);
+        }
+    }
+
+    void DiskLibrary::scanPending()
+    {
+        while (true)
+        {
+            std::vector<std::filesystem::path> paths;
+            {
+                std::lock_guard<std::mutex> lock(myMutex);
+                if (myPending.empty())
+                {
+                    myScanning = false;
+                    return;
+                }
+                paths.swap(myPending);
+            }
+            scan(paths);
+        }
+    }
+
+    std::vector<std::pair<std::string, DiskLibraryEntry>> DiskLibrary::getEntries()
+    {
+        std::vector<std::pair<std::string, DiskLibraryEntry>> entries;
+
+        std::lock_guard<std::mutex> lock(myMutex);
+        for (const auto &path : myPaths)
+        {
+            const auto it = myEntries.find(path.second.hash);
+            if (it != myEntries.end())
+            {
+                entries.emplace_back(path.first, it->second);
+            }
+        }
+        return entries;
+    }
+
+    void DiskLibrary::load()
+    {
+        if (myCacheFile.empty() || !std::filesystem::exists(myCacheFile))
+        {
+            return;
+        }
+
+        try
+        {
+            boost::property_tree::ptree tree;
+            boost::property_tree::read_json(myCacheFile.string(), tree);
+            if (tree.get<int>("version") != CACHE_VERSION)
+            {
+                return;
+            }
+
+            for (const auto &image : tree.get_child("images"))
+            {
+                const uint64_t hash = std::stoull(image.first, nullptr, 16);
+                myEntries[hash] = treeToEntry(image.second, hash);
+            }
+
+            for (const auto &path : tree.get_child("paths"))
+            {
+                const boost::property_tree::ptree &record = path.second;
+                const uint64_t hash = std::stoull(record.get<std::string>("hash"), nullptr, 16);
+                myPaths[record.get<std::string>("path")] = {
+                    record.get<uint64_t>("size"), record.get<int64_t>("mtime"), hash};
+            }
+        }
+        catch (const std::exception &e)
+        {
+            LogFileOutput("DiskLibrary: ignoring cache '%s': %s\n", myCacheFile.string().c_str(), e.what());
+            myEntries.clear();
+            myPaths.clear();
+        }
+    }
+
+    void DiskLibrary::save()
+    {
+        std::lock_guard<std::mutex> lock(myMutex);
+        if (!myDirty || myCacheFile.empty())
+        {
+            return;
+        }
+
+        // keys are built by hand: '.' in a filename is not a path separator
+        boost::property_tree::ptree images;
+        for (const auto &entry : myEntries)
+        {
+            images.push_back(std::make_pair(toHex(entry.first), entryToTree(entry.second)));
+        }
+
+        boost::property_tree::ptree paths;
+        for (const auto &path : myPaths)
+        {
+            boost::property_tree::ptree record;
+            record.push_back(std::make_pair("path", boost::property_tree::ptree(path.first)));
+            record.put("size", path.second.size);
+            record.put("mtime", path.second.mtime);
+            record.put("hash", toHex(path.second.hash));
+            paths.push_back(std::make_pair("", record));
+        }
+
+        boost::property_tree::ptree tree;
+        tree.put("version", CACHE_VERSION);
+        tree.add_child("images", images);
+        tree.add_child("paths", paths);
+
+        try
+        {
+            const std::filesystem::path temporary = myCacheFile.string() + ".tmp";
+            boost::property_tree::write_json(temporary.string(), tree, std::locale(), false);
+            std::filesystem::rename(temporary, myCacheFile);
+            myDirty = false;
+        }
+        catch (const std::exception &e)
+        {
+            LogFileOutput("DiskLibrary: cannot save cache '%s': %s\n", myCacheFile.string().c_str(), e.what());
+        }
+    }
+
+} // namespace common2
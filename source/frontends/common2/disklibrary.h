@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <filesystem>
+#include <cstdint>
+
+namespace common2
+{
+
+    // what we know about a disk image, without opening it again
+    struct DiskLibraryEntry
+    {
+        uint64_t hash = 0; // of the file content
+        uint64_t size = 0;
+
+        bool valid = false;  // recognised by either CDiskImageHelper or CHardDiskImageHelper
+        bool floppy = false; // otherwise it is a hard disk image
+        std::string imageType;
+
+        // floppy only
+        uint32_t numTracks = 0;
+        uint8_t optimalBitTiming = 0;    // from the WOZ INFO chunk (32 = 4us)
+        uint8_t bootSectorFormat = 0;    // from the WOZ INFO chunk (CWOZHelper::bootUnknown...)
+        bool bootSectorFormat13 = false; // ImageIsBootSectorFormatSector13()
+        std::string wozCreator;          // from the WOZ INFO chunk
+
+        std::string volumeName; // ProDOS volume directory (sector based images only)
+        int dosVolume = -1;     // DOS 3.3 VTOC (sector based images only)
+    };
+
+    // Index of disk images, with a persistent cache.
+    // The cache is keyed by the content hash, so moved or copied images are found again without detection;
+    // the path -> (size, mtime, hash) map avoids reading unchanged files at all.
+    class DiskLibrary
+    {
+    public:
+        explicit DiskLibrary(const std::filesystem::path &cacheFile);
+        ~DiskLibrary();
+
+        // recurse into directories and index every disk image on a pool of threads (0 = hardware concurrency)
+        void scan(const std::vector<std::filesystem::path> &paths, size_t numberOfThreads = 0);
+        // never waits: the paths are queued, and indexed by the running background scan (or a new one)
+        void scanInBackground(const std::vector<std::filesystem::path> &paths);
+
+        // from the cache if possible, otherwise detect it now (and cache it)
+        bool lookup(const std::filesystem::path &path, DiskLibraryEntry &entry);
+
+        // only from the cache: the file is not read (false if unknown, or changed since it was indexed)
+        bool lookupCached(const std::filesystem::path &path, DiskLibraryEntry &entry);
+
+        std::vector<std::pair<std::string, DiskLibraryEntry>> getEntries();
+        void save();
+
+        static bool hasImageExtension(const std::filesystem::path &path);
+
+    private:
+        struct PathRecord
+        {
+            uint64_t size;
+            int64_t mtime;
+            uint64_t hash;
+        };
+
+        // the image helpers are not thread safe: 1 per thread
+        struct Detector;
+
+        bool findCached(const std::string &path, const uint64_t size, const int64_t mtime, DiskLibraryEntry &entry);
+        bool indexFile(const std::filesystem::path &path, Detector &detector, DiskLibraryEntry &entry);
+
+        void scanPending();
+        void load();
+
+        const std::filesystem::path myCacheFile;
+
+        std::mutex myMutex;
+        std::map<std::string, PathRecord> myPaths;
+        std::map<uint64_t, DiskLibraryEntry> myEntries;
+        bool myDirty;
+
+        std::vector<std::filesystem::path> myPending; // waiting for the background scan
+        bool myScanning;                              // the background scan has not seen myPending empty yet
+        std::thread myBackgroundScan;
+    };
+
+} // namespace common2
@@ -0,0 +1,134 @@
+#include "StdAfx.h"
+#include "frontends/common2/fullspeedvideo.h"
+
+#include "Interface.h"
+#include "Memory.h"
+
+namespace common2
+{
+
+    FullSpeedVideo::FullSpeedVideo(const size_t budget)
+        : myBudget(budget)
+        , myForce(true)
+    {
+    }
+
+    void FullSpeedVideo::reset()
+    {
+        // what is on screen might have been drawn only in part: the first redraw always happens
+        myNext = std::chrono::steady_clock::now() + ourMinimumInterval;
+        myNextPresent = myNext;
+        myForce = true;
+    }
+
+    bool FullSpeedVideo::isRedrawDue()
+    {
+        if (!myBudget)
+        {
+            return false;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now < myNext)
+        {
+            return false;
+        }
+
+        if (hasChanged() || myForce)
+        {
+            return true;
+        }
+
+        // nothing to show: do not look again before the next host frame
+        myNext = now + ourMinimumInterval;
+        return false;
+    }
+
+    void FullSpeedVideo::redrawn(const std::chrono::time_point<std::chrono::steady_clock> &start)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const auto duration = now - start;
+
+        // keep redraw time / elapsed time below the budget
+        const auto interval = std::max<std::chrono::steady_clock::duration>(ourMinimumInterval, duration * 100 / static_cast<int64_t>(myBudget));
+        myNext = start + interval;
+        myNextPresent = now + ourMinimumInterval;
+        myForce = false;
+    }
+
+    bool FullSpeedVideo::isPresentDue()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if (now < myNextPresent)
+        {
+            return false;
+        }
+
+        myNextPresent = now + ourMinimumInterval;
+        return true;
+    }
+
+    bool FullSpeedVideo::hasChanged()
+    {
+        Video &video = GetVideo();
+        const uint32_t mode = video.GetVideoMode();
+
+        myCurrentSettings.assign({
+            mode,
+            static_cast<uint32_t>(video.GetVideoType()),
+            static_cast<uint32_t>(video.GetVideoStyle()),
+            static_cast<uint32_t>(video.GetMonochromeRGB()),
+            static_cast<uint32_t>(video.VideoGetSWAltCharSet()),
+        });
+
+        // only the memory the video scanner reads in this mode
+        myCurrentMemory.clear();
+        if (mode & VF_SHR)
+        {
+            appendMemory(true, 0x2000, 0x8000);
+        }
+        else
+        {
+            const bool page2 = (mode & VF_PAGE2) && !(mode & VF_80STORE);
+            const bool aux = mode & VF_80COL;
+            const bool hires = !(mode & VF_TEXT) && (mode & VF_HIRES);
+
+            // TEXT, LORES or the 4 lines of text in MIXED
+            if (!hires || (mode & VF_MIXED))
+            {
+                const uint16_t address = page2 ? 0x0800 : 0x0400;
+                appendMemory(false, address, 0x0400);
+                if (aux)
+                {
+                    appendMemory(true, address, 0x0400);
+                }
+            }
+
+            if (hires)
+            {
+                const uint16_t address = page2 ? 0x4000 : 0x2000;
+                appendMemory(false, address, 0x2000);
+                if (aux)
+                {
+                    appendMemory(true, address, 0x2000);
+                }
+            }
+        }
+
+        const bool changed = myCurrentSettings != mySettings || myCurrentMemory != myMemory;
+        std::swap(mySettings, myCurrentSettings);
+        std::swap(myMemory, myCurrentMemory);
+        return changed;
+    }
+
+    void FullSpeedVideo::appendMemory(const bool aux, const uint16_t address, const uint16_t size)
+    {
+        // each page can be in a different place (see MemGetMainPtr())
+        for (uint32_t page = address; page < uint32_t(address) + size; page += 0x100)
+        {
+            const uint8_t *data = aux ? MemGetAuxPtr(page) : MemGetMainPtr(page);
+            myCurrentMemory.insert(myCurrentMemory.end(), data, data + 0x100);
+        }
+    }
+
+} // namespace common2
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace common2
+{
+
+    // At full speed the video is not updated cycle by cycle, and the whole screen is redrawn from time to time.
+    // This decides when: only if the video mode or the displayed video memory changed,
+    // and not more often than the wall clock budget allows.
+    class FullSpeedVideo
+    {
+    public:
+        // % of the wall clock time that can be spent redrawing (0 = never redraw at full speed)
+        FullSpeedVideo(const size_t budget);
+
+        // when entering full speed
+        void reset();
+
+        // true if the screen should be redrawn now
+        bool isRedrawDue();
+
+        // the redraw started at "start" is finished
+        void redrawn(const std::chrono::time_point<std::chrono::steady_clock> &start);
+
+        // true if the frame already drawn should be presented again now (the UI keeps updating)
+        bool isPresentDue();
+
+    private:
+        bool hasChanged();
+        void appendMemory(const bool aux, const uint16_t address, const uint16_t size);
+
+        // the original AppleWin interval: no point in redrawing or presenting faster than the host refreshes
+        static constexpr std::chrono::milliseconds ourMinimumInterval{16};
+
+        const size_t myBudget;
+
+        std::chrono::time_point<std::chrono::steady_clock> myNext;
+        std::chrono::time_point<std::chrono::steady_clock> myNextPresent;
+        bool myForce;
+
+        std::vector<uint32_t> mySettings;
+        std::vector<uint8_t> myMemory;
+        std::vector<uint32_t> myCurrentSettings;
+        std::vector<uint8_t> myCurrentMemory;
+    };
+
+} // namespace common2
@@ -8,6 +8,7 @@
 #include "Utilities.h"
 #include "Core.h"
 #include "Speaker.h"
+#include "SoundCore.h"
 #include "Riff.h"
 #include "CardManager.h"
 
@@ -93,6 +94,9 @@ namespace common2
             }
         }
 
+        GetCardMgr().GetMockingboardCardMgr().SetAudioThread(options.mockingboardAudioThread);
+        SoundCore_SetTargetLatency(options.audioLatency);
+
         Paddle::setSquaring(options.paddleSquaring);
     }
 
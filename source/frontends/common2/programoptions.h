@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <optional>
@@ -26,16 +27,27 @@ namespace common2
         std::string hardDisk1;
         std::string hardDisk2;
 
+        std::vector<std::filesystem::path> diskLibrary; // folders to index in the background
+
         std::string snapshotFilename;
         bool loadSnapshot = false;
+        std::string convertSnapshotFilename; // save the loaded snapshot here (YAML or binary) and quit
+        size_t rewindBuffer = 0;             // in MB, 0 = no rewind
+
+        std::string recordInput;      // see InputRecorder
+        std::string replayInput;      // the seed is in the file
+        std::optional<uint32_t> seed; // fixed seed for rand()
+
+        std::string pasteFile; // typed (turbo paste) once the machine has started
 
         int memclear;
 
         bool log = false;
 
         bool benchmark = false;
+        bool perfCounters = false; // see PerfCounters.h
         bool headless = false;
-        bool noVideoUpdate = false; // only for applen
+        bool videoRaster = true; // false: the video scanner runs, but no pixels are drawn (see NTSC_SetVideoRaster)
 
         bool paddleSquaring = true; // turn the x/y range to a square
         // on my PC it is something like
@@ -51,12 +63,20 @@ namespace common2
         bool fixedSpeed = false; // default adaptive
         bool syncWithTimer = false;
         size_t audioBuffer = 46; // in ms -> corresponds to 2048 samples (keep below 90ms)
+        size_t audioLatency = 0; // in ms, queued by the emulator (0 = AppleWin's heuristic)
 
         int sdlDriver = -1;               // default = -1 to let SDL choose
         bool imgui = true;                // use imgui renderer
         std::optional<Geometry> geometry; // must be initialised with defaults
         bool aspectRatio = false;         // preserve aspect ratio
         int glSwapInterval = -1;          // SDL_GL_SetSwapInterval
+        bool emulationThread = false;     // ExecuteOneFrame() on its own thread
+        size_t fullSpeedVideoBudget = 5;  // % of the time spent redrawing the screen at full speed
+
+        std::string batchJobs;            // applebatch: one job per line
+        size_t batchWorkers = 0;          // applebatch: worker processes, 0 = one per core
+        uint64_t warmupCycles = 0;        // applebatch: run before forking the workers
+        std::optional<uint16_t> warmupPC; // applebatch: run until here before forking the workers
         std::optional<int> gameControllerIndex;
         std::string gameControllerMappingFile;
         std::string audioDeviceName;
@@ -67,6 +87,7 @@ namespace common2
         bool noAudio = false;
         std::string wavFileSpeaker;
         std::string wavFileMockingboard;
+        bool mockingboardAudioThread = false;
 
         std::vector<std::string> registryOptions;
 
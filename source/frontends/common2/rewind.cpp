@@ -0,0 +1,352 @@
+#include "StdAfx.h"
+#include "frontends/common2/rewind.h"
+
+#include "SaveState.h"
+
+#include <zlib.h>
+
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+    // a literal run ends after this many zeros
+    constexpr size_t MIN_ZERO_RUN = 8;
+
+    void putVarint(std::vector<uint8_t> &out, size_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    size_t getVarint(const uint8_t *&p)
+    {
+        size_t value = 0;
+        int shift = 0;
+        uint8_t b;
+        do
+        {
+            b = *p++;
+            value |= size_t(b & 0x7f) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        return value;
+    }
+
+    // first non zero byte in [begin, end)
+    size_t skipZeros(const uint8_t *data, size_t begin, const size_t end)
+    {
+        while (begin + sizeof(uint64_t) <= end)
+        {
+            uint64_t word;
+            memcpy(&word, data + begin, sizeof(word));
+            if (word)
+            {
+                break;
+            }
+            begin += sizeof(uint64_t);
+        }
+        while (begin < end && !data[begin])
+        {
+            ++begin;
+        }
+        return begin;
+    }
+
+    double microsecondsSince(const std::chrono::steady_clock::time_point &start)
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+} // namespace
+
+namespace common2
+{
+
+    Rewind::Rewind(const size_t interval, const size_t keyframe, const size_t budget)
+        : myInterval(std::max<size_t>(1, interval))
+        , myKeyframe(std::max<size_t>(1, keyframe))
+        , myBudget(budget)
+    {
+        clear();
+    }
+
+    void Rewind::clear()
+    {
+        myEntries.clear();
+        myLatest.clear();
+        myFrames = 0;
+        mySinceKeyframe = 0;
+        myDeltaBytes = 0;
+        myCaptureTotalUs = 0.0;
+        myCaptures = 0;
+        myRestoreUs = 0.0;
+    }
+
+    void Rewind::frame()
+    {
+        ++myFrames;
+        if (myFrames >= myInterval)
+        {
+            myFrames = 0;
+            capture();
+        }
+    }
+
+    void Rewind::capture()
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        if (!Snapshot_SaveState(myCurrent))
+        {
+            // the user has already been told, do not insist every few frames
+            clear();
+            return;
+        }
+
+        const bool keyframe = myEntries.empty() || mySinceKeyframe >= myKeyframe;
+        if (keyframe)
+        {
+            compress(myCurrent, myEncoded);
+        }
+        else
+        {
+            encode(myCurrent, myLatest, myEncoded);
+        }
+
+        Entry &entry = myEntries.emplace_back();
+        entry.keyframe = keyframe;
+        entry.size = myCurrent.size();
+        entry.delta.assign(myEncoded.begin(), myEncoded.end());
+        myDeltaBytes += entry.delta.size();
+
+        mySinceKeyframe = keyframe ? 1 : mySinceKeyframe + 1;
+        myLatest.swap(myCurrent);
+
+        evict();
+
+        myCaptureTotalUs += microsecondsSince(start);
+        ++myCaptures;
+    }
+
+    void Rewind::evict()
+    {
+        while (myDeltaBytes + myLatest.size() > myBudget)
+        {
+            // drop the oldest keyframe group, but never the last one
+            size_t next = 1;
+            while (next < myEntries.size() && !myEntries[next].keyframe)
+            {
+                ++next;
+            }
+            if (next >= myEntries.size())
+            {
+                break;
+            }
+            for (size_t i = 0; i < next; ++i)
+            {
+                myDeltaBytes -= myEntries.front().delta.size();
+                myEntries.pop_front();
+            }
+        }
+    }
+
+    bool Rewind::rewind(const size_t steps)
+    {
+        if (myEntries.empty() || steps == 0)
+        {
+            return false;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        const size_t target = myEntries.size() - std::min(steps, myEntries.size());
+        if (target + 1 == myEntries.size())
+        {
+            myCurrent.swap(myLatest);
+        }
+        else
+        {
+            reconstruct(target, myCurrent);
+        }
+
+        // the new newest entry must be available in full for the next capture
+        if (target > 0)
+        {
+            const Entry &entry = myEntries[target];
+            if (entry.keyframe)
+            {
+                reconstruct(target - 1, myLatest);
+            }
+            else
+            {
+                // XOR is its own inverse: one step backwards
+                myLatest = myCurrent;
+                myLatest.resize(std::max(myLatest.size(), myEntries[target - 1].size), 0);
+                decode(entry.delta, myEntries[target - 1].size, myLatest);
+            }
+        }
+        else
+        {
+            myLatest.clear();
+        }
+
+        while (myEntries.size() > target)
+        {
+            myDeltaBytes -= myEntries.back().delta.size();
+            myEntries.pop_back();
+        }
+
+        mySinceKeyframe = 0;
+        for (size_t i = myEntries.size(); i > 0; --i)
+        {
+            ++mySinceKeyframe;
+            if (myEntries[i - 1].keyframe)
+            {
+                break;
+            }
+        }
+        myFrames = 0;
+
+        const bool ok = Snapshot_LoadState(myCurrent.data(), myCurrent.size());
+        myRestoreUs = microsecondsSince(start);
+        return ok;
+    }
+
+    void Rewind::reconstruct(const size_t index, std::vector<uint8_t> &state) const
+    {
+        size_t first = index;
+        while (first > 0 && !myEntries[first].keyframe)
+        {
+            --first;
+        }
+
+        uncompress(myEntries[first].delta, myEntries[first].size, state);
+
+        for (size_t i = first + 1; i <= index; ++i)
+        {
+            const size_t size = myEntries[i].size;
+            state.resize(std::max(state.size(), size), 0);
+            decode(myEntries[i].delta, size, state);
+        }
+    }
+
+    void Rewind::compress(const std::vector<uint8_t> &state, std::vector<uint8_t> &out)
+    {
+        uLongf size = compressBound(state.size());
+        out.resize(size);
+        if (compress2(out.data(), &size, state.data(), state.size(), Z_BEST_SPEED) != Z_OK)
+        {
+            throw std::runtime_error("Rewind: cannot compress state");
+        }
+        out.resize(size);
+    }
+
+    void Rewind::uncompress(const std::vector<uint8_t> &data, const size_t size, std::vector<uint8_t> &state)
+    {
+        state.resize(size);
+        uLongf length = size;
+        if (::uncompress(state.data(), &length, data.data(), data.size()) != Z_OK || length != size)
+        {
+            throw std::runtime_error("Rewind: cannot uncompress state");
+        }
+    }
+
+    // sequence of (varint zeros, varint length, length literal bytes) covering max(state, previous)
+    void Rewind::encode(const std::vector<uint8_t> &state, const std::vector<uint8_t> &previous, std::vector<uint8_t> &out)
+    {
+        const size_t size = std::max(state.size(), previous.size());
+
+        std::vector<uint8_t> &diff = myDiff;
+        diff.assign(size, 0);
+        memcpy(diff.data(), state.data(), state.size());
+
+        const size_t common = previous.size();
+        uint8_t *d = diff.data();
+        const uint8_t *p = previous.data();
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= common; i += sizeof(uint64_t))
+        {
+            uint64_t a, b;
+            memcpy(&a, d + i, sizeof(a));
+            memcpy(&b, p + i, sizeof(b));
+            a ^= b;
+            memcpy(d + i, &a, sizeof(a));
+        }
+        for (; i < common; ++i)
+        {
+            d[i] ^= p[i];
+        }
+
+        out.clear();
+        const uint8_t *data = diff.data();
+        i = 0;
+        while (i < size)
+        {
+            const size_t literal = skipZeros(data, i, size);
+            if (literal == size)
+            {
+                break; // trailing zeros are implicit
+            }
+
+            size_t end = literal + 1;
+            size_t j = end;
+            while (j < size && j - end < MIN_ZERO_RUN)
+            {
+                if (data[j])
+                {
+                    end = j + 1;
+                }
+                ++j;
+            }
+
+            putVarint(out, literal - i);
+            putVarint(out, end - literal);
+            out.insert(out.end(), data + literal, data + end);
+            i = end;
+        }
+    }
+
+    // state must already be as large as max(previous size, size), zero padded
+    void Rewind::decode(const std::vector<uint8_t> &delta, const size_t size, std::vector<uint8_t> &state)
+    {
+        const uint8_t *p = delta.data();
+        const uint8_t *const end = p + delta.size();
+        uint8_t *s = state.data();
+        size_t pos = 0;
+        while (p < end)
+        {
+            pos += getVarint(p);
+            const size_t length = getVarint(p);
+            for (size_t k = 0; k < length; ++k)
+            {
+                s[pos + k] ^= p[k];
+            }
+            p += length;
+            pos += length;
+        }
+        state.resize(size);
+    }
+
+    Rewind::Stats Rewind::getStats() const
+    {
+        Stats stats;
+        stats.entries = myEntries.size();
+        stats.keyframes = std::count_if(
+            myEntries.begin(), myEntries.end(), [](const Entry &entry) { return entry.keyframe; });
+        stats.memory = myDeltaBytes + myLatest.size();
+        stats.stateSize = myLatest.size();
+        stats.seconds = double(myEntries.size() * myInterval) / 60.0;
+        stats.captureUs = myCaptures ? myCaptureTotalUs / myCaptures : 0.0;
+        stats.restoreUs = myRestoreUs;
+        return stats;
+    }
+
+} // namespace common2
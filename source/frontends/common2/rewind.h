@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <cstddef>
+
+namespace common2
+{
+
+    // Ring buffer of machine states, captured every N frames with Snapshot_SaveState(std::vector<BYTE> &).
+    // Each entry is the XOR of its state with the previous one, zero-run-length encoded,
+    // so memory which has not changed between 2 captures costs a couple of bytes;
+    // every K-th entry is a keyframe (the whole state, zlib compressed) to bound the cost of a restore.
+    // When over budget, the oldest keyframe group is discarded.
+    class Rewind
+    {
+    public:
+        struct Stats
+        {
+            size_t entries;     // number of retained states
+            size_t keyframes;   // number of keyframes among them
+            size_t memory;      // bytes used by the deltas + the latest state
+            size_t stateSize;   // size of the latest full state
+            double seconds;     // history retained (at 60 fps)
+            double captureUs;   // average time to capture + encode a state
+            double restoreUs;   // time taken by the last restore
+        };
+
+        // interval: frames between captures, keyframe: entries between keyframes, budget: bytes
+        Rewind(const size_t interval, const size_t keyframe, const size_t budget);
+
+        // to be called once per emulated frame
+        void frame();
+
+        // restore the state captured "steps" entries ago (1 = the most recent)
+        // and discard it together with every newer entry
+        bool rewind(const size_t steps = 1);
+
+        void clear();
+
+        Stats getStats() const;
+
+        static constexpr size_t ourDefaultInterval = 6;           // 10 captures per second
+        static constexpr size_t ourDefaultKeyframe = 64;          // ~6s at 10 per second
+        static constexpr size_t ourDefaultBudget = 64 * 1024 * 1024;
+
+    private:
+        struct Entry
+        {
+            bool keyframe;
+            size_t size;                // size of the state
+            std::vector<uint8_t> delta; // RLE of (state XOR previous state), or the compressed state if keyframe
+        };
+
+        void capture();
+        void evict();
+        void reconstruct(const size_t index, std::vector<uint8_t> &state) const;
+
+        void encode(const std::vector<uint8_t> &state, const std::vector<uint8_t> &previous, std::vector<uint8_t> &out);
+        static void compress(const std::vector<uint8_t> &state, std::vector<uint8_t> &out);
+        static void uncompress(const std::vector<uint8_t> &data, const size_t size, std::vector<uint8_t> &state);
+        static void decode(const std::vector<uint8_t> &delta, const size_t size, std::vector<uint8_t> &state);
+
+        const size_t myInterval;
+        const size_t myKeyframe;
+        const size_t myBudget;
+
+        size_t myFrames;
+        size_t mySinceKeyframe;
+        size_t myDeltaBytes;
+
+        std::deque<Entry> myEntries;
+        std::vector<uint8_t> myLatest;  // full state of myEntries.back()
+        std::vector<uint8_t> myCurrent; // scratch
+        std::vector<uint8_t> myEncoded; // scratch
+        std::vector<uint8_t> myDiff;    // scratch
+
+        double myCaptureTotalUs;
+        size_t myCaptures;
+        double myRestoreUs;
+    };
+
+} // namespace common2
@@ -1,8 +1,12 @@
+#include "StdAfx.h"
 #include "frontends/common2/timer.h"
 
+#include "PerfCounters.h"
+
 #include <ostream>
 #include <cmath>
 #include <iomanip>
+#include <algorithm>
 
 namespace common2
 {
@@ -10,6 +14,7 @@ namespace common2
     Timer::Timer()
         : mySum(0)
         , mySum2(0)
+        , myMax(0)
         , myN(0)
     {
         tic();
@@ -27,6 +32,7 @@ namespace common2
         const double s = micros * 0.000001;
         mySum += s;
         mySum2 += s * s;
+        myMax = std::max(myMax, s);
         ++myN;
         myT0 = now;
     }
@@ -36,6 +42,11 @@ namespace common2
         return mySum;
     }
 
+    double Timer::getMaxInSeconds() const
+    {
+        return myMax;
+    }
+
     std::ostream &operator<<(std::ostream &os, const Timer &timer)
     {
         const int width = 10;
@@ -46,8 +57,66 @@ namespace common2
         os << "total = " << std::setw(width) << timer.mySum * scale << " ms";
         os << ", mean = " << std::setw(width) << m1 * scale << " ms";
         os << ", std = " << std::setw(width) << std * scale << " ms";
+        os << ", max = " << std::setw(width) << timer.myMax * scale << " ms";
         os << ", n = " << std::setw(6) << timer.myN;
         return os;
     }
 
+    void printPerfCounters(std::ostream &os)
+    {
+        const UINT64 frames = PerfCounters_GetFrames();
+        const UINT64 wallTime = PerfCounters_GetWallTime();
+        if (!frames || !wallTime)
+        {
+            return;
+        }
+
+        const std::ios_base::fmtflags flags = os.flags(std::ios::fixed);
+        const std::streamsize precision = os.precision(2);
+
+        const int width = 10;
+        const double scale = 0.000001; // ns -> ms
+        os << "Perf counters: " << frames << " frames, " << wallTime * scale << " ms" << std::endl;
+
+        UINT64 total = 0;
+        for (UINT i = 0; i < PERF_NUM_COUNTERS; ++i)
+        {
+            const PerfCounterID id = PerfCounterID(i);
+            PerfCounterStats stats;
+            PerfCounters_GetStats(id, stats);
+            total += stats.total;
+
+            os << std::left << std::setw(14) << (std::string(PerfCounters_GetName(id)) + ":") << std::right;
+            os << "total = " << std::setw(width) << stats.total * scale << " ms";
+            os << ", mean = " << std::setw(width) << stats.total * scale / frames << " ms";
+            os << ", max = " << std::setw(width) << stats.max * scale << " ms";
+            os << ", " << std::setw(6) << 100.0 * stats.total / wallTime << " %" << std::endl;
+
+            // frames per bin, only the non-empty ones
+            os << "              us/frame:";
+            for (UINT bin = 0; bin < PERF_HISTOGRAM_BINS; ++bin)
+            {
+                if (stats.histogram[bin])
+                {
+                    if (bin)
+                    {
+                        os << " >=" << PerfCounters_GetHistogramBinLow(bin);
+                    }
+                    else
+                    {
+                        os << " <1";
+                    }
+                    os << ": " << stats.histogram[bin];
+                }
+            }
+            os << std::endl;
+        }
+
+        os << std::left << std::setw(14) << "Other:" << std::right;
+        os << "total = " << std::setw(width) << (wallTime - std::min(wallTime, total)) * scale << " ms" << std::endl;
+
+        os.flags(flags);
+        os.precision(precision);
+    }
+
 } // namespace common2
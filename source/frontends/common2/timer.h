@@ -12,6 +12,7 @@ namespace common2
         void toc();
 
         double getTimeInSeconds() const;
+        double getMaxInSeconds() const;
 
         friend std::ostream &operator<<(std::ostream &os, const Timer &timer);
 
@@ -20,9 +21,13 @@ namespace common2
 
         double mySum;
         double mySum2;
+        double myMax;
         int myN;
     };
 
     std::ostream &operator<<(std::ostream &os, const Timer &timer);
 
+    // PerfCounters: one line per subsystem, with the histogram of the time per frame
+    void printPerfCounters(std::ostream &os);
+
 } // namespace common2
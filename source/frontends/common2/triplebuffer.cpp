@@ -0,0 +1,56 @@
+#include "frontends/common2/triplebuffer.h"
+
+namespace common2
+{
+
+    TripleBuffer::TripleBuffer()
+        : myMiddle(1)
+        , myBack(0)
+        , myFront(2)
+    {
+    }
+
+    void TripleBuffer::resize(const size_t size)
+    {
+        for (std::vector<uint8_t> &buffer : myBuffers)
+        {
+            buffer.assign(size, 0);
+        }
+    }
+
+    size_t TripleBuffer::size() const
+    {
+        return myBuffers[0].size();
+    }
+
+    uint8_t *TripleBuffer::getBack()
+    {
+        return myBuffers[myBack].data();
+    }
+
+    void TripleBuffer::publish()
+    {
+        // release: the consumer must see the content of the buffer
+        const uint8_t previous = myMiddle.exchange(myBack | ourFresh, std::memory_order_acq_rel);
+        myBack = previous & ourIndexMask;
+    }
+
+    bool TripleBuffer::acquire()
+    {
+        if (!(myMiddle.load(std::memory_order_relaxed) & ourFresh))
+        {
+            return false;
+        }
+
+        // acquire: we see what the producer wrote before publish()
+        const uint8_t previous = myMiddle.exchange(myFront, std::memory_order_acq_rel);
+        myFront = previous & ourIndexMask;
+        return true;
+    }
+
+    const uint8_t *TripleBuffer::getFront() const
+    {
+        return myBuffers[myFront].data();
+    }
+
+} // namespace common2
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace common2
+{
+
+    // Wait-free hand-over of whole buffers from one producer thread to one consumer thread.
+    // The producer fills the back buffer and publishes it, the consumer acquires the latest published one:
+    // neither ever waits for the other, and a buffer is never read and written at the same time.
+    // Intermediate buffers are dropped if the producer is faster.
+    class TripleBuffer
+    {
+    public:
+        TripleBuffer();
+
+        // not thread safe
+        void resize(const size_t size);
+        size_t size() const;
+
+        // producer
+        uint8_t *getBack();
+        void publish();
+
+        // consumer: returns true if a new buffer has been published since the last call
+        bool acquire();
+        const uint8_t *getFront() const;
+
+    private:
+        static constexpr uint8_t ourIndexMask = 0x03;
+        static constexpr uint8_t ourFresh = 0x04; // the middle buffer has not been acquired yet
+
+        std::vector<uint8_t> myBuffers[3];
+
+        // index of the buffer between producer and consumer, plus ourFresh
+        std::atomic<uint8_t> myMiddle;
+        uint8_t myBack;  // owned by the producer
+        uint8_t myFront; // owned by the consumer
+    };
+
+} // namespace common2
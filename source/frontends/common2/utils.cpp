@@ -2,9 +2,14 @@
 #include "frontends/common2/utils.h"
 #include "frontends/common2/programoptions.h"
 
+#include "linux/keyboardbuffer.h"
+
 #include "SaveState.h"
 #include "Registry.h"
 
+#include <fstream>
+#include <sstream>
+
 namespace
 {
 
@@ -51,6 +56,20 @@ namespace common2
         }
     }
 
+    bool pasteFile(const std::filesystem::path &filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+
+        std::ostringstream text;
+        text << file.rdbuf();
+        pasteTextToBuffer(text.str().c_str());
+        return true;
+    }
+
     void loadGeometryFromRegistry(const std::string &section, Geometry &geometry)
     {
         const std::string path = section + "\\geometry";
@@ -8,6 +8,8 @@ namespace common2
     struct Geometry;
 
     void setSnapshotFilename(const std::filesystem::path &filename);
+    // turbo paste (see pasteTextToBuffer), false if the file cannot be read
+    bool pasteFile(const std::filesystem::path &filename);
 
     void loadGeometryFromRegistry(const std::string &section, Geometry &geometry);
     void saveGeometryToRegistry(const std::string &section, const Geometry &geometry);
@@ -17,6 +17,7 @@ namespace
     const std::string M3U_COMMENT("#");
     const std::string M3U_SAVEDISK("#SAVEDISK:");
     const std::string M3U_SAVEDISK_LABEL("Save Disk ");
+    const std::string DISK_LIBRARY_CACHE("applewin_disklibrary.json");
 
     bool startsWith(const std::string &value, const std::string &prefix)
     {
@@ -83,12 +84,37 @@ namespace ra2
         myCurrentDiskFolder = filePath.parent_path().string();
     }
 
+    common2::DiskLibrary &DiskControl::getLibrary()
+    {
+        // created on first use, as the save directory is not known at construction
+        if (!myLibrary)
+        {
+            std::filesystem::path cacheFile;
+            if (!ra2::save_directory.empty())
+            {
+                cacheFile = std::filesystem::path(ra2::save_directory) / DISK_LIBRARY_CACHE;
+            }
+            myLibrary = std::make_shared<common2::DiskLibrary>(cacheFile);
+        }
+        return *myLibrary;
+    }
+
     bool DiskControl::insertDisk(const std::string &path)
     {
         const bool writeProtected = IMAGE_FORCE_WRITE_PROTECTED;
         const bool createIfNecessary = IMAGE_DONT_CREATE;
 
-        if (insertFloppyDisk(path, writeProtected, createIfNecessary))
+        // a known hard disk image does not need to be tried as a floppy first
+        // (only the cache is consulted: an unknown image is indexed in the background, for next time)
+        common2::DiskLibraryEntry entry;
+        const bool isCached = getLibrary().lookupCached(path, entry);
+        if (!isCached)
+        {
+            getLibrary().scanInBackground({path});
+        }
+        const bool isHardDisk = isCached && entry.valid && !entry.floppy;
+
+        if (!isHardDisk && insertFloppyDisk(path, writeProtected, createIfNecessary))
         {
             myIndex = 0;
             myImages.clear();
@@ -155,6 +181,14 @@ namespace ra2
             }
         }
 
+        // index the playlist while the first image boots, so swapping disks finds them in the cache
+        std::vector<std::filesystem::path> imagePaths;
+        for (const DiskInfo &image : myImages)
+        {
+            imagePaths.emplace_back(image.path);
+        }
+        getLibrary().scanInBackground(imagePaths);
+
         // insert the first image by default
         myIndex = 0;
 
@@ -247,8 +281,12 @@ namespace ra2
             }
             else
             {
-                // inserted
-                result = insertFloppyDisk(
+                // inserted: the playlist is indexed in the background, so known bad images are not even opened
+                // (if it is not in the cache yet, it is just tried)
+                common2::DiskLibraryEntry entry;
+                const bool isFloppy =
+                    !getLibrary().lookupCached(myImages[myIndex].path, entry) || (entry.valid && entry.floppy);
+                result = isFloppy && insertFloppyDisk(
                     myImages[myIndex].path, myImages[myIndex].writeProtected, myImages[myIndex].createIfNecessary);
                 myEjected = !result;
                 ra2::log_cb(RETRO_LOG_INFO, "Insert new disk: %s -> %d\n", myImages[myIndex].path.c_str(), result);
@@ -1,11 +1,13 @@
 #pragma once
 
 #include "frontends/libretro/buffer.h"
+#include "frontends/common2/disklibrary.h"
 
 #include "Disk.h"
 
 #include <vector>
 #include <string>
+#include <memory>
 
 namespace ra2
 {
@@ -61,6 +63,9 @@ namespace ra2
         size_t myIndex;
         std::string myCurrentDiskFolder;
 
+        std::shared_ptr<common2::DiskLibrary> myLibrary;
+        common2::DiskLibrary &getLibrary();
+
         bool insertFloppyDisk(const std::string &path, const bool writeProtected, bool const createIfNecessary);
         bool insertHardDisk(const std::string &path);
         void storeCurrentDiskFolder(const std::string &path);
@@ -10,6 +10,8 @@
 
 #include "Registry.h"
 #include "Interface.h"
+#include "Core.h"
+#include "SaveState.h"
 
 #include "linux/keyboardbuffer.h"
 #include "linux/paddle.h"
@@ -17,6 +19,8 @@
 
 #include "libretro.h"
 
+#include <chrono>
+
 #define APPLEWIN_RETRO_CONF "/tmp/applewin.retro.conf"
 
 namespace
@@ -46,6 +50,10 @@ namespace ra2
         : myInputRemapper(supportsInputBitmasks)
         , myKeyboardType(KeyboardType::ASCII)
         , myMouseSpeed(1.0)
+        , myRunAhead(0)
+        , myRewinding(false)
+        , myRunAheadMicros(0.0)
+        , myRunAheadCount(0)
     {
         myLoggerContext = std::make_unique<LoggerContext>(true);
         myRegistry = createRetroRegistry();
@@ -55,6 +63,7 @@ namespace ra2
 
         common2::EmulatorOptions defaultOptions;
         defaultOptions.fixedSpeed = true;
+        defaultOptions.rewindBuffer = getRewindBuffer();
         myFrame = std::make_shared<ra2::RetroFrame>(defaultOptions);
 
         SetFrame(myFrame);
@@ -72,12 +81,67 @@ namespace ra2
         myFrame->ExecuteOneFrame(ourFrameTime);
     }
 
+    bool Game::beginRunAhead()
+    {
+        if (!myRunAhead || myRewinding || g_nAppMode != MODE_RUNNING)
+        {
+            return false;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        if (!Snapshot_SaveState(myRunAheadState))
+        {
+            myRunAhead = 0;
+            return false;
+        }
+        myRunAheadKeys = getKeyBuffer();
+
+        for (size_t i = 0; i < myRunAhead; ++i)
+        {
+            myFrame->ExecuteHiddenFrame(ourFrameTime);
+            // keep the audio buffers where they would be without run-ahead
+            ra2::writeAudio(FPS, SAMPLE_RATE, CHANNELS, myRunAheadAudio);
+        }
+
+        myRunAheadMicros +=
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    void Game::endRunAhead()
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        if (!Snapshot_LoadState(myRunAheadState.data(), myRunAheadState.size()))
+        {
+            myRunAhead = 0;
+        }
+        setKeyBuffer(myRunAheadKeys);
+
+        myRunAheadMicros +=
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        // so the user can choose how many frames the machine can afford
+        if (++myRunAheadCount == FPS * 10)
+        {
+            const double ms = myRunAheadMicros / myRunAheadCount / 1000.0;
+            log_cb(
+                RETRO_LOG_INFO,
+                "RA2: run-ahead of %" SIZE_T_FMT " frame(s) costs %.2f ms per frame (%.2f ms per frame ahead)\n",
+                myRunAhead, ms, ms / myRunAhead);
+            myRunAheadMicros = 0.0;
+            myRunAheadCount = 0;
+        }
+    }
+
     void Game::applyVariables()
     {
         applyRetroVariables(*this);
 
         myKeyboardType = getKeyboardEmulationType();
         myMouseSpeed = getMouseSpeed();
+        myRunAhead = getRunAhead();
     }
 
     void Game::updateVariables()
@@ -86,6 +150,7 @@ namespace ra2
         if (ra2::environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated)
         {
             applyVariables();
+            myFrame->SetRewindBuffer(getRewindBuffer());
 
             // apply video mode changes
             Video &video = GetVideo();
@@ -112,6 +177,8 @@ namespace ra2
     void Game::processInputEvents()
     {
         input_poll_cb();
+        myRewinding = input_state_cb(0, RETRO_DEVICE_KEYBOARD, 0, RETROK_PAGEUP);
+        myFrame->SetRewinding(myRewinding);
         for (size_t port = 0; port < MAX_PADS; ++port)
         {
             const unsigned device = ourInputDevices[port];
@@ -8,6 +8,7 @@
 #include "frontends/libretro/input/inputremapper.h"
 
 #include <memory>
+#include <queue>
 #include <string>
 #include <vector>
 
@@ -34,6 +35,10 @@ namespace ra2
 
         void updateVariables();
         void executeOneFrame();
+
+        // run-ahead: run more frames (not heard) before presenting, and undo them afterwards
+        bool beginRunAhead();
+        void endRunAhead();
         void processInputEvents();
         void writeAudio(const size_t fps, const size_t sampleRate, const size_t channels);
 
@@ -55,6 +60,8 @@ namespace ra2
     private:
         KeyboardType myKeyboardType;
         double myMouseSpeed;
+        size_t myRunAhead;
+        bool myRewinding;
 
         // keep them in this order!
         std::unique_ptr<LoggerContext> myLoggerContext;
@@ -71,6 +78,12 @@ namespace ra2
 
         std::vector<int16_t> myAudioBuffer;
 
+        std::vector<BYTE> myRunAheadState;
+        std::queue<BYTE> myRunAheadKeys;
+        std::vector<int16_t> myRunAheadAudio;
+        double myRunAheadMicros;
+        size_t myRunAheadCount;
+
         void keyboardEmulation();
         void applyVariables();
 
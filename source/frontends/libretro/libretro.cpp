@@ -293,8 +293,13 @@ void retro_run(void)
     ourGame->updateVariables();
     ourGame->processInputEvents();
     ourGame->executeOneFrame();
-    GetFrame().VideoPresentScreen();
     ourGame->writeAudio(ra2::Game::FPS, ra2::Game::SAMPLE_RATE, ra2::Game::CHANNELS);
+    const bool runAhead = ourGame->beginRunAhead();
+    GetFrame().VideoPresentScreen();
+    if (runAhead)
+    {
+        ourGame->endRunAhead();
+    }
 }
 
 bool retro_load_game(const retro_game_info *info)
@@ -316,6 +321,7 @@ bool retro_load_game(const retro_game_info *info)
         std::unique_ptr<ra2::Game> game = std::make_unique<ra2::Game>(supportsInputBitmasks);
 
         const std::string snapshotEnding = ".aws.yaml";
+        const std::string binarySnapshotEnding = ".aws.bin";
         const std::string playlistEnding = ".m3u";
 
         bool ok;
@@ -323,7 +329,7 @@ bool retro_load_game(const retro_game_info *info)
         if (info && info->path && *info->path)
         {
             const std::string gamePath = info->path;
-            if (endsWith(gamePath, snapshotEnding))
+            if (endsWith(gamePath, snapshotEnding) || endsWith(gamePath, binarySnapshotEnding))
             {
                 game->start(); // must happen before loading the snapshot!
                 ok = game->loadSnapshot(gamePath);
@@ -22,10 +22,11 @@ namespace
         bool isSameFormat(const size_t sampleRate, const size_t channels) const;
         void advanceOneFrame(const size_t fps);
 
+        // read and add to ptr, returns the number of bytes read
+        size_t readAndMix(const size_t bytesToRead, int16_t *ptr);
+
     private:
         std::vector<int16_t> myMixerBuffer;
-
-        void mixBuffer(const void *ptr, const size_t size);
     };
 
     std::unordered_set<DirectSoundGenerator *> activeSoundGenerators;
@@ -66,10 +67,7 @@ namespace
         const size_t bytesToRead = mySampleRate * bytesPerFrame / fps;
 
         // it does not matter if we read broken frames, this generator will never play sound
-
-        LPVOID lpvAudioPtr1, lpvAudioPtr2;
-        DWORD dwAudioBytes1, dwAudioBytes2;
-        Read(bytesToRead, &lpvAudioPtr1, &dwAudioBytes1, &lpvAudioPtr2, &dwAudioBytes2);
+        Read(bytesToRead, nullptr);
     }
 
     void mixBuffer(LinuxSoundBuffer *generator, LPVOID lpvAudioPtr, DWORD dwAudioBytes, int16_t *ptr)
@@ -96,6 +94,14 @@ namespace
         }
     }
 
+    size_t DirectSoundGenerator::readAndMix(const size_t bytesToRead, int16_t *ptr)
+    {
+        myMixerBuffer.resize(bytesToRead / sizeof(int16_t));
+        const size_t bytesRead = Read(bytesToRead, myMixerBuffer.data());
+        mixBuffer(this, myMixerBuffer.data(), bytesRead, ptr);
+        return bytesRead;
+    }
+
 } // namespace
 
 namespace ra2
@@ -156,16 +162,8 @@ namespace ra2
             const auto &generator = it;
             if (generator->isRunning() && generator->isSameFormat(sampleRate, channels))
             {
-                LPVOID lpvAudioPtr1, lpvAudioPtr2;
-                DWORD dwAudioBytes1, dwAudioBytes2;
-                const size_t bytesRead =
-                    generator->Read(bytesToRead, &lpvAudioPtr1, &dwAudioBytes1, &lpvAudioPtr2, &dwAudioBytes2);
+                const size_t bytesRead = generator->readAndMix(bytesToRead, buffer.data());
                 _ASSERT(bytesRead == bytesToRead);
-
-                int16_t *ptr = buffer.data();
-
-                mixBuffer(generator, lpvAudioPtr1, dwAudioBytes1, ptr);
-                mixBuffer(generator, lpvAudioPtr2, dwAudioBytes2, ptr);
             }
         }
         ra2::audio_batch_cb(buffer.data(), framesToRead);
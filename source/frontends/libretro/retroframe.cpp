@@ -28,48 +28,31 @@ namespace ra2
 
     void RetroFrame::VideoPresentScreen()
     {
-        // this should not be necessary
-        // either libretro handles it
-        // or we should change AW
-        // but for now, there is no alternative
-        for (size_t row = 0; row < myHeight; ++row)
-        {
-            const uint8_t *src = myFrameBuffer + row * myPitch;
-            uint8_t *dst = myVideoBuffer.data() + (myHeight - row - 1) * myPitch;
-            memcpy(dst, src, myPitch);
-        }
-
-        video_cb(myVideoBuffer.data() + myOffset, myBorderlessWidth, myBorderlessHeight, myPitch);
+        // the framebuffer is top-down: no need to copy it
+        video_cb(myFrameBuffer + myOffset, myBorderlessWidth, myBorderlessHeight, myPitch);
     }
 
     void RetroFrame::Initialize(bool resetVideoState)
     {
+        Video &video = GetVideo();
+        video.SetFrameBufferLayout(true);
+
         CommonFrame::Initialize(resetVideoState);
         FrameRefreshStatus(DRAW_TITLE);
 
-        Video &video = GetVideo();
-
         myBorderlessWidth = video.GetFrameBufferBorderlessWidth();
         myBorderlessHeight = video.GetFrameBufferBorderlessHeight();
-        const size_t borderWidth = video.GetFrameBufferBorderWidth();
-        const size_t borderHeight = video.GetFrameBufferBorderHeight();
-        const size_t width = video.GetFrameBufferWidth();
-        myHeight = video.GetFrameBufferHeight();
 
         myFrameBuffer = video.GetFrameBuffer();
 
-        myPitch = width * sizeof(bgra_t);
-        myOffset = (width * borderHeight + borderWidth) * sizeof(bgra_t);
-
-        const size_t size = myHeight * myPitch;
-        myVideoBuffer.resize(size);
+        myPitch = video.GetFrameBufferPitch() * sizeof(bgra_t);
+        myOffset = video.GetFrameBufferScanLineOffset(0) * sizeof(bgra_t);
     }
 
     void RetroFrame::Destroy()
     {
         CommonFrame::Destroy();
         myFrameBuffer = nullptr;
-        myVideoBuffer.clear();
     }
 
     int RetroFrame::FrameMessageBox(LPCSTR lpText, LPCSTR lpCaption, UINT uType)
@@ -89,6 +72,11 @@ namespace ra2
         return false;
     }
 
+    void RetroFrame::ExecuteHiddenFrame(const int64_t microseconds)
+    {
+        ExecuteInRunningMode(microseconds);
+    }
+
     void RetroFrame::Begin()
     {
         const common2::RestoreCurrentDirectory restoreChDir;
@@ -2,8 +2,6 @@
 
 #include "frontends/common2/gnuframe.h"
 
-#include <vector>
-
 namespace ra2
 {
 
@@ -19,6 +17,9 @@ namespace ra2
         void Begin() override;
         int FrameMessageBox(LPCSTR lpText, LPCSTR lpCaption, UINT uType) override;
 
+        // a frame which is going to be undone (run-ahead): not recorded in the rewind history
+        void ExecuteHiddenFrame(const int64_t microseconds);
+
         std::shared_ptr<SoundBuffer> CreateSoundBuffer(
             uint32_t dwBufferSize, uint32_t nSampleRate, int nChannels, const char *pszVoiceName) override;
 
@@ -27,11 +28,8 @@ namespace ra2
         virtual bool CanDoFullSpeed() override;
 
     private:
-        std::vector<uint8_t> myVideoBuffer;
-
         size_t myPitch;
         size_t myOffset;
-        size_t myHeight;
         size_t myBorderlessWidth;
         size_t myBorderlessHeight;
         uint8_t *myFrameBuffer;
@@ -23,6 +23,8 @@ namespace
     const char *REGVALUE_KEYBOARD_TYPE = "Keyboard type";
     const char *REGVALUE_PLAYLIST_START = "Playlist start";
     const char *REGVALUE_MOUSE_SPEED_00 = "Mouse speed";
+    const char *REGVALUE_REWIND_BUFFER = "Rewind buffer";
+    const char *REGVALUE_RUN_AHEAD = "Run ahead";
 
     const char *CATEGORY_SYSTEM = "system";
     const char *CATEGORY_INPUT = "input";
@@ -285,6 +287,37 @@ namespace
             REG_RA2,
             REGVALUE_PLAYLIST_START,
         },
+        {
+            {
+                "rewind",
+                "Rewind History (hold Page Up)",
+                CATEGORY_SYSTEM,
+                {
+                    {"Off", 0},
+                    {"16 MB", 16},
+                    {"64 MB", 64},
+                    {"256 MB", 256},
+                },
+            },
+            REG_RA2,
+            REGVALUE_REWIND_BUFFER,
+        },
+        {
+            {
+                "run_ahead",
+                "Run-Ahead Frames (cost per frame in the log)",
+                CATEGORY_SYSTEM,
+                {
+                    {"Off", 0},
+                    {"1", 1},
+                    {"2", 2},
+                    {"3", 3},
+                    {"4", 4},
+                },
+            },
+            REG_RA2,
+            REGVALUE_RUN_AHEAD,
+        },
         {
             {
                 "keyboard_type",
@@ -561,4 +594,18 @@ namespace ra2
         return value / 100.0;
     }
 
+    size_t getRewindBuffer()
+    {
+        uint32_t value = 0;
+        RegLoadValue(REG_RA2, REGVALUE_REWIND_BUFFER, TRUE, &value);
+        return value;
+    }
+
+    size_t getRunAhead()
+    {
+        uint32_t value = 0;
+        RegLoadValue(REG_RA2, REGVALUE_RUN_AHEAD, TRUE, &value);
+        return value;
+    }
+
 } // namespace ra2
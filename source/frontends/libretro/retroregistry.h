@@ -24,5 +24,7 @@ namespace ra2
     KeyboardType getKeyboardEmulationType();
     PlaylistStartDisk getPlaylistStartDisk();
     double getMouseSpeed();
+    size_t getRewindBuffer(); // MB
+    size_t getRunAhead();     // frames
 
 } // namespace ra2
@@ -4,56 +4,16 @@
 #include "frontends/libretro/serialisation.h"
 #include "frontends/libretro/diskcontrol.h"
 
-#include <cstdio>
-#include <fstream>
-#include <unistd.h>
+#include <cstring>
 
 namespace
 {
-    class AutoFile
-    {
-    public:
-        AutoFile();
-        ~AutoFile();
-
-        const std::string &getFilename() const; // only if true
-
-    protected:
-        int myFD;
-        std::string myFilename;
-    };
-
-    AutoFile::AutoFile()
-    {
-#ifdef _WIN32
-        char pattern[] = "/tmp/awXXXXXX";
-        myFD = mkstemp(pattern);
-#else
-        char pattern[] = "/tmp/awXXXXXX.aws.yaml";
-        myFD = mkstemps(pattern, 9);
-#endif
-        if (myFD <= 0)
-        {
-            throw std::runtime_error("Cannot create temporary file");
-        }
-        myFilename = pattern;
-    }
-
-    AutoFile::~AutoFile()
-    {
-        close(myFD);
-        std::remove(myFilename.c_str());
-    }
 
-    const std::string &AutoFile::getFilename() const
+    // reused every frame (netplay, run-ahead)
+    std::vector<BYTE> &getStateBuffer()
     {
-        return myFilename;
-    }
-
-    void saveToFile(const std::string &filename) // cannot be null!
-    {
-        Snapshot_SetFilename(filename);
-        Snapshot_SaveState();
+        static std::vector<BYTE> state;
+        return state;
     }
 
 } // namespace
@@ -63,18 +23,11 @@ namespace ra2
 
     size_t RetroSerialisation::getSize()
     {
-        AutoFile autoFile;
-        std::string const &filename = autoFile.getFilename();
-        saveToFile(filename);
-        std::ifstream ifs(filename, std::ios::binary | std::ios::ate);
-
-        const size_t fileSize = ifs.tellg();
         // we add a buffer to include a few things
         // DiscControl images
         // various sizes
-        // small variations in AW yaml format
         const size_t buffer = 4096;
-        return fileSize + buffer;
+        return Snapshot_GetSizeBound() + buffer;
     }
 
     void RetroSerialisation::serialise(void *data, size_t size, const DiskControl &diskControl)
@@ -82,19 +35,17 @@ namespace ra2
         Buffer buffer(reinterpret_cast<char *>(data), size);
         diskControl.serialise(buffer);
 
-        AutoFile autoFile;
-        std::string const &filename = autoFile.getFilename();
-        saveToFile(filename);
-        std::ifstream ifs(filename, std::ios::binary | std::ios::ate);
+        std::vector<BYTE> &state = getStateBuffer();
+        if (!Snapshot_SaveState(state))
+        {
+            throw std::runtime_error("Cannot save state");
+        }
 
-        size_t const fileSize = ifs.tellg();
-        buffer.get<size_t>() = fileSize;
+        buffer.get<size_t>() = state.size();
 
         char *begin, *end;
-        buffer.get(fileSize, begin, end);
-
-        ifs.seekg(0, std::ios::beg);
-        ifs.read(begin, end - begin);
+        buffer.get(state.size(), begin, end);
+        memcpy(begin, state.data(), state.size());
     }
 
     void RetroSerialisation::deserialise(const void *data, size_t size, DiskControl &diskControl)
@@ -102,22 +53,17 @@ namespace ra2
         Buffer buffer(reinterpret_cast<const char *>(data), size);
         diskControl.deserialise(buffer);
 
-        const size_t fileSize = buffer.get<size_t const>();
+        const size_t stateSize = buffer.get<size_t const>();
 
-        AutoFile autoFile;
-        std::string const &filename = autoFile.getFilename();
-        // do not remove the {} scope below! it ensures the file is flushed
-        {
-            char const *begin, *end;
-            buffer.get(fileSize, begin, end);
-            std::ofstream ofs(filename, std::ios::binary);
-            ofs.write(begin, end - begin);
-        }
+        char const *begin, *end;
+        buffer.get(stateSize, begin, end);
 
         // bit of a workaround, since the state files do not have full disk paths
         SetCurrentDirectory(diskControl.getCurrentDiskFolder().c_str());
-        Snapshot_SetFilename(filename);
-        Snapshot_LoadState();
+        if (!Snapshot_LoadState(reinterpret_cast<const BYTE *>(begin), end - begin))
+        {
+            throw std::runtime_error("Cannot load state");
+        }
     }
 
 } // namespace ra2
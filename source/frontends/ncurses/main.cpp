@@ -4,15 +4,18 @@
 
 #include "CardManager.h"
 #include "Core.h"
+#include "PerfCounters.h"
 #include "SaveState.h"
 #include "Utilities.h"
 
 #include "linux/benchmark.h"
 #include "linux/context.h"
+#include "linux/inputrecorder.h"
 #include "frontends/common2/fileregistry.h"
 #include "frontends/common2/programoptions.h"
 #include "frontends/common2/argparser.h"
 #include "frontends/common2/commoncontext.h"
+#include "frontends/common2/timer.h"
 #include "frontends/ncurses/world.h"
 #include "frontends/ncurses/nframe.h"
 #include "frontends/ncurses/evdevpaddle.h"
@@ -28,12 +31,18 @@ namespace
         {
         case KEY_F(2):
         {
-            ResetMachineState();
+            if (InputRecorder::instance().onResetMachine())
+            {
+                ResetMachineState();
+            }
             break;
         }
         case 278: // Shift-F2
         {
-            CtrlReset();
+            if (InputRecorder::instance().onCtrlReset())
+            {
+                CtrlReset();
+            }
             break;
         }
         case KEY_F(3):
@@ -82,6 +91,7 @@ namespace
 
         if (!options.headless)
         {
+            const PerfMarker perfMarker(PERF_PRESENT);
             if (g_bFullSpeed)
             {
                 frame.VideoPresentScreen();
@@ -91,6 +101,8 @@ namespace
                 frame.SyncVideoPresentScreen(oneFrameMicros);
             }
         }
+
+        PerfCounters_EndFrame();
     }
 
     void EnterMessageLoop(const common2::EmulatorOptions &options, na2::NFrame &frame)
@@ -114,6 +126,7 @@ namespace
         const bool run = getEmulatorOptions(argc, argv, common2::OptionsType::applen, "ncurses", options);
         options.fixedSpeed = true; // TODO: remove, some testing required
         options.syncWithTimer = true;
+        options.videoRaster = false; // the terminal is drawn from the video memory, pixels are never used
 
         if (!run)
             return 1;
@@ -123,23 +136,35 @@ namespace
         const std::shared_ptr<na2::EvDevPaddle> paddle = std::make_shared<na2::EvDevPaddle>(options.paddleDeviceName);
         const std::shared_ptr<na2::NFrame> frame = std::make_shared<na2::NFrame>(options, paddle);
 
-        const common2::CommonInitialisation init(frame, paddle, options);
+        {
+            const common2::CommonInitialisation init(frame, paddle, options);
 
-        // no audio in the ncurses frontend
-        g_bDisableDirectSound = true;
-        g_bDisableDirectSoundMockingboard = true;
-        na2::SetCtrlCHandler(options.headless);
+            // no audio in the ncurses frontend
+            g_bDisableDirectSound = true;
+            g_bDisableDirectSoundMockingboard = true;
+            na2::SetCtrlCHandler(options.headless);
 
-        if (options.benchmark)
-        {
-            const auto redraw = [&frame]() { frame->VideoRedrawScreen(); };
-            VideoBenchmark(redraw, redraw);
-        }
-        else
-        {
-            EnterMessageLoop(options, *frame);
+            if (options.benchmark)
+            {
+                const auto redraw = [&frame]() { frame->VideoRedrawScreen(); };
+                VideoBenchmark(redraw, redraw);
+                SnapshotBenchmark();
+            }
+            else if (!options.convertSnapshotFilename.empty())
+            {
+                // the snapshot has been loaded by CommonInitialisation
+                Snapshot_SetFilename(options.convertSnapshotFilename);
+                Snapshot_SaveState();
+            }
+            else
+            {
+                EnterMessageLoop(options, *frame);
+            }
         }
 
+        // once ncurses has restored the terminal
+        common2::printPerfCounters(std::cerr);
+
         return 0;
     }
 
@@ -38,18 +38,27 @@ void AudioInfo::updateInfo(const qint64 speed, const qint64 target)
     QString s;
     s.reserve(1024); // empirically, enough for 2 MBs
 
-    s += "Voice   Channels  State  Volume  Buffer  Underruns\n";
+    s += "Voice   Channels  State  Volume  Buffer  Underruns  Overruns  Target  Latency  Correction\n";
     for (const auto &i : info)
     {
         if (i.running)
         {
-            s += QString("%1    %2      %3     %4    %5   %6\n")
+            s += QString("%1    %2      %3     %4    %5   %6   %7")
                      .arg(QString(i.voiceName.c_str()), -10)
                      .arg(i.channels, 2)
                      .arg(i.state)
                      .arg(i.volume, 3)
                      .arg(i.buffer, 4)
-                     .arg(i.numberOfUnderruns, 8);
+                     .arg(i.numberOfUnderruns, 8)
+                     .arg(i.numberOfOverruns, 8);
+            if (i.controlled)
+            {
+                s += QString("    %1     %2     %3%")
+                         .arg(i.target, 4)
+                         .arg(i.latency, 4)
+                         .arg(i.correction * 100, 6, 'f', 2);
+            }
+            s += "\n";
         }
     }
     s += QString("\nspeed                = %1\n").arg(speed, 10);
@@ -30,6 +30,7 @@ namespace
     const QString REG_GAMEPAD_NAME = QString::fromUtf8("QApple/Hardware/Gamepad/Name");
     const QString REG_GAMEPAD_SQUARING = QString::fromUtf8("QApple/Hardware/Gamepad/Squaring");
     const QString REG_AUDIO_BUFFER = QString::fromUtf8("QApple/Audio/Buffer");
+    const QString REG_AUDIO_LATENCY = QString::fromUtf8("QApple/Audio/Latency");
     const QString REG_VOLUME = QString::fromUtf8("QApple/Audio/Volume");
     const QString REG_TIMER = QString::fromUtf8("QApple/Emulator/Timer");
     const QString REG_FULL_SPEED = QString::fromUtf8("QApple/Emulator/Full Speed");
@@ -111,6 +112,7 @@ GlobalOptions GlobalOptions::fromQSettings()
     options.msFullSpeed = settings.value(REG_FULL_SPEED, 5).toInt();
 
     options.msAudioBuffer = settings.value(REG_AUDIO_BUFFER, 100).toInt();
+    options.msAudioLatency = settings.value(REG_AUDIO_LATENCY, 0).toInt();
 
     return options;
 }
@@ -164,6 +166,12 @@ void GlobalOptions::setData(const GlobalOptions &data)
         this->msAudioBuffer = data.msAudioBuffer;
         QSettings().setValue(REG_AUDIO_BUFFER, this->msAudioBuffer);
     }
+
+    if (this->msAudioLatency != data.msAudioLatency)
+    {
+        this->msAudioLatency = data.msAudioLatency;
+        QSettings().setValue(REG_AUDIO_LATENCY, this->msAudioLatency);
+    }
 }
 
 void getAppleWinPreferences(PreferenceData &data)
@@ -25,6 +25,7 @@ public:
     int msFullSpeed;
 
     int msAudioBuffer;
+    int msAudioLatency; // 0 = AppleWin's heuristic
 
     void setData(const GlobalOptions &data);
 };
@@ -212,6 +212,7 @@ void Preferences::setData(const PreferenceData &data)
     ui->squareCircle->setChecked(data.options.gamepadSquaring);
     ui->screenshot->setText(data.options.screenshotTemplate);
     ui->audio_buffer->setValue(data.options.msAudioBuffer);
+    ui->audio_latency->setValue(data.options.msAudioLatency);
 
     ui->speaker_volume->setValue(ui->speaker_volume->maximum() - data.speakerVolume);
     ui->mb_volume->setValue(ui->mb_volume->maximum() - data.mockingboardVolume);
@@ -259,6 +260,7 @@ PreferenceData Preferences::getData() const
     data.options.msFullSpeed = ui->full_ms->value();
     data.options.screenshotTemplate = ui->screenshot->text();
     data.options.msAudioBuffer = ui->audio_buffer->value();
+    data.options.msAudioLatency = ui->audio_latency->value();
 
     // because index = 0 is None
     if (ui->joystick->currentIndex() >= 1)
@@ -10,10 +10,12 @@
 #include "NTSC.h"
 #include "SaveState.h"
 #include "Speaker.h"
+#include "SoundCore.h"
 
 #include "linux/benchmark.h"
 #include "linux/version.h"
 #include "linux/context.h"
+#include "linux/keyboardbuffer.h"
 
 #include "emulator.h"
 #include "memorycontainer.h"
@@ -209,7 +211,8 @@ void QApple::on_timer()
         // in case we run more than 1 frame
         g_dwCyclesThisFrame = g_dwCyclesThisFrame % dwClksPerFrame;
         ++count;
-    } while (cardManager.GetDisk2CardMgr().IsConditionForFullSpeed() && (myElapsedTimer.elapsed() < wallclockTargetMS));
+    } while ((cardManager.GetDisk2CardMgr().IsConditionForFullSpeed() || isPasting()) &&
+             (myElapsedTimer.elapsed() < wallclockTargetMS));
 
     // just repaint each time, to make it simpler
     // we run @ 60 fps anyway
@@ -345,6 +348,7 @@ void QApple::reloadOptions()
     Paddle::setSquaring(myOptions.gamepadSquaring);
 #endif
     QDirectSound::setOptions(myOptions.msAudioBuffer);
+    SoundCore_SetTargetLatency(myOptions.msAudioLatency);
 }
 
 void QApple::on_actionSave_state_triggered()
@@ -4,6 +4,7 @@
 
 #include "loggingcategory.h"
 #include "linux/linuxsoundbuffer.h"
+#include "SoundCore.h"
 #include <unordered_set>
 #include <memory>
 
@@ -148,24 +149,7 @@ namespace
 
     qint64 DirectSoundGenerator::readData(char *data, qint64 maxlen)
     {
-        LPVOID lpvAudioPtr1, lpvAudioPtr2;
-        DWORD dwAudioBytes1, dwAudioBytes2;
-
-        const size_t bytesRead = Read(maxlen, &lpvAudioPtr1, &dwAudioBytes1, &lpvAudioPtr2, &dwAudioBytes2);
-
-        char *dest = data;
-        if (lpvAudioPtr1 && dwAudioBytes1)
-        {
-            memcpy(dest, lpvAudioPtr1, dwAudioBytes1);
-            dest += dwAudioBytes1;
-        }
-        if (lpvAudioPtr2 && dwAudioBytes2)
-        {
-            memcpy(dest, lpvAudioPtr2, dwAudioBytes2);
-            dest += dwAudioBytes2;
-        }
-
-        return bytesRead;
+        return Read(maxlen, data);
     }
 
     QDirectSound::SoundInfo DirectSoundGenerator::getInfo()
@@ -175,6 +159,7 @@ namespace
         info.running = QIODevice::isOpen();
         info.channels = myChannels;
         info.numberOfUnderruns = GetBufferUnderruns();
+        info.numberOfOverruns = GetBufferOverruns();
         info.volume = int(100 * GetLogarithmicVolume());
         info.state = myAudioOutput->state();
 
@@ -186,6 +171,15 @@ namespace
             info.size = format.durationForBytes(myBufferSize) / 1000;
         }
 
+        SoundLatencyController::Stats stats;
+        if (SoundCore_GetTargetLatency() && SoundCore_GetLatencyStats(this, stats))
+        {
+            info.controlled = true;
+            info.target = int(stats.targetMs);
+            info.latency = int(stats.latencyMs);
+            info.correction = stats.correction;
+        }
+
         return info;
     }
 
@@ -25,6 +25,13 @@ namespace QDirectSound
         int volume = 0; // 0 - 100
 
         size_t numberOfUnderruns = 0;
+        size_t numberOfOverruns = 0;
+
+        // latency controller, if enabled (see SoundCore_SetTargetLatency)
+        bool controlled = false;
+        int target = 0;        // ms
+        int latency = 0;       // ms
+        double correction = 0; // relative
     };
 
     std::shared_ptr<SoundBuffer> iCreateDirectSoundBuffer(
@@ -2,6 +2,8 @@
 
 #include <QPainter>
 #include <QKeyEvent>
+#include <QClipboard>
+#include <QGuiApplication>
 
 #include "StdAfx.h"
 #include "linux/keyboardbuffer.h"
@@ -141,6 +143,13 @@ void QVideo::keyPressEvent(QKeyEvent *event)
         }
     }
 
+    if (key == Qt::Key_Insert && event->modifiers() == Qt::ShiftModifier)
+    {
+        const QByteArray text = QGuiApplication::clipboard()->text().toLatin1();
+        pasteTextToBuffer(text.constData());
+        return;
+    }
+
     BYTE ch = 0;
 
     switch (key)
@@ -0,0 +1,107 @@
+#include "StdAfx.h"
+#include "frontends/sdl/emulationthread.h"
+#include "frontends/sdl/sdlframe.h"
+
+#include "Core.h"
+
+#include <ostream>
+
+namespace sa2
+{
+
+    EmulationThread::EmulationThread(SDLFrame &frame, const int64_t microseconds)
+        : myFrame(frame)
+        , myMicroseconds(microseconds)
+        , myStop(false)
+        , myRenderWaiting(0)
+    {
+    }
+
+    EmulationThread::~EmulationThread()
+    {
+        stop();
+    }
+
+    void EmulationThread::start()
+    {
+        myStop = false;
+        myThread = std::thread(&EmulationThread::run, this);
+    }
+
+    void EmulationThread::stop()
+    {
+        myStop = true;
+        if (myThread.joinable())
+        {
+            myThread.join();
+        }
+    }
+
+    std::unique_lock<std::recursive_mutex> EmulationThread::lock()
+    {
+        ++myRenderWaiting;
+        std::unique_lock<std::recursive_mutex> guard(myMutex);
+        --myRenderWaiting;
+        return guard;
+    }
+
+    void EmulationThread::run()
+    {
+        std::chrono::time_point<std::chrono::steady_clock> next = std::chrono::steady_clock::now();
+
+        while (!myStop)
+        {
+            myFrameTimer.tic();
+
+            // std::mutex is not fair, and at full speed we would take it back straight away
+            while (myRenderWaiting && !myStop)
+            {
+                std::this_thread::yield();
+            }
+
+            bool fullSpeed;
+            {
+                myWaitTimer.tic();
+                const std::lock_guard<std::recursive_mutex> guard(myMutex);
+                myWaitTimer.toc();
+
+                myCpuTimer.tic();
+                myFrame.ExecuteOneFrame(myMicroseconds);
+                fullSpeed = g_bFullSpeed;
+                if (fullSpeed)
+                {
+                    myFrame.RedrawScreenDuringFullSpeed();
+                }
+                else
+                {
+                    // on this thread, it does not render: complete frames are published by VideoSwapFrameBuffer()
+                    myFrame.VideoPresentScreen();
+                }
+                myCpuTimer.toc();
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            if (fullSpeed)
+            {
+                next = now;
+            }
+            else
+            {
+                // if we are late, do not try to catch up: Speed adapts the number of cycles
+                next = std::max(now, next + std::chrono::microseconds(myMicroseconds));
+                std::this_thread::sleep_until(next);
+            }
+
+            myFrameTimer.toc();
+        }
+    }
+
+    void EmulationThread::printStats(std::ostream &os) const
+    {
+        os << "Emulation thread" << std::endl;
+        os << "Frame:   " << myFrameTimer << std::endl;
+        os << "Wait:    " << myWaitTimer << std::endl;
+        os << "CPU:     " << myCpuTimer << std::endl;
+    }
+
+} // namespace sa2
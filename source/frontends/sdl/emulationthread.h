@@ -0,0 +1,49 @@
+#pragma once
+
+#include "frontends/common2/timer.h"
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <iosfwd>
+
+namespace sa2
+{
+
+    class SDLFrame;
+
+    // Runs SDLFrame::ExecuteOneFrame() on its own thread, paced by the clock instead of the GL swap.
+    // The emulator is not thread safe: the render thread must hold lock() while it touches it
+    // (events, settings, debugger); the emulation thread holds it while it executes a frame.
+    // Finished frames are handed to the render thread by SDLFrame (see SDLFrame::VideoSwapFrameBuffer()).
+    class EmulationThread
+    {
+    public:
+        EmulationThread(SDLFrame &frame, const int64_t microseconds);
+        ~EmulationThread();
+
+        void start();
+        void stop();
+
+        // the render thread takes precedence: the emulation thread waits before it runs the next frame
+        std::unique_lock<std::recursive_mutex> lock();
+
+        void printStats(std::ostream &os) const;
+
+    private:
+        void run();
+
+        SDLFrame &myFrame;
+        const int64_t myMicroseconds;
+
+        std::thread myThread;
+        std::recursive_mutex myMutex;
+        std::atomic<bool> myStop;
+        std::atomic<int> myRenderWaiting;
+
+        common2::Timer myFrameTimer;
+        common2::Timer myWaitTimer;
+        common2::Timer myCpuTimer;
+    };
+
+} // namespace sa2
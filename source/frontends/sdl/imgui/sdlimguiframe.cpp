@@ -160,7 +160,8 @@ namespace sa2
 
     void SDLImGuiFrame::UpdateTexture()
     {
-        loadTextureFromData(myTexture, myFramebuffer.data() + myOffset, myBorderlessWidth, myBorderlessHeight, myPitch);
+        loadTextureFromData(
+            myTexture, GetFramebufferToPresent() + myOffset, myBorderlessWidth, myBorderlessHeight, myPitch);
     }
 
     void SDLImGuiFrame::ClearBackground()
@@ -228,25 +229,35 @@ namespace sa2
 
     void SDLImGuiFrame::VideoPresentScreen()
     {
+        if (HandOverFramebuffer())
+        {
+            return;
+        }
+
         // this is NOT REENTRANT
         // the debugger (executed via mySettings.show(this)) might call it recursively
         if (!myPresenting)
         {
             myPresenting = true;
-            ImGui_ImplOpenGL3_NewFrame();
-            ImGui_ImplSDLX_NewFrame();
-            ImGui::NewFrame();
-
-            if (!myShowMouseCursor)
             {
-                ImGui::SetMouseCursor(ImGuiMouseCursor_None);
-            } // otherwise leave it to the default set in ImGui::NewFrame();
+                // the settings and the debugger access the emulator, but swapping does not
+                const auto lock = LockEmulator();
 
-            // "this" is a bit circular
-            mySettings.show(this, myDebuggerFont);
-            DrawAppleVideo();
+                ImGui_ImplOpenGL3_NewFrame();
+                ImGui_ImplSDLX_NewFrame();
+                ImGui::NewFrame();
 
-            ImGui::Render();
+                if (!myShowMouseCursor)
+                {
+                    ImGui::SetMouseCursor(ImGuiMouseCursor_None);
+                } // otherwise leave it to the default set in ImGui::NewFrame();
+
+                // "this" is a bit circular
+                mySettings.show(this, myDebuggerFont);
+                DrawAppleVideo();
+
+                ImGui::Render();
+            }
             ClearBackground();
             ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
             SDL_GL_SwapWindow(myWindow.get());
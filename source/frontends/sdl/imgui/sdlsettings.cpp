@@ -4,6 +4,7 @@
 #include "frontends/sdl/processfile.h"
 #include "frontends/sdl/sdirectsound.h"
 #include "frontends/sdl/sdlframe.h"
+#include "frontends/common2/rewind.h"
 #include "linux/registryclass.h"
 #include "linux/version.h"
 #include "linux/cassettetape.h"
@@ -11,11 +12,14 @@
 
 #include "Interface.h"
 #include "CardManager.h"
+#include "DiskImage.h"
 #include "Speaker.h"
+#include "SoundCore.h"
 #include "Registry.h"
 #include "Utilities.h"
 #include "Memory.h"
 #include "ParallelPrinter.h"
+#include "PerfCounters.h"
 #include "SaveState.h"
 #include "Uthernet2.h"
 #include "CopyProtectionDongles.h"
@@ -43,6 +47,7 @@ namespace
         {"F6", "Fullscreen", "2x", nullptr, "50 scan lines"},
         {"F8", "Settings"},
         {"F9", "Cycle video type", "Toggle mouse cursor"},
+        {"F10", "Rewind (hold)"},
         {"F11", "Save snapshot"},
         {"F12", "Load snapshot"},
     };
@@ -185,6 +190,32 @@ namespace sa2
                     {
                         frame->LoadSnapshot();
                     }
+                    ImGui::SameLine();
+                    bool compress = Snapshot_GetCompress();
+                    if (ImGui::Checkbox("Compress", &compress))
+                    {
+                        Snapshot_SetCompress(compress);
+                        REGSAVE(REGVALUE_SAVE_STATE_COMPRESS, (uint32_t)compress);
+                    }
+                    ImGui::SameLine();
+                    HelpMarker("Snapshots ending in .aws.bin are saved in binary: zlib compress their memory.");
+
+                    const std::shared_ptr<common2::Rewind> &rewind = frame->GetRewind();
+                    bool rewindEnabled = !!rewind;
+                    if (ImGui::Checkbox("Rewind F10", &rewindEnabled))
+                    {
+                        frame->SetRewindBuffer(rewindEnabled ? common2::Rewind::ourDefaultBudget / (1024 * 1024) : 0);
+                    }
+                    ImGui::SameLine();
+                    HelpMarker("Hold F10 to step back in time.");
+                    if (rewind)
+                    {
+                        const common2::Rewind::Stats stats = rewind->getStats();
+                        ImGui::SameLine();
+                        ImGui::Text(
+                            "%.1f s, %.1f MB, capture %.0f us, restore %.1f ms", stats.seconds,
+                            stats.memory / (1024.0 * 1024.0), stats.captureUs, stats.restoreUs / 1000.0);
+                    }
                     ImGui::Separator();
 
                     if (frame->HardwareChanged())
@@ -210,7 +241,7 @@ namespace sa2
                     ImGui::SameLine();
                     if (ImGui::Button("CtrlReset"))
                     {
-                        CtrlReset();
+                        frame->FrameCtrlReset();
                     }
 
                     ImGui::EndTabItem();
@@ -266,6 +297,81 @@ namespace sa2
                     ImGui::EndTabItem();
                 }
 
+                if (ImGui::BeginTabItem("Performance"))
+                {
+                    bool perfCounters = g_bPerfCounters;
+                    if (ImGui::Checkbox("Measure", &perfCounters))
+                    {
+                        PerfCounters_Enable(perfCounters);
+                    }
+                    ImGui::SameLine();
+                    HelpMarker("Time spent in each subsystem, per frame. Nested subsystems (e.g. Video in CPU) are not "
+                               "counted twice. Select a row to see its histogram.");
+                    ImGui::SameLine();
+                    if (ImGui::Button("Reset"))
+                    {
+                        PerfCounters_Reset();
+                    }
+
+                    const UINT64 frames = PerfCounters_GetFrames();
+                    const double wallTime = PerfCounters_GetWallTime() * 0.000001;
+                    ImGui::Text("Frames: %.0f, mean frame: %.2f ms", double(frames), frames ? wallTime / frames : 0.0);
+
+                    PerfCounterStats stats;
+                    if (ImGui::BeginTable("Counters", 6, ImGuiTableFlags_RowBg))
+                    {
+                        ImGui::TableSetupColumn("Subsystem");
+                        ImGui::TableSetupColumn("Last (ms)");
+                        ImGui::TableSetupColumn("Mean (ms)");
+                        ImGui::TableSetupColumn("Max (ms)");
+                        ImGui::TableSetupColumn("%");
+                        ImGui::TableSetupColumn("Last frames", ImGuiTableColumnFlags_WidthStretch);
+                        ImGui::TableHeadersRow();
+
+                        float history[PERF_HISTORY_SIZE];
+                        for (int i = 0; i < PERF_NUM_COUNTERS; ++i)
+                        {
+                            const PerfCounterID id = PerfCounterID(i);
+                            PerfCounters_GetStats(id, stats);
+                            PerfCounters_GetHistory(id, history);
+                            const double total = stats.total * 0.000001;
+
+                            ImGui::TableNextRow();
+                            ImGui::PushID(i);
+                            ImGui::TableNextColumn();
+                            if (ImGui::Selectable(
+                                    PerfCounters_GetName(id), myPerfCounter == i, ImGuiSelectableFlags_SpanAllColumns))
+                            {
+                                myPerfCounter = i;
+                            }
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%6.2f", stats.last * 0.000001);
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%6.2f", frames ? total / frames : 0.0);
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%6.2f", stats.max * 0.000001);
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%5.1f", wallTime > 0 ? 100.0 * total / wallTime : 0.0);
+                            ImGui::TableNextColumn();
+                            ImGui::PlotLines("##History", history, PERF_HISTORY_SIZE, 0, nullptr, 0.0f, FLT_MAX, ImVec2(-1, 0));
+                            ImGui::PopID();
+                        }
+
+                        ImGui::EndTable();
+                    }
+
+                    const PerfCounterID selected = PerfCounterID(myPerfCounter);
+                    ImGui::SeparatorText(PerfCounters_GetName(selected));
+                    PerfCounters_GetStats(selected, stats);
+                    float histogram[PERF_HISTOGRAM_BINS];
+                    std::copy(stats.histogram, stats.histogram + PERF_HISTOGRAM_BINS, histogram);
+                    ImGui::PlotHistogram(
+                        "##Histogram", histogram, PERF_HISTOGRAM_BINS, 0, nullptr, 0.0f, FLT_MAX, ImVec2(-1, 80));
+                    ImGui::TextUnformatted("Frames per time spent: < 1 us, 1 us, 2 us, 4 us ... >= 65 ms");
+
+                    ImGui::EndTabItem();
+                }
+
                 if (ImGui::BeginTabItem("Hardware"))
                 {
                     ImGui::LabelText("Option", "Value");
@@ -377,6 +483,39 @@ namespace sa2
                         REGSAVE(REGVALUE_ENHANCE_DISK_SPEED, (uint32_t)enhancedSpeed);
                     }
 
+                    bool fastLoad = cardManager.GetDisk2CardMgr().GetFastLoad();
+                    if (ImGui::Checkbox("Fast load (RWTS/ProDOS)", &fastLoad))
+                    {
+                        cardManager.GetDisk2CardMgr().SetFastLoad(fastLoad);
+                        REGSAVE(REGVALUE_DISK_FAST_LOAD, (uint32_t)fastLoad);
+                    }
+
+                    bool overlay = ImageGetOverlay();
+                    if (ImGui::Checkbox("Copy-on-write overlay", &overlay))
+                    {
+                        ImageSetOverlay(overlay);
+                        REGSAVE(REGVALUE_DISK_IMAGE_OVERLAY, (uint32_t)overlay);
+                    }
+                    ImGui::SameLine();
+                    HelpMarker("Never write to disk images: changes go to a journal, per session.\n"
+                               "Applies to images inserted afterwards.");
+
+                    // with EnterReturnsTrue ImGui keeps the text being edited: the buffer is only written on Enter
+                    char session[64];
+                    strncpy(session, ImageGetOverlaySession().c_str(), sizeof(session) - 1);
+                    session[sizeof(session) - 1] = 0;
+                    if (ImGui::InputText("Overlay session", session, sizeof(session), ImGuiInputTextFlags_EnterReturnsTrue))
+                    {
+                        if (ImageSetOverlaySession(session))
+                        {
+                            RegSaveString(REG_CONFIG, REGVALUE_DISK_IMAGE_OVERLAY_SESSION, 1, session);
+                        }
+                    }
+                    ImGui::SameLine();
+                    HelpMarker("Changes are kept in <image>.<session>.journal (delete it to discard them), and a session "
+                               "is used by one emulator at a time (no '/', '\\' or '..').\n"
+                               "Empty: changes are only kept in memory, until the image is ejected.");
+
                     ImGui::Separator();
 
                     size_t dragAndDropSlot;
@@ -593,9 +732,18 @@ namespace sa2
                         REGSAVE(REGVALUE_MB_VOLUME, mockingboard.GetVolume());
                     }
 
+                    myAudioLatency = SoundCore_GetTargetLatency();
+                    if (ImGui::SliderInt("Target latency (ms)", &myAudioLatency, 0, 200))
+                    {
+                        SoundCore_SetTargetLatency(myAudioLatency);
+                    }
+                    ImGui::SameLine();
+                    HelpMarker("0 = AppleWin's heuristic (1/4 to 1/2 of the ring-buffer).");
+                    ImGui::LabelText("Cycles feedback", "%d", g_nCpuCyclesFeedback);
+
                     ImGui::Separator();
 
-                    if (ImGui::BeginTable("Devices", 7, ImGuiTableFlags_RowBg))
+                    if (ImGui::BeginTable("Devices", 11, ImGuiTableFlags_RowBg))
                     {
                         myAudioInfo = getAudioInfo();
                         ImGui::TableSetupColumn("Voice");
@@ -605,6 +753,10 @@ namespace sa2
                         ImGui::TableSetupColumn("Volume");
                         ImGui::TableSetupColumn("Buffer (ms)");
                         ImGui::TableSetupColumn("Underruns");
+                        ImGui::TableSetupColumn("Overruns");
+                        ImGui::TableSetupColumn("Target (ms)");
+                        ImGui::TableSetupColumn("Latency (ms)");
+                        ImGui::TableSetupColumn("Correction");
                         ImGui::TableHeadersRow();
 
                         ImGui::BeginDisabled();
@@ -630,6 +782,17 @@ namespace sa2
                             ImGui::SliderFloat("##Buffer", &buffer, 0, size, "%4.0f");
                             ImGui::TableNextColumn();
                             ImGui::Text("%zu", device.numberOfUnderruns);
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%zu", device.numberOfOverruns);
+                            if (device.controlled)
+                            {
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%4.0f", device.target * 1000);
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%4.0f", device.latency * 1000);
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%+.2f%%", device.correction * 100);
+                            }
                             ImGui::PopID();
                         }
                         ImGui::EndDisabled();
@@ -637,7 +800,7 @@ namespace sa2
                         ImGui::EndTable();
                     }
 
-                    if (ImGui::Button("Reset underruns"))
+                    if (ImGui::Button("Reset underruns / overruns"))
                     {
                         resetAudioUnderruns();
                     }
@@ -36,6 +36,8 @@ namespace sa2
 
         int mySpeakerVolume;
         int myMockingboardVolume;
+        int myAudioLatency;
+        int myPerfCounter = 0; // histogram
 
         size_t myOpenSlot = 0;
         size_t myOpenDrive = 0;
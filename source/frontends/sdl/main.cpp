@@ -11,6 +11,7 @@
 #include "frontends/common2/argparser.h"
 #include "frontends/common2/programoptions.h"
 #include "frontends/common2/timer.h"
+#include "frontends/sdl/emulationthread.h"
 #include "frontends/sdl/gamepad.h"
 #include "frontends/sdl/sdirectsound.h"
 #include "frontends/sdl/sdlcompat.h"
@@ -22,6 +23,8 @@
 #include "Core.h"
 #include "NTSC.h"
 #include "Interface.h"
+#include "SaveState.h"
+#include "PerfCounters.h"
 
 // comment out to test / debug init / shutdown only
 #define EMULATOR_RUN
@@ -100,6 +103,13 @@ void run_sdl(int argc, char *const argv[])
         };
 
         VideoBenchmark(redraw, refresh);
+        SnapshotBenchmark();
+    }
+    else if (!options.convertSnapshotFilename.empty())
+    {
+        // the snapshot has been loaded by CommonInitialisation
+        Snapshot_SetFilename(options.convertSnapshotFilename);
+        Snapshot_SaveState();
     }
     else
     {
@@ -115,6 +125,15 @@ void run_sdl(int argc, char *const argv[])
         // it does not need to be exact
         const int64_t oneFrameMicros = 1000000 / fps;
 
+        // the emulator paces itself, and this thread only presents what it has produced
+        std::unique_ptr<sa2::EmulationThread> emulationThread;
+        if (options.emulationThread)
+        {
+            emulationThread = std::make_unique<sa2::EmulationThread>(*frame, oneFrameMicros);
+            frame->SetEmulationThread(emulationThread.get());
+            emulationThread->start();
+        }
+
         bool quit = false;
 
         do
@@ -122,19 +141,26 @@ void run_sdl(int argc, char *const argv[])
             frameTimer.tic();
 
             eventTimer.tic();
-            frame->ProcessEvents(quit);
+            {
+                const auto lock = frame->LockEmulator();
+                frame->ProcessEvents(quit);
+            }
             eventTimer.toc();
 
-            cpuTimer.tic();
-            frame->ExecuteOneFrame(oneFrameMicros);
-            cpuTimer.toc();
+            if (!emulationThread)
+            {
+                cpuTimer.tic();
+                frame->ExecuteOneFrame(oneFrameMicros);
+                cpuTimer.toc();
+            }
 
             if (!options.headless)
             {
                 refreshScreenTimer.tic();
-                if (g_bFullSpeed)
+                const PerfMarker perfMarker(PERF_PRESENT);
+                if (g_bFullSpeed && !emulationThread)
                 {
-                    frame->VideoRedrawScreenDuringFullSpeed(g_dwCyclesThisFrame);
+                    frame->RedrawScreenDuringFullSpeed();
                 }
                 else
                 {
@@ -142,17 +168,37 @@ void run_sdl(int argc, char *const argv[])
                 }
                 refreshScreenTimer.toc();
             }
+            else if (emulationThread)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(oneFrameMicros));
+            }
 
+            PerfCounters_EndFrame();
             frameTimer.toc();
         } while (!quit && !frame->Quit());
 
+        if (emulationThread)
+        {
+            emulationThread->stop();
+            frame->SetEmulationThread(nullptr);
+        }
+
         global.toc();
 
         std::cerr << "Global:  " << global << std::endl;
         std::cerr << "Frame:   " << frameTimer << std::endl;
         std::cerr << "Screen:  " << refreshScreenTimer << std::endl;
         std::cerr << "Events:  " << eventTimer << std::endl;
-        std::cerr << "CPU:     " << cpuTimer << std::endl;
+        frame->printStats(std::cerr);
+        if (emulationThread)
+        {
+            emulationThread->printStats(std::cerr);
+        }
+        else
+        {
+            std::cerr << "CPU:     " << cpuTimer << std::endl;
+        }
+        common2::printPerfCounters(std::cerr);
     }
 #endif
 }
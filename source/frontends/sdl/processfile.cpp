@@ -4,6 +4,7 @@
 #include "frontends/common2/utils.h"
 
 #include "linux/cassettetape.h"
+#include "linux/inputrecorder.h"
 
 #include "CardManager.h"
 #include "Disk.h"
@@ -46,6 +47,33 @@ namespace
         }
     }
 
+    // the library knows most images already: do not even try to open the ones which cannot go in this slot
+    // (only the cache is consulted: an unknown image is indexed in the background, for next time)
+    bool checkLibrary(sa2::SDLFrame *frame, const char *filename, const bool floppy)
+    {
+        common2::DiskLibrary &library = frame->getDiskLibrary();
+        common2::DiskLibraryEntry entry;
+        if (!library.lookupCached(filename, entry))
+        {
+            library.scanInBackground({filename});
+            return true; // let the card report the error
+        }
+
+        if (!entry.valid)
+        {
+            frame->FrameMessageBox("Unrecognised disk image", "ERROR", MB_OK);
+            return false;
+        }
+
+        if (floppy && !entry.floppy)
+        {
+            frame->FrameMessageBox("Hard disk image: select a hard disk drive", "ERROR", MB_OK);
+            return false;
+        }
+
+        return true;
+    }
+
     void insertDisk(
         sa2::SDLFrame *frame, const char *filename, const size_t dragAndDropSlot, const size_t dragAndDropDrive)
     {
@@ -57,21 +85,27 @@ namespace
         {
             if (checkExtension(
                     frame, filename,
-                    {".bin", ".do", ".dsk", ".nib", ".po", ".gz", ".woz", ".zip", ".2mg", ".2img", ".iie", ".apl"}))
+                    {".bin", ".do", ".dsk", ".nib", ".po", ".gz", ".woz", ".zip", ".2mg", ".2img", ".iie", ".apl"}) &&
+                checkLibrary(frame, filename, true))
             {
                 Disk2InterfaceCard *card2 = dynamic_cast<Disk2InterfaceCard *>(cardManager.GetObj(dragAndDropSlot));
-                const ImageError_e error = card2->InsertDisk(
-                    dragAndDropDrive, filename, IMAGE_USE_FILES_WRITE_PROTECT_STATUS, IMAGE_DONT_CREATE);
-                if (error != eIMAGE_ERROR_NONE)
+                if (InputRecorder::instance().onInsertDisk(
+                        dragAndDropSlot, dragAndDropDrive, filename, IMAGE_USE_FILES_WRITE_PROTECT_STATUS))
                 {
-                    card2->NotifyInvalidImage(dragAndDropDrive, filename, error);
+                    const ImageError_e error = card2->InsertDisk(
+                        dragAndDropDrive, filename, IMAGE_USE_FILES_WRITE_PROTECT_STATUS, IMAGE_DONT_CREATE);
+                    if (error != eIMAGE_ERROR_NONE)
+                    {
+                        card2->NotifyInvalidImage(dragAndDropDrive, filename, error);
+                    }
                 }
             }
             break;
         }
         case CT_GenericHDD:
         {
-            if (checkExtension(frame, filename, {".hdv", ".po", ".2mg", ".2img", ".gz", ".zip"}))
+            if (checkExtension(frame, filename, {".hdv", ".po", ".2mg", ".2img", ".gz", ".zip"}) &&
+                checkLibrary(frame, filename, false))
             {
                 HarddiskInterfaceCard *harddiskCard =
                     dynamic_cast<HarddiskInterfaceCard *>(cardManager.GetObj(dragAndDropSlot));
@@ -152,6 +186,13 @@ namespace sa2
         {
             insertTape(frame, filename);
         }
+        else if (doesExtensionMatch(filename, {".txt", ".bas", ".s"}))
+        {
+            if (!common2::pasteFile(filename))
+            {
+                frame->FrameMessageBox("Could not open text file", "ERROR", MB_OK);
+            }
+        }
         else
         {
             insertDisk(frame, filename, dragAndDropSlot, dragAndDropDrive);
@@ -6,13 +6,37 @@
 #include "Interface.h"
 #include "Core.h"
 
+#include <algorithm>
 #include <iostream>
+#include <iomanip>
+#include <cstring>
+
+namespace
+{
+
+    // clean rows shorter than this do not split an upload: a lock per run has a cost too
+    constexpr int MAX_CLEAN_GAP = 8;
+
+    // comparing a row costs about as much as uploading it: when most rows change, the next frames are uploaded whole
+    // (half a second at 60 Hz), then the rows are compared again
+    constexpr int FULL_UPLOAD_FRAMES = 30;
+
+} // namespace
 
 namespace sa2
 {
 
     SDLRendererFrame::SDLRendererFrame(const common2::EmulatorOptions &options)
         : SDLFrame(options)
+        , myWidth(0)
+        , myHeight(0)
+        , myRowStep(0)
+        , myOffset(0)
+        , myRowSize(0)
+        , myFullUploads(1)
+        , myVideoMode(0)
+        , myUploadedBytes(0)
+        , myNumberOfFrames(0)
     {
         const common2::Geometry geometry = getGeometryOrDefault(options.geometry);
 
@@ -40,8 +64,6 @@ namespace sa2
         SDLFrame::Initialize(resetVideoState);
         Video &video = GetVideo();
 
-        const int width = video.GetFrameBufferWidth();
-        const int height = video.GetFrameBufferHeight();
         const int sw = video.GetFrameBufferBorderlessWidth();
         const int sh = video.GetFrameBufferBorderlessHeight();
 
@@ -51,24 +73,141 @@ namespace sa2
         }
 
         myTexture.reset(
-            SDL_CreateTexture(myRenderer.get(), ourPixelFormat, SDL_TEXTUREACCESS_STATIC, width, height),
+            SDL_CreateTexture(myRenderer.get(), ourPixelFormat, SDL_TEXTUREACCESS_STREAMING, sw, sh),
             SDL_DestroyTexture);
 
-        myRect.x = video.GetFrameBufferBorderWidth();
-        myRect.y = video.GetFrameBufferBorderHeight();
-        myRect.w = sw;
-        myRect.h = sh;
-        myPitch = width * sizeof(bgra_t);
+        myWidth = sw;
+        myHeight = sh;
+        myRowStep = video.GetFrameBufferRowStep() * ptrdiff_t(sizeof(bgra_t));
+        myOffset = video.GetFrameBufferScanLineOffset(0) * sizeof(bgra_t);
+        myRowSize = sw * sizeof(bgra_t);
+
+        myUploaded.assign(myRowSize * sh, 0);
+        myFullUploads = 1; // the content of a new texture is undefined
+    }
+
+    // row "first" to "last" (top-down, inclusive) of data to the texture
+    void SDLRendererFrame::UploadRows(const uint8_t *data, const ptrdiff_t rowStep, const int first, const int last)
+    {
+        const SDL_Rect rect = {0, first, myWidth, last - first + 1};
+        void *pixels;
+        int pitch;
+        if (!sa2_ok(SDL_LockTexture(myTexture.get(), &rect, &pixels, &pitch)))
+        {
+            return;
+        }
+
+        // the locked area is write only: every pixel must be written
+        uint8_t *dest = static_cast<uint8_t *>(pixels);
+        for (int y = first; y <= last; ++y)
+        {
+            memcpy(dest, data + y * rowStep, myRowSize);
+            dest += pitch;
+        }
+        SDL_UnlockTexture(myTexture.get());
+
+        myUploadedBytes += rect.h * myRowSize;
+    }
+
+    void SDLRendererFrame::UpdateTexture()
+    {
+        myTextureTimer.tic();
+
+        // the texture is top-down whatever the layout of the framebuffer, so it does not need to be flipped
+        const uint8_t *visible = GetFramebufferToPresent() + myOffset;
+
+        // a new video mode redraws the whole screen (the emulation thread owns the video: there the comparison finds it)
+        if (!myEmulationThread)
+        {
+            const uint32_t videoMode = GetVideo().GetVideoMode();
+            if (videoMode != myVideoMode)
+            {
+                myVideoMode = videoMode;
+                myFullUploads = std::max(myFullUploads, 1);
+            }
+        }
+
+        if (myFullUploads > 1)
+        {
+            // straight from the framebuffer: the copy is now out of date
+            UploadRows(visible, myRowStep, 0, myHeight - 1);
+            --myFullUploads;
+        }
+        else if (myFullUploads == 1)
+        {
+            for (int y = 0; y < myHeight; ++y)
+            {
+                memcpy(myUploaded.data() + y * myRowSize, visible + y * myRowStep, myRowSize);
+            }
+            UploadRows(myUploaded.data(), myRowSize, 0, myHeight - 1);
+            myFullUploads = 0;
+        }
+        else
+        {
+            int changedRows = 0;
+            int first = -1; // start of the current run of changed rows
+            int last = -1;  // last changed row in the run
+            for (int y = 0; y < myHeight; ++y)
+            {
+                const uint8_t *source = visible + y * myRowStep;
+                uint8_t *uploaded = myUploaded.data() + y * myRowSize;
+                if (memcmp(source, uploaded, myRowSize))
+                {
+                    memcpy(uploaded, source, myRowSize);
+                    ++changedRows;
+                    if (first < 0)
+                    {
+                        first = y;
+                    }
+                    last = y;
+                }
+                else if (first >= 0 && y - last > MAX_CLEAN_GAP)
+                {
+                    UploadRows(myUploaded.data(), myRowSize, first, last);
+                    first = -1;
+                }
+            }
+
+            if (first >= 0)
+            {
+                UploadRows(myUploaded.data(), myRowSize, first, last);
+            }
+
+            if (changedRows * 4 > myHeight * 3)
+            {
+                myFullUploads = FULL_UPLOAD_FRAMES;
+            }
+        }
+
+        ++myNumberOfFrames;
+        myTextureTimer.toc();
     }
 
     void SDLRendererFrame::VideoPresentScreen()
     {
-        SDL_UpdateTexture(myTexture.get(), nullptr, myFramebuffer.data(), myPitch);
+        if (HandOverFramebuffer())
+        {
+            return;
+        }
+
+        UpdateTexture();
         SDL_RenderClear(myRenderer.get());
-        SDL_RenderCopyEx(myRenderer.get(), myTexture.get(), &myRect, nullptr, 0.0, nullptr, SDL_FLIP_VERTICAL);
+        SDL_RenderCopy(myRenderer.get(), myTexture.get(), nullptr, nullptr);
         SDL_RenderPresent(myRenderer.get());
     }
 
+    void SDLRendererFrame::printStats(std::ostream &os) const
+    {
+        if (myNumberOfFrames)
+        {
+            const double full = double(myRowSize) * myHeight;
+            const double perFrame = double(myUploadedBytes) / myNumberOfFrames;
+            os << "Upload:  " << std::setw(8) << perFrame / 1024 << " KB per frame";
+            os << ", " << std::setw(6) << perFrame / full * 100 << "% of the screen" << std::endl;
+            os << "Texture: " << myTextureTimer << std::endl;
+        }
+    }
+
     void SDLRendererFrame::GetRelativeMousePosition(const SDL_MouseMotionEvent &motion, float &x, float &y) const
     {
         int width, height;
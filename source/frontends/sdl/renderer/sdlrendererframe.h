@@ -1,7 +1,9 @@
 #pragma once
 
 #include "frontends/sdl/sdlframe.h"
+#include "frontends/common2/timer.h"
 #include <memory>
+#include <vector>
 
 namespace sa2
 {
@@ -16,15 +18,33 @@ namespace sa2
 
         bool Quit() const override;
 
+        void printStats(std::ostream &os) const override;
+
     protected:
         void GetRelativeMousePosition(const SDL_MouseMotionEvent &motion, float &x, float &y) const override;
         void ToggleMouseCursor() override;
 
     private:
+        void UpdateTexture();
+        void UploadRows(const uint8_t *data, const ptrdiff_t rowStep, const int first, const int last);
+
         static constexpr PixelFormat_t ourPixelFormat = SDL_PIXELFORMAT_ARGB8888;
 
-        Renderer_Rect_t myRect;
-        int myPitch;
+        // the texture only holds the visible part of the framebuffer, top-down
+        int myWidth;
+        int myHeight;
+        ptrdiff_t myRowStep; // in the framebuffer, from one row to the one below it (negative if bottom-up)
+        size_t myOffset;     // of the top left visible pixel in the framebuffer
+        size_t myRowSize;
+
+        // what the texture contains, to upload only the rows which have changed
+        std::vector<uint8_t> myUploaded;
+        int myFullUploads;    // frames to upload whole, without comparing: the copy is only refreshed by the last one
+        uint32_t myVideoMode; // of the last frame (not tracked with the emulation thread)
+
+        size_t myUploadedBytes;
+        size_t myNumberOfFrames;
+        common2::Timer myTextureTimer;
 
         std::shared_ptr<SDL_Renderer> myRenderer;
         std::shared_ptr<SDL_Texture> myTexture;
@@ -97,24 +97,10 @@ namespace
 
     void DirectSoundGenerator::audioCallback2(uint8_t *stream, int len)
     {
-        LPVOID lpvAudioPtr1, lpvAudioPtr2;
-        DWORD dwAudioBytes1, dwAudioBytes2;
-        const size_t bytesRead = Read(len, &lpvAudioPtr1, &dwAudioBytes1, &lpvAudioPtr2, &dwAudioBytes2);
-
+        myMixerBuffer.resize(len);
+        const size_t bytesRead = Read(len, myMixerBuffer.data());
         myMixerBuffer.resize(bytesRead);
 
-        uint8_t *dest = myMixerBuffer.data();
-        if (lpvAudioPtr1 && dwAudioBytes1)
-        {
-            memcpy(dest, lpvAudioPtr1, dwAudioBytes1);
-            dest += dwAudioBytes1;
-        }
-        if (lpvAudioPtr2 && dwAudioBytes2)
-        {
-            memcpy(dest, lpvAudioPtr2, dwAudioBytes2);
-            dest += dwAudioBytes2;
-        }
-
         stream = mixBufferTo(stream);
 
         const size_t gap = len - bytesRead;
@@ -209,7 +195,16 @@ namespace
         std::cerr << ", buffer: " << std::setw(6) << bytesInBuffer;
         const double time = double(bytesInBuffer) / myBytesPerSecond * 1000;
         std::cerr << ", " << std::setw(8) << time << " ms";
-        std::cerr << ", underruns: " << std::setw(10) << GetBufferUnderruns() << std::endl;
+        std::cerr << ", underruns: " << std::setw(10) << GetBufferUnderruns();
+        std::cerr << ", overruns: " << std::setw(10) << GetBufferOverruns();
+
+        SoundLatencyController::Stats stats;
+        if (SoundCore_GetTargetLatency() && SoundCore_GetLatencyStats(this, stats))
+        {
+            std::cerr << ", target: " << std::setw(6) << stats.targetMs << " ms";
+            std::cerr << ", correction: " << std::setw(8) << stats.correction * 100 << " %";
+        }
+        std::cerr << std::endl;
     }
 
     sa2::SoundInfo DirectSoundGenerator::getInfo()
@@ -224,6 +219,7 @@ namespace
         info.sampleRate = mySampleRate;
         info.volume = GetLogarithmicVolume();
         info.numberOfUnderruns = GetBufferUnderruns();
+        info.numberOfOverruns = GetBufferOverruns();
 
         if (info.running && myBytesPerSecond > 0)
         {
@@ -233,6 +229,15 @@ namespace
             info.size = myBufferSize * coeff;
         }
 
+        SoundLatencyController::Stats stats;
+        if (SoundCore_GetTargetLatency() && SoundCore_GetLatencyStats(this, stats))
+        {
+            info.controlled = true;
+            info.target = stats.targetMs / 1000;
+            info.latency = stats.latencyMs / 1000;
+            info.correction = stats.correction;
+        }
+
         return info;
     }
 
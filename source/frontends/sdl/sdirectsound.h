@@ -28,6 +28,13 @@ namespace sa2
         float volume = 0.0;
 
         size_t numberOfUnderruns = 0;
+        size_t numberOfOverruns = 0;
+
+        // latency controller, if enabled (see SoundCore_SetTargetLatency)
+        bool controlled = false;
+        float target = 0.0;     // in seconds
+        float latency = 0.0;    // in seconds
+        float correction = 0.0; // relative
     };
 
     std::shared_ptr<SoundBuffer> iCreateDirectSoundBuffer(
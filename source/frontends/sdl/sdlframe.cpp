@@ -1,6 +1,7 @@
 #include "StdAfx.h"
 #include "frontends/sdl/processfile.h"
 #include "frontends/sdl/sdlframe.h"
+#include "frontends/sdl/emulationthread.h"
 #include "frontends/sdl/utils.h"
 #include "frontends/sdl/sdirectsound.h"
 #include "frontends/sdl/sdlcompat.h"
@@ -19,6 +20,7 @@
 #include "../resource/resource.h"
 #include "linux/paddle.h"
 #include "linux/keyboardbuffer.h"
+#include "linux/inputrecorder.h"
 #include "linux/network/slirp2.h"
 
 #include <algorithm>
@@ -142,7 +144,15 @@ namespace sa2
         , myDragAndDropDrive(DRIVE_1)
         , myScrollLockFullSpeed(false)
         , myPortFwds(getPortFwds(options.natPortFwds))
+        , myDiskLibrary(std::make_shared<common2::DiskLibrary>(common2::getConfigFile("disklibrary.json")))
+        , myEmulationThread(nullptr)
+        , myRenderThread(std::this_thread::get_id())
+        , myRefreshTitle(false)
     {
+        if (!options.diskLibrary.empty())
+        {
+            myDiskLibrary->scanInBackground(options.diskLibrary);
+        }
     }
 
     void SDLFrame::SetGLSynchronisation(const common2::EmulatorOptions &options)
@@ -205,12 +215,87 @@ namespace sa2
         setGLSwapInterval(myTargetGLSwap);
     }
 
+    void SDLFrame::Initialize(bool resetVideoState)
+    {
+        common2::GNUFrame::Initialize(resetVideoState);
+        ResizePresentedFrames();
+    }
+
+    void SDLFrame::SetEmulationThread(EmulationThread *thread)
+    {
+        myEmulationThread = thread;
+        ResizePresentedFrames();
+    }
+
+    void SDLFrame::ResizePresentedFrames()
+    {
+        myPresentedFrames.resize(myFramebuffer.size());
+        // the video keeps a list of the frames it has already cleared: they may have been reallocated
+        GetVideo().InvalidateOtherFrameBuffers();
+    }
+
+    std::unique_lock<std::recursive_mutex> SDLFrame::LockEmulator()
+    {
+        if (myEmulationThread)
+        {
+            return myEmulationThread->lock();
+        }
+        return std::unique_lock<std::recursive_mutex>();
+    }
+
+    bool SDLFrame::IsEmulationThread() const
+    {
+        return myEmulationThread && std::this_thread::get_id() != myRenderThread;
+    }
+
+    uint8_t *SDLFrame::VideoSwapFrameBuffer(uint8_t *frameBuffer)
+    {
+        if (!myEmulationThread)
+        {
+            return myFramebuffer.data();
+        }
+
+        // the video is drawn directly into the back buffer, no need to copy it
+        // the first time, it is still our own framebuffer: it is not published
+        if (frameBuffer == myPresentedFrames.getBack())
+        {
+            myPresentedFrames.publish();
+        }
+        return myPresentedFrames.getBack();
+    }
+
+    bool SDLFrame::HandOverFramebuffer()
+    {
+        return IsEmulationThread();
+    }
+
+    const uint8_t *SDLFrame::GetFramebufferToPresent()
+    {
+        if (myEmulationThread)
+        {
+            myPresentedFrames.acquire(); // or keep the previous one
+            return myPresentedFrames.getFront();
+        }
+        return myFramebuffer.data();
+    }
+
+    void SDLFrame::printStats(std::ostream &os) const
+    {
+    }
+
     void SDLFrame::FrameRefreshStatus(int drawflags)
     {
         if (drawflags & DRAW_TITLE)
         {
-            GetAppleWindowTitle();
-            SDL_SetWindowTitle(myWindow.get(), g_pAppTitle.c_str());
+            if (IsEmulationThread())
+            {
+                myRefreshTitle = true; // the window belongs to the render thread
+            }
+            else
+            {
+                GetAppleWindowTitle();
+                SDL_SetWindowTitle(myWindow.get(), g_pAppTitle.c_str());
+            }
         }
     }
 
@@ -242,6 +327,11 @@ namespace sa2
 
     void SDLFrame::ProcessEvents(bool &quit)
     {
+        if (myRefreshTitle.exchange(false))
+        {
+            FrameRefreshStatus(DRAW_TITLE);
+        }
+
         SDL_Event e;
         while (SDL_PollEvent(&e) != 0)
         {
@@ -316,7 +406,10 @@ namespace sa2
             {
                 const eBUTTONSTATE state = SA2_BUTTON_DOWN(event) ? BUTTON_DOWN : BUTTON_UP;
                 const eBUTTON button = (event.button == SDL_BUTTON_LEFT) ? BUTTON0 : BUTTON1;
-                cardManager.GetMouseCard()->SetButton(button, state);
+                if (InputRecorder::instance().onMouseButton(button, state))
+                {
+                    cardManager.GetMouseCard()->SetButton(button, state);
+                }
                 break;
             }
             }
@@ -386,9 +479,12 @@ namespace sa2
                 dy = newY - iY;
             }
 
-            int outOfBoundsX;
-            int outOfBoundsY;
-            cardManager.GetMouseCard()->SetPositionRel(dx, dy, &outOfBoundsX, &outOfBoundsY);
+            if (InputRecorder::instance().onMouseMove(dx, dy))
+            {
+                int outOfBoundsX;
+                int outOfBoundsY;
+                cardManager.GetMouseCard()->SetPositionRel(dx, dy, &outOfBoundsX, &outOfBoundsY);
+            }
         }
     }
 
@@ -424,6 +520,14 @@ namespace sa2
                 }
                 break;
             }
+            case SDLK_F10:
+            {
+                if (modifiers == KMOD_NONE)
+                {
+                    SetRewinding(true);
+                }
+                break;
+            }
             case SDLK_F9:
             {
                 if (modifiers == KMOD_NONE)
@@ -484,7 +588,7 @@ namespace sa2
             {
                 if (modifiers == KMOD_CTRL)
                 {
-                    CtrlReset();
+                    FrameCtrlReset();
                 }
                 else if (modifiers == KMOD_SHIFT)
                 {
@@ -536,13 +640,13 @@ namespace sa2
                     const char *text = SDL_GetClipboardText();
                     if (text)
                     {
-                        addTextToBuffer(text);
+                        pasteTextToBuffer(text);
                     }
 #else
                     char *text = SDL_GetClipboardText();
                     if (text)
                     {
-                        addTextToBuffer(text);
+                        pasteTextToBuffer(text);
                         SDL_free(text);
                     }
 #endif
@@ -575,6 +679,11 @@ namespace sa2
     {
         switch (SA2_KEY_CODE(key))
         {
+        case SDLK_F10:
+        {
+            SetRewinding(false);
+            break;
+        }
         case SDLK_LALT:
         {
             Paddle::setButtonReleased(Paddle::ourOpenApple);
@@ -658,8 +767,19 @@ namespace sa2
 
     void SDLFrame::FrameResetMachineState()
     {
-        ResetMachineState(); // this changes g_bFullSpeed
-        ResetSpeed();
+        if (InputRecorder::instance().onResetMachine())
+        {
+            ResetMachineState(); // this changes g_bFullSpeed
+            ResetSpeed();
+        }
+    }
+
+    void SDLFrame::FrameCtrlReset()
+    {
+        if (InputRecorder::instance().onCtrlReset())
+        {
+            CtrlReset();
+        }
     }
 
     common2::Geometry SDLFrame::getGeometryOrDefault(const std::optional<common2::Geometry> &geometry) const
@@ -697,6 +817,11 @@ namespace sa2
         return mySpeed;
     }
 
+    common2::DiskLibrary &SDLFrame::getDiskLibrary()
+    {
+        return *myDiskLibrary;
+    }
+
     void SDLFrame::SaveSnapshot()
     {
         const std::string &pathname = Snapshot_GetPathname();
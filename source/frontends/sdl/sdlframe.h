@@ -3,12 +3,21 @@
 #include "frontends/sdl/sdlcompat.h"
 #include "frontends/common2/gnuframe.h"
 #include "frontends/common2/controllerdoublepress.h"
+#include "frontends/common2/disklibrary.h"
 #include "frontends/common2/programoptions.h"
+#include "frontends/common2/triplebuffer.h"
 #include "linux/network/portfwds.h"
 
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <iosfwd>
+
 namespace sa2
 {
 
+    class EmulationThread;
+
     class SDLFrame : public common2::GNUFrame
     {
     public:
@@ -16,6 +25,8 @@ namespace sa2
 
         void Begin() override;
         void End() override;
+        void Initialize(bool resetVideoState) override;
+        uint8_t *VideoSwapFrameBuffer(uint8_t *frameBuffer) override;
 
         void FrameRefreshStatus(int drawflags) override;
         int FrameMessageBox(LPCSTR lpText, LPCSTR lpCaption, UINT uType) override;
@@ -30,6 +41,7 @@ namespace sa2
         void ProcessEvents(bool &quit);
 
         void FrameResetMachineState();
+        void FrameCtrlReset();
 
         const std::shared_ptr<SDL_Window> &GetWindow() const;
 
@@ -40,13 +52,30 @@ namespace sa2
         bool &getAutoBoot();
 
         const common2::Speed &getSpeed() const;
+        common2::DiskLibrary &getDiskLibrary();
 
         void SaveSnapshot();
 
+        // printed at the end of the run
+        virtual void printStats(std::ostream &os) const;
+
         static bool setGLSwapInterval(const int interval);
         static void changeGLSwapInterval(const int interval);
 
+        // nullptr: the emulator runs on the render thread
+        void SetEmulationThread(EmulationThread *thread);
+        // to be held by the render thread while it accesses the emulator (no-op without an emulation thread)
+        std::unique_lock<std::recursive_mutex> LockEmulator();
+
     protected:
+        // true on the emulation thread: the caller must not render (frames are published by VideoSwapFrameBuffer())
+        bool HandOverFramebuffer();
+        // the latest complete framebuffer
+        const uint8_t *GetFramebufferToPresent();
+        // (re)allocates the frames handed over by the emulation thread
+        void ResizePresentedFrames();
+        bool IsEmulationThread() const;
+
         void SetApplicationIcon();
         void SetGLSynchronisation(const common2::EmulatorOptions &options);
 
@@ -84,6 +113,13 @@ namespace sa2
         std::shared_ptr<SDL_Window> myWindow;
 
         common2::ControllerDoublePress myControllerQuit;
+
+        std::shared_ptr<common2::DiskLibrary> myDiskLibrary;
+
+        EmulationThread *myEmulationThread;
+        const std::thread::id myRenderThread;
+        common2::TripleBuffer myPresentedFrames;
+        std::atomic<bool> myRefreshTitle;
     };
 
 } // namespace sa2
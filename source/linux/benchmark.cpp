@@ -9,10 +9,12 @@
 #include "NTSC.h"
 #include "CPU.h"
 #include "Interface.h"
+#include "SaveState.h"
 
 #include "linux/benchmark.h"
 
 #include <chrono>
+#include <filesystem>
 
 void VideoBenchmark(std::function<void()> redraw, std::function<void()> refresh)
 {
@@ -167,3 +169,66 @@ void VideoBenchmark(std::function<void()> redraw, std::function<void()> refresh)
         (LPCTSTR)(IS_APPLE2 ? " (6502)" : ""), (unsigned)realisticfps);
     frame.FrameMessageBox(outstr.c_str(), "Benchmarks", MB_ICONINFORMATION | MB_SETFOREGROUND);
 }
+
+void SnapshotBenchmark()
+{
+    typedef std::chrono::microseconds interval_t;
+    typedef int64_t counter_t;
+    const counter_t onesecond = 1000000;
+
+    struct Format
+    {
+        const char *name;
+        const char *ext;
+        bool compress;
+    };
+
+    const Format formats[] = {
+        {"YAML", ".aws.yaml", false},
+        {"Binary", ".aws.bin", false},
+        {"Binary (zlib)", ".aws.bin", true},
+    };
+
+    // repeat for (at least) one second, return the average in ms
+    const auto measure = [onesecond](const std::string &filename, void (*action)()) -> double
+    {
+        counter_t count = 0;
+        counter_t elapsed;
+        const auto start = std::chrono::steady_clock::now();
+        do
+        {
+            // inserting the disks of a snapshot updates its pathname
+            Snapshot_SetFilename(filename);
+            action();
+            ++count;
+            const auto end = std::chrono::steady_clock::now();
+            elapsed = std::chrono::duration_cast<interval_t>(end - start).count();
+        } while (elapsed < onesecond);
+        return double(elapsed) / count / 1000.0;
+    };
+
+    const std::string pathname = Snapshot_GetPathname();
+    const bool compress = Snapshot_GetCompress();
+
+    std::string outstr;
+    for (const Format &format : formats)
+    {
+        const std::filesystem::path filename =
+            std::filesystem::temp_directory_path() / (std::string("applewin-benchmark") + format.ext);
+        Snapshot_SetCompress(format.compress);
+
+        const double saveMs = measure(filename.string(), Snapshot_SaveState);
+        std::error_code ec;
+        const uintmax_t size = std::filesystem::file_size(filename, ec);
+        const double loadMs = measure(filename.string(), Snapshot_LoadState);
+        std::filesystem::remove(filename, ec);
+
+        outstr += StrFormat(
+            "%s:\tsave %.2f ms, load %.2f ms, %u KB\n", format.name, saveMs, loadMs, unsigned(ec ? 0 : size / 1024));
+    }
+
+    Snapshot_SetFilename(pathname);
+    Snapshot_SetCompress(compress);
+
+    GetFrame().FrameMessageBox(outstr.c_str(), "Snapshot Benchmarks", MB_ICONINFORMATION | MB_SETFOREGROUND);
+}
@@ -6,3 +6,6 @@ void VideoBenchmark(
     std::function<void()> redraw, // regenerate image and repaint
     std::function<void()> refresh // just repaint
 );
+
+// save & load the current state as YAML, binary and compressed binary
+void SnapshotBenchmark();
@@ -3,7 +3,9 @@
 
 #include "Core.h"
 #include "YamlHelper.h"
+#include "linux/inputrecorder.h"
 
+#include <deque>
 #include <queue>
 
 namespace
@@ -12,6 +14,10 @@ namespace
     bool g_bCapsLock = true; // Caps lock key for Apple2 and Lat/Cyr lock for Pravets8
     BYTE keycode = 0;
 
+    // turbo paste: keys move to "keys" one at a time, when the guest has read the previous one
+    std::deque<BYTE> pasteKeys;
+    bool pasteWaitForInput = false; // after a RETURN, until the guest polls the keyboard and finds nothing
+
     void setKeyCode()
     {
         if (!keys.empty())
@@ -19,34 +25,103 @@ namespace
             keycode = keys.front();
         }
     }
+
+    // -1 if the character cannot be typed
+    int getKeyFromText(const char ch)
+    {
+        switch (ch)
+        {
+        case '\n':
+            return 0x0d;
+        case 0x20 ... 0x7e:
+            return ch;
+        default:
+            return -1;
+        }
+    }
+
+    void feedPastedKey()
+    {
+        if (pasteKeys.empty() || !keys.empty())
+        {
+            return;
+        }
+
+        if (pasteWaitForInput)
+        {
+            // the guest has processed the line and is back in its input routine
+            // this poll returns no key, the next one gets the next line
+            pasteWaitForInput = false;
+            return;
+        }
+
+        const BYTE key = pasteKeys.front();
+        pasteKeys.pop_front();
+        keys.push(key);
+        pasteWaitForInput = key == 0x0d;
+    }
 } // namespace
 
 void addKeyToBuffer(BYTE key)
 {
-    keys.push(key);
+    if (InputRecorder::instance().onKey(key))
+    {
+        keys.push(key);
+    }
+}
+
+std::queue<BYTE> getKeyBuffer()
+{
+    return keys;
+}
+
+void setKeyBuffer(const std::queue<BYTE> &buffer)
+{
+    keys = buffer;
 }
 
 void addTextToBuffer(const char *text)
 {
     while (*text)
     {
-        switch (*text)
-        {
-        case '\n':
+        const int key = getKeyFromText(*text);
+        if (key >= 0)
         {
-            addKeyToBuffer(0x0d);
-            break;
+            addKeyToBuffer(key);
         }
-        case 0x20 ... 0x7e:
+        ++text;
+    }
+}
+
+void pasteTextToBuffer(const char *text)
+{
+    if (!InputRecorder::instance().onPaste(text))
+    {
+        return;
+    }
+
+    while (*text)
+    {
+        const int key = getKeyFromText(*text);
+        if (key >= 0)
         {
-            addKeyToBuffer(*text);
-            break;
-        }
+            pasteKeys.push_back(key);
         }
         ++text;
     }
 }
 
+bool isPasting()
+{
+    return !pasteKeys.empty();
+}
+
+void cancelPaste()
+{
+    pasteKeys.clear();
+    pasteWaitForInput = false;
+}
+
 void KeybSetAltGrSendsWM_CHAR(bool state)
 {
 }
@@ -69,6 +144,7 @@ BYTE KeybReadData()
 {
     LogFileTimeUntilFirstKeyRead();
 
+    feedPastedKey();
     setKeyCode();
 
     return keycode | (keys.empty() ? 0 : 0x80);
@@ -99,7 +175,7 @@ void KeybSaveSnapshot(YamlSaveHelper &yamlSaveHelper)
 {
     YamlSaveHelper::Label state(yamlSaveHelper, "%s:\n", KeybGetSnapshotStructName().c_str());
     yamlSaveHelper.SaveHexUint8(SS_YAML_KEY_LASTKEY, keycode);
-    yamlSaveHelper.SaveBool(SS_YAML_KEY_KEYWAITING, keys.empty() ? false : false);
+    yamlSaveHelper.SaveBool(SS_YAML_KEY_KEYWAITING, !keys.empty());
 }
 
 void KeybLoadSnapshot(YamlLoadHelper &yamlLoadHelper, UINT version)
@@ -114,7 +190,11 @@ void KeybLoadSnapshot(YamlLoadHelper &yamlLoadHelper, UINT version)
         keywaiting = yamlLoadHelper.LoadBool(SS_YAML_KEY_KEYWAITING);
 
     keys = std::queue<BYTE>();
-    addKeyToBuffer(keycode);
+    if (keywaiting)
+    {
+        // restored state, not a key press: keep it out of the input recording
+        keys.push(keycode);
+    }
 
     yamlLoadHelper.PopMap();
 }
@@ -123,6 +203,7 @@ void KeybReset()
 {
     keycode = 0;
     std::queue<BYTE>().swap(keys);
+    cancelPaste();
 }
 
 bool KeybGetShiftStatus()
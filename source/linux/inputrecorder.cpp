@@ -0,0 +1,463 @@
+#include "StdAfx.h"
+
+#include "linux/inputrecorder.h"
+#include "linux/keyboardbuffer.h"
+#include "linux/paddle.h"
+
+#include "CardManager.h"
+#include "CPU.h"
+#include "Disk.h"
+#include "Log.h"
+#include "MouseInterface.h"
+#include "Utilities.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <climits>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace
+{
+
+    // file format: header, then for each event
+    // varint (cycles since the previous event), type (1 byte), payload (see writeEvent)
+    const char ourMagic[4] = {'A', '2', 'I', 'R'};
+    constexpr uint8_t ourVersion = 1;
+
+    constexpr int ourNoValue = INT_MIN;
+
+    // a larger filename or pasted text can only come from a corrupt file
+    constexpr uint64_t ourMaxDataSize = 1 << 24;
+
+    void writeVarint(std::ostream &os, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            os.put(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        os.put(static_cast<char>(value));
+    }
+
+    bool readVarint(std::istream &is, uint64_t &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            const int ch = is.get();
+            if (ch == EOF)
+            {
+                return false;
+            }
+            value |= static_cast<uint64_t>(ch & 0x7F) << shift;
+            if (!(ch & 0x80))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // zigzag: small negative numbers stay small
+    void writeSigned(std::ostream &os, const int value)
+    {
+        writeVarint(os, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(int64_t(value) >> 63));
+    }
+
+    bool readSigned(std::istream &is, int &value)
+    {
+        uint64_t raw;
+        if (!readVarint(is, raw))
+        {
+            return false;
+        }
+        value = static_cast<int>((raw >> 1) ^ -(raw & 1));
+        return true;
+    }
+
+    // length, then the bytes: fails on a short read
+    bool readData(std::istream &is, std::string &data)
+    {
+        uint64_t size;
+        if (!readVarint(is, size) || size > ourMaxDataSize)
+        {
+            return false;
+        }
+        data.resize(size);
+        return bool(is.read(data.data(), size));
+    }
+
+} // namespace
+
+InputRecorder &InputRecorder::instance()
+{
+    static InputRecorder recorder;
+    return recorder;
+}
+
+void InputRecorder::setFixedSeed(const uint32_t seed)
+{
+    srand(seed);
+    // MemReset() mixes the time into the random memory pattern
+    timeSetFixed(true);
+}
+
+void InputRecorder::startRecording(const std::string &filename, const uint32_t seed)
+{
+    stop();
+
+    myOutput.open(filename, std::ios::binary | std::ios::trunc);
+    if (!myOutput)
+    {
+        throw std::runtime_error("Cannot create input recording: " + filename);
+    }
+
+    myOutput.write(ourMagic, sizeof(ourMagic));
+    myOutput.put(static_cast<char>(ourVersion));
+    writeVarint(myOutput, seed);
+
+    myLastCycle = g_nCumulativeCycles;
+    writeVarint(myOutput, myLastCycle);
+    std::fill(std::begin(myPaddleButtons), std::end(myPaddleButtons), ourNoValue);
+    std::fill(std::begin(myPaddleAxes), std::end(myPaddleAxes), ourNoValue);
+    myRecording = true;
+
+    LogFileOutput("InputRecorder: recording to %s, seed = %u\n", filename.c_str(), seed);
+}
+
+uint32_t InputRecorder::startReplay(const std::string &filename)
+{
+    stop();
+
+    myInput.open(filename, std::ios::binary);
+    if (!myInput)
+    {
+        throw std::runtime_error("Cannot open input recording: " + filename);
+    }
+
+    char magic[sizeof(ourMagic)];
+    uint64_t seed;
+    if (!myInput.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), ourMagic) ||
+        myInput.get() != ourVersion || !readVarint(myInput, seed) || !readVarint(myInput, myLastCycle))
+    {
+        myInput.close();
+        throw std::runtime_error("Invalid input recording: " + filename);
+    }
+
+    std::fill(std::begin(myPaddleButtons), std::end(myPaddleButtons), ourNoValue);
+    std::fill(std::begin(myPaddleAxes), std::end(myPaddleAxes), ourNoValue);
+    myReplaying = readEvent(myNext);
+
+    LogFileOutput("InputRecorder: replaying %s, seed = %u\n", filename.c_str(), uint32_t(seed));
+    return static_cast<uint32_t>(seed);
+}
+
+void InputRecorder::stop()
+{
+    if (myRecording)
+    {
+        myOutput.close();
+        myRecording = false;
+    }
+    if (myInput.is_open())
+    {
+        myInput.close();
+        myReplaying = false;
+    }
+}
+
+uint64_t InputRecorder::getNextCycle() const
+{
+    return myReplaying ? myNext.cycle : UINT64_MAX;
+}
+
+void InputRecorder::update()
+{
+    while (myReplaying && myNext.cycle <= g_nCumulativeCycles)
+    {
+        apply(myNext);
+        if (!readEvent(myNext))
+        {
+            // live input from now on
+            LogFileOutput("InputRecorder: end of replay at cycle %" PRIu64 "\n", uint64_t(g_nCumulativeCycles));
+            myInput.close();
+            myReplaying = false;
+        }
+    }
+}
+
+bool InputRecorder::isLive() const
+{
+    return !myReplaying || myApplying;
+}
+
+void InputRecorder::writeEvent(
+    const EventType type, const int a, const int b, const int c, const std::string &data)
+{
+    // a snapshot loaded while recording can move the clock back
+    const uint64_t cycle = std::max(myLastCycle, static_cast<uint64_t>(g_nCumulativeCycles));
+    writeVarint(myOutput, cycle - myLastCycle);
+    myLastCycle = cycle;
+
+    myOutput.put(static_cast<char>(type));
+    switch (type)
+    {
+    case EventType::Key:
+        myOutput.put(static_cast<char>(a));
+        break;
+    case EventType::Button:
+    case EventType::PaddleButton:
+    case EventType::MouseButton:
+        myOutput.put(static_cast<char>(a));
+        myOutput.put(static_cast<char>(b));
+        break;
+    case EventType::PaddleAxis:
+        myOutput.put(static_cast<char>(a));
+        writeSigned(myOutput, b);
+        break;
+    case EventType::MouseMove:
+        writeSigned(myOutput, a);
+        writeSigned(myOutput, b);
+        break;
+    case EventType::InsertDisk:
+        myOutput.put(static_cast<char>(a));
+        myOutput.put(static_cast<char>(b));
+        myOutput.put(static_cast<char>(c));
+        writeVarint(myOutput, data.size());
+        myOutput.write(data.data(), data.size());
+        break;
+    case EventType::Paste:
+        writeVarint(myOutput, data.size());
+        myOutput.write(data.data(), data.size());
+        break;
+    case EventType::ResetMachine:
+    case EventType::CtrlReset:
+        break;
+    }
+}
+
+bool InputRecorder::readEvent(Event &event)
+{
+    uint64_t delta;
+    if (!readVarint(myInput, delta))
+    {
+        return false;
+    }
+    myLastCycle += delta;
+    event.cycle = myLastCycle;
+
+    const int type = myInput.get();
+    event.type = static_cast<EventType>(type);
+    bool complete = true; // the variable length fields, the fixed ones are checked on the stream
+    switch (event.type)
+    {
+    case EventType::Key:
+        event.a = myInput.get();
+        break;
+    case EventType::Button:
+    case EventType::PaddleButton:
+    case EventType::MouseButton:
+        event.a = myInput.get();
+        event.b = myInput.get();
+        break;
+    case EventType::PaddleAxis:
+        event.a = myInput.get();
+        complete = readSigned(myInput, event.b);
+        break;
+    case EventType::MouseMove:
+        complete = readSigned(myInput, event.a) && readSigned(myInput, event.b);
+        break;
+    case EventType::InsertDisk:
+        event.a = myInput.get();
+        event.b = myInput.get();
+        event.c = myInput.get();
+        complete = readData(myInput, event.data);
+        break;
+    case EventType::Paste:
+        complete = readData(myInput, event.data);
+        break;
+    case EventType::ResetMachine:
+    case EventType::CtrlReset:
+        break;
+    default:
+        LogFileOutput("InputRecorder: unknown event %d\n", type);
+        return false;
+    }
+
+    if (!complete || !myInput)
+    {
+        LogFileOutput("InputRecorder: truncated event %d at cycle %" PRIu64 "\n", type, uint64_t(event.cycle));
+        return false;
+    }
+    return true;
+}
+
+void InputRecorder::apply(const Event &event)
+{
+    myApplying = true;
+
+    CardManager &cardManager = GetCardMgr();
+    switch (event.type)
+    {
+    case EventType::Key:
+        addKeyToBuffer(static_cast<BYTE>(event.a));
+        break;
+    case EventType::Button:
+        if (event.b)
+        {
+            Paddle::setButtonPressed(event.a);
+        }
+        else
+        {
+            Paddle::setButtonReleased(event.a);
+        }
+        break;
+    case EventType::PaddleButton:
+        myPaddleButtons[event.a & 1] = event.b;
+        break;
+    case EventType::PaddleAxis:
+        myPaddleAxes[event.a & 1] = event.b;
+        break;
+    case EventType::MouseMove:
+        if (cardManager.IsMouseCardInstalled())
+        {
+            int outOfBoundsX;
+            int outOfBoundsY;
+            cardManager.GetMouseCard()->SetPositionRel(event.a, event.b, &outOfBoundsX, &outOfBoundsY);
+        }
+        break;
+    case EventType::MouseButton:
+        if (cardManager.IsMouseCardInstalled())
+        {
+            cardManager.GetMouseCard()->SetButton(eBUTTON(event.a), eBUTTONSTATE(event.b));
+        }
+        break;
+    case EventType::InsertDisk:
+        if (event.a < NUM_SLOTS && cardManager.QuerySlot(event.a) == CT_Disk2)
+        {
+            Disk2InterfaceCard *card2 = dynamic_cast<Disk2InterfaceCard *>(cardManager.GetObj(event.a));
+            const ImageError_e error = card2->InsertDisk(event.b, event.data, event.c, IMAGE_DONT_CREATE);
+            if (error != eIMAGE_ERROR_NONE)
+            {
+                LogFileOutput("InputRecorder: cannot insert %s\n", event.data.c_str());
+            }
+        }
+        break;
+    case EventType::ResetMachine:
+        ResetMachineState();
+        break;
+    case EventType::CtrlReset:
+        CtrlReset();
+        break;
+    case EventType::Paste:
+        pasteTextToBuffer(event.data.c_str());
+        break;
+    }
+
+    myApplying = false;
+}
+
+bool InputRecorder::onKey(const uint8_t key)
+{
+    if (myRecording)
+    {
+        writeEvent(EventType::Key, key);
+    }
+    return isLive();
+}
+
+bool InputRecorder::onButton(const int address, const bool pressed)
+{
+    if (myRecording)
+    {
+        writeEvent(EventType::Button, address, pressed);
+    }
+    return isLive();
+}
+
+bool InputRecorder::onMouseMove(const int dx, const int dy)
+{
+    if (myRecording)
+    {
+        writeEvent(EventType::MouseMove, dx, dy);
+    }
+    return isLive();
+}
+
+bool InputRecorder::onMouseButton(const int button, const int state)
+{
+    if (myRecording)
+    {
+        writeEvent(EventType::MouseButton, button, state);
+    }
+    return isLive();
+}
+
+bool InputRecorder::onInsertDisk(const int slot, const int drive, const std::string &filename, const bool writeProtected)
+{
+    if (myRecording)
+    {
+        writeEvent(EventType::InsertDisk, slot, drive, writeProtected, filename);
+    }
+    return isLive();
+}
+
+bool InputRecorder::onResetMachine()
+{
+    if (myRecording)
+    {
+        writeEvent(EventType::ResetMachine);
+    }
+    return isLive();
+}
+
+bool InputRecorder::onCtrlReset()
+{
+    if (myRecording)
+    {
+        writeEvent(EventType::CtrlReset);
+    }
+    return isLive();
+}
+
+bool InputRecorder::onPaste(const std::string &text)
+{
+    if (myRecording)
+    {
+        writeEvent(EventType::Paste, 0, 0, 0, text);
+    }
+    return isLive();
+}
+
+bool InputRecorder::readPaddleButton(const int i, const bool value)
+{
+    int &last = myPaddleButtons[i & 1];
+    if (myReplaying)
+    {
+        update();
+        return last != ourNoValue ? last : value;
+    }
+    if (myRecording && last != int(value))
+    {
+        writeEvent(EventType::PaddleButton, i, value);
+        last = value;
+    }
+    return value;
+}
+
+int InputRecorder::readPaddleAxis(const int i, const int value)
+{
+    int &last = myPaddleAxes[i & 1];
+    if (myReplaying)
+    {
+        update();
+        return last != ourNoValue ? last : value;
+    }
+    if (myRecording && last != value)
+    {
+        writeEvent(EventType::PaddleAxis, i, value);
+        last = value;
+    }
+    return value;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// Records the input that comes from outside the emulator (keys, paste, paddles, mouse, disks and resets)
+// stamped with g_nCumulativeCycles, and replays it at the same cycles.
+//
+// A replay is identical to the recording if it starts from the same state (configuration, options and snapshot)
+// with the same seed (see setFixedSeed()): the seed is stored in the file.
+//
+// The hooks below return false if the live input must be ignored (during a replay the input comes from the file).
+class InputRecorder
+{
+public:
+    enum class EventType : uint8_t
+    {
+        Key = 0,
+        Button = 1,       // Paddle::setButtonPressed / setButtonReleased
+        PaddleButton = 2, // as read by the Apple
+        PaddleAxis = 3,   // as read by the Apple
+        MouseMove = 4,
+        MouseButton = 5,
+        InsertDisk = 6,
+        ResetMachine = 7,
+        CtrlReset = 8,
+        Paste = 9, // the whole text, the keys are then fed as the Apple reads them
+    };
+
+    static InputRecorder &instance();
+
+    // rand() and the random memory initialisation (MemReset) repeat at every run
+    static void setFixedSeed(uint32_t seed);
+
+    void startRecording(const std::string &filename, uint32_t seed);
+    uint32_t startReplay(const std::string &filename); // returns the seed of the recording
+    void stop();
+
+    bool isRecording() const
+    {
+        return myRecording;
+    }
+
+    bool isReplaying() const
+    {
+        return myReplaying;
+    }
+
+    // the emulator must not execute past this cycle before calling update()
+    uint64_t getNextCycle() const;
+    // applies the events due at g_nCumulativeCycles
+    void update();
+
+    bool onKey(uint8_t key);
+    bool onButton(int address, bool pressed);
+    bool onMouseMove(int dx, int dy);
+    bool onMouseButton(int button, int state);
+    bool onInsertDisk(int slot, int drive, const std::string &filename, bool writeProtected);
+    bool onResetMachine();
+    bool onCtrlReset();
+    bool onPaste(const std::string &text);
+
+    // polled input: the value the Apple reads
+    bool readPaddleButton(int i, bool value);
+    int readPaddleAxis(int i, int value);
+
+private:
+    struct Event
+    {
+        uint64_t cycle;
+        EventType type;
+        int a;
+        int b;
+        int c;
+        std::string data; // filename or pasted text
+    };
+
+    void writeEvent(EventType type, int a = 0, int b = 0, int c = 0, const std::string &data = std::string());
+    bool readEvent(Event &event);
+    void apply(const Event &event);
+    bool isLive() const;
+
+    std::ofstream myOutput;
+    std::ifstream myInput;
+
+    bool myRecording = false;
+    bool myReplaying = false;
+    bool myApplying = false;
+
+    uint64_t myLastCycle = 0;
+    Event myNext;
+
+    // the last value read by the Apple, only changes are recorded
+    int myPaddleButtons[2];
+    int myPaddleAxes[2];
+};
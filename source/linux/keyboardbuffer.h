@@ -1,3 +1,17 @@
+#pragma once
+
+#include <queue>
+
 // these are defined in source/linux/duplicates/Keyboard.cpp
 void addKeyToBuffer(BYTE key);
 void addTextToBuffer(const char *text);
+
+// turbo paste: one key at a time as the guest reads them, and each line waits until the guest is back in its input routine
+// while isPasting() the frontends run at full speed
+void pasteTextToBuffer(const char *text);
+bool isPasting();
+void cancelPaste();
+
+// the typeahead queue is host input, not machine state: run-ahead keeps it across a snapshot restore
+std::queue<BYTE> getKeyBuffer();
+void setKeyBuffer(const std::queue<BYTE> &buffer);
@@ -3,6 +3,8 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
+#include <sys/file.h>
 #include <unistd.h>
 
 namespace
@@ -104,6 +106,20 @@ HANDLE CreateFile(
             f = fopen(lpFileName, "r");
     }
 
+    if (dwCreationDisposition == OPEN_ALWAYS)
+    {
+        // fopen() cannot create without truncating (or appending all writes)
+        const int fd = open(lpFileName, (dwDesiredAccess & GENERIC_WRITE) ? O_RDWR | O_CREAT : O_RDONLY | O_CREAT, 0666);
+        if (fd >= 0)
+        {
+            f = fdopen(fd, (dwDesiredAccess & GENERIC_WRITE) ? "r+" : "r");
+            if (!f)
+            {
+                close(fd);
+            }
+        }
+    }
+
     if (f)
     {
         return new FILE_HANDLE(f);
@@ -114,6 +130,29 @@ HANDLE CreateFile(
     }
 }
 
+BOOL SetEndOfFile(HANDLE hFile)
+{
+    const FILE_HANDLE &file_handle = dynamic_cast<FILE_HANDLE &>(*hFile);
+    if (fflush(file_handle.f))
+    {
+        return FALSE;
+    }
+    return ftruncate(fileno(file_handle.f), ftell(file_handle.f)) == 0;
+}
+
+BOOL LockFileEx(
+    HANDLE hFile, DWORD dwFlags, DWORD dwReserved, DWORD nNumberOfBytesToLockLow, DWORD nNumberOfBytesToLockHigh,
+    LPOVERLAPPED lpOverlapped)
+{
+    const FILE_HANDLE &file_handle = dynamic_cast<FILE_HANDLE &>(*hFile);
+    int operation = (dwFlags & LOCKFILE_EXCLUSIVE_LOCK) ? LOCK_EX : LOCK_SH;
+    if (dwFlags & LOCKFILE_FAIL_IMMEDIATELY)
+    {
+        operation |= LOCK_NB;
+    }
+    return flock(fileno(file_handle.f), operation) == 0;
+}
+
 DWORD GetFileAttributes(const char *filename)
 {
     // minimum is R_OK
@@ -35,6 +35,11 @@ typedef struct tagOFN
 #define OPEN_EXISTING 3
 #define CREATE_NEW 1
 #define CREATE_ALWAYS 2
+#define OPEN_ALWAYS 4
+
+#define LOCKFILE_FAIL_IMMEDIATELY 0x00000001
+#define LOCKFILE_EXCLUSIVE_LOCK 0x00000002
+#define MAXDWORD 0xffffffff
 
 #define GENERIC_READ 0x80000000
 #define GENERIC_WRITE 0x40000000
@@ -65,5 +70,12 @@ HANDLE CreateFile(
 
 DWORD GetFileSize(HANDLE hFile, LPDWORD lpFileSizeHigh);
 
+BOOL SetEndOfFile(HANDLE hFile);
+
+// only whole file locks (flock()): the range is ignored
+BOOL LockFileEx(
+    HANDLE hFile, DWORD dwFlags, DWORD dwReserved, DWORD nNumberOfBytesToLockLow, DWORD nNumberOfBytesToLockHigh,
+    LPOVERLAPPED lpOverlapped);
+
 // non "/" terminated
 DWORD GetCurrentDirectory(DWORD, char *);
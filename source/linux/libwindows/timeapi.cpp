@@ -12,8 +12,23 @@ errno_t ctime_s(char *buf, size_t size, const time_t *time)
     return 0;
 }
 
+namespace
+{
+    bool fixedTime = false;
+}
+
+void timeSetFixed(bool fixed)
+{
+    fixedTime = fixed;
+}
+
 DWORD timeGetTime()
 {
+    if (fixedTime)
+    {
+        return 0;
+    }
+
     struct timeval now;
     gettimeofday(&now, NULL);
     return now.tv_usec / 1000;
@@ -25,5 +25,7 @@ int GetDateFormat(LCID Locale, DWORD dwFlags, CONST SYSTEMTIME *lpDate, LPCSTR l
 int GetTimeFormat(LCID Locale, DWORD dwFlags, CONST SYSTEMTIME *lpTime, LPCSTR lpFormat, LPSTR lpTimeStr, int cchTime);
 
 DWORD timeGetTime();
+// not Win32: timeGetTime() always returns 0 (it only seeds the random memory initialisation)
+void timeSetFixed(bool fixed);
 DWORD GetTickCount();
 void GetLocalTime(SYSTEMTIME *t);
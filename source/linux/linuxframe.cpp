@@ -75,7 +75,7 @@ void LinuxFrame::Initialize(bool resetVideoState)
 {
     Video &video = GetVideo();
 
-    const size_t numberOfPixels = video.GetFrameBufferWidth() * video.GetFrameBufferHeight();
+    const size_t numberOfPixels = video.GetFrameBufferPitch() * video.GetFrameBufferHeight();
 
     static_assert(sizeof(bgra_t) == 4, "Invalid size of bgra_t");
     const size_t numberOfBytes = sizeof(bgra_t) * numberOfPixels;
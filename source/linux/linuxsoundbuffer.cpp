@@ -2,9 +2,16 @@
 
 #include "linux/linuxsoundbuffer.h"
 
+#include <cstring>
+
 LinuxSoundBuffer::LinuxSoundBuffer(DWORD dwBufferSize, DWORD nSampleRate, int nChannels, LPCSTR pszVoiceName)
     : mySoundBuffer(dwBufferSize)
+    , myPlayPosition(0)
     , myNumberOfUnderruns(0)
+    , myWritePosition(0)
+    , myNumberOfOverruns(0)
+    , myStatus(0)
+    , myVolume(0)
     , myBufferSize(dwBufferSize)
     , mySampleRate(nSampleRate)
     , myChannels(nChannels)
@@ -14,16 +21,24 @@ LinuxSoundBuffer::LinuxSoundBuffer(DWORD dwBufferSize, DWORD nSampleRate, int nC
 
 HRESULT LinuxSoundBuffer::Unlock(LPVOID lpvAudioPtr1, DWORD dwAudioBytes1, LPVOID lpvAudioPtr2, DWORD dwAudioBytes2)
 {
-    const size_t totalWrittenBytes = dwAudioBytes1 + dwAudioBytes2;
-    this->myWritePosition = (this->myWritePosition + totalWrittenBytes) % this->mySoundBuffer.size();
-    myMutex.unlock();
+    // a write of the entire buffer (DSBLOCK_ENTIREBUFFER, e.g. to zero it) refills it in place
+    const size_t totalWrittenBytes = (dwAudioBytes1 + dwAudioBytes2) % this->myBufferSize;
+    const size_t playPosition = this->myPlayPosition.load(std::memory_order_acquire);
+    size_t writePosition = this->myWritePosition.load(std::memory_order_relaxed) + totalWrittenBytes;
+    if (writePosition - playPosition > this->myBufferSize)
+    {
+        // the writer has lapped the reader: the oldest data is lost, keep what is in the buffer consistent
+        ++myNumberOfOverruns;
+        writePosition = playPosition + this->myBufferSize;
+    }
+    this->myWritePosition.store(writePosition, std::memory_order_release);
     return DS_OK;
 }
 
 HRESULT LinuxSoundBuffer::Stop()
 {
-    const DWORD mask = DSBSTATUS_PLAYING | DSBSTATUS_LOOPING;
-    this->myStatus &= ~mask;
+    const WORD mask = DSBSTATUS_PLAYING | DSBSTATUS_LOOPING;
+    this->myStatus &= WORD(~mask);
     return DS_OK;
 }
 
@@ -63,7 +78,6 @@ HRESULT LinuxSoundBuffer::Lock(
     DWORD dwWriteCursor, DWORD dwWriteBytes, LPVOID *lplpvAudioPtr1, DWORD *lpdwAudioBytes1, LPVOID *lplpvAudioPtr2,
     DWORD *lpdwAudioBytes2, DWORD dwFlags)
 {
-    myMutex.lock();
     // No attempt is made at restricting write buffer not to overtake play cursor
     if (dwFlags & DSBLOCK_ENTIREBUFFER)
     {
@@ -100,53 +114,48 @@ HRESULT LinuxSoundBuffer::Lock(
     return DS_OK;
 }
 
-DWORD LinuxSoundBuffer::Read(
-    DWORD dwReadBytes, LPVOID *lplpvAudioPtr1, DWORD *lpdwAudioBytes1, LPVOID *lplpvAudioPtr2, DWORD *lpdwAudioBytes2)
+DWORD LinuxSoundBuffer::Read(DWORD dwReadBytes, LPVOID lpvDest)
 {
-    const std::lock_guard<std::mutex> guard(myMutex);
-
     // Read up to dwReadBytes, never going past the write cursor
-    // Positions are updated immediately
-    const DWORD available = (this->myWritePosition - this->myPlayPosition) % this->myBufferSize;
+    const size_t writePosition = this->myWritePosition.load(std::memory_order_acquire);
+    const size_t playPosition = this->myPlayPosition.load(std::memory_order_relaxed);
+    const size_t available = writePosition - playPosition;
     if (available < dwReadBytes)
     {
         dwReadBytes = available;
         ++myNumberOfUnderruns;
     }
 
-    const DWORD availableInFirstPart = this->mySoundBuffer.size() - this->myPlayPosition;
-
-    *lplpvAudioPtr1 = this->mySoundBuffer.data() + this->myPlayPosition;
-    *lpdwAudioBytes1 = std::min(availableInFirstPart, dwReadBytes);
-
-    if (lplpvAudioPtr2 && lpdwAudioBytes2)
+    if (lpvDest)
     {
-        if (*lpdwAudioBytes1 < dwReadBytes)
-        {
-            *lplpvAudioPtr2 = this->mySoundBuffer.data();
-            *lpdwAudioBytes2 = dwReadBytes - *lpdwAudioBytes1;
-        }
-        else
-        {
-            *lplpvAudioPtr2 = nullptr;
-            *lpdwAudioBytes2 = 0;
-        }
+        const size_t offset = playPosition % this->myBufferSize;
+        const size_t bytes1 = std::min<size_t>(this->myBufferSize - offset, dwReadBytes);
+        uint8_t *dest = static_cast<uint8_t *>(lpvDest);
+        memcpy(dest, this->mySoundBuffer.data() + offset, bytes1);
+        memcpy(dest + bytes1, this->mySoundBuffer.data(), dwReadBytes - bytes1);
     }
-    this->myPlayPosition = (this->myPlayPosition + dwReadBytes) % this->mySoundBuffer.size();
+
+    this->myPlayPosition.store(playPosition + dwReadBytes, std::memory_order_release);
     return dwReadBytes;
 }
 
 DWORD LinuxSoundBuffer::GetBytesInBuffer() const
 {
-    const std::lock_guard<std::mutex> guard(myMutex);
-    const DWORD available = (this->myWritePosition - this->myPlayPosition) % this->myBufferSize;
-    return available;
+    // the play position first, so the difference can never be negative
+    const size_t playPosition = this->myPlayPosition.load(std::memory_order_acquire);
+    const size_t writePosition = this->myWritePosition.load(std::memory_order_acquire);
+    return writePosition - playPosition;
+}
+
+LONG LinuxSoundBuffer::GetBytesQueued()
+{
+    return GetBytesInBuffer();
 }
 
 HRESULT LinuxSoundBuffer::GetCurrentPosition(LPDWORD lpdwCurrentPlayCursor, LPDWORD lpdwCurrentWriteCursor)
 {
-    *lpdwCurrentPlayCursor = this->myPlayPosition;
-    *lpdwCurrentWriteCursor = this->myWritePosition;
+    *lpdwCurrentPlayCursor = this->myPlayPosition % this->myBufferSize;
+    *lpdwCurrentWriteCursor = this->myWritePosition % this->myBufferSize;
     return DS_OK;
 }
 
@@ -167,9 +176,15 @@ size_t LinuxSoundBuffer::GetBufferUnderruns() const
     return myNumberOfUnderruns;
 }
 
+size_t LinuxSoundBuffer::GetBufferOverruns() const
+{
+    return myNumberOfOverruns;
+}
+
 void LinuxSoundBuffer::ResetUnderruns()
 {
     myNumberOfUnderruns = 0;
+    myNumberOfOverruns = 0;
 }
 
 bool DSAvailable()
@@ -3,23 +3,29 @@
 #include "SoundBuffer.h"
 
 #include <vector>
-#include <mutex>
 #include <atomic>
 #include <string>
 
+// Single producer (the emulator: Lock/Unlock) single consumer (the audio callback: Read) ring buffer.
+// Wait-free: the 2 positions are monotonic byte counters, each written by one side only,
+// and kept on separate cache lines.
 class LinuxSoundBuffer : public SoundBuffer
 {
 private:
-    std::vector<uint8_t> mySoundBuffer;
+    static constexpr size_t ourCacheLine = 64;
 
-    size_t myPlayPosition = 0;
-    size_t myWritePosition = 0;
-    WORD myStatus = 0;
-    LONG myVolume = 0;
+    std::vector<uint8_t> mySoundBuffer;
 
-    // updated by the callback
+    // written by the consumer
+    alignas(ourCacheLine) std::atomic_size_t myPlayPosition;
     std::atomic_size_t myNumberOfUnderruns;
-    mutable std::mutex myMutex;
+
+    // written by the producer
+    alignas(ourCacheLine) std::atomic_size_t myWritePosition;
+    std::atomic_size_t myNumberOfOverruns;
+
+    alignas(ourCacheLine) std::atomic<WORD> myStatus;
+    std::atomic<LONG> myVolume;
 
 protected:
     LinuxSoundBuffer(DWORD dwBufferSize, DWORD nSampleRate, int nChannels, LPCSTR pszVoiceName);
@@ -46,13 +52,14 @@ public:
 
     virtual HRESULT GetStatus(LPDWORD lpdwStatus) override;
     virtual HRESULT Restore() override;
+    virtual LONG GetBytesQueued() override;
 
-    DWORD Read(
-        DWORD dwReadBytes, LPVOID *lplpvAudioPtr1, DWORD *lpdwAudioBytes1, LPVOID *lplpvAudioPtr2,
-        DWORD *lpdwAudioBytes2);
+    // copy up to dwReadBytes to lpvDest (or discard them if NULL), returns the number of bytes read
+    DWORD Read(DWORD dwReadBytes, LPVOID lpvDest);
     DWORD GetBytesInBuffer() const;
     size_t GetBufferUnderruns() const;
-    void ResetUnderruns();
+    size_t GetBufferOverruns() const;
+    void ResetUnderruns(); // and overruns
     double GetLogarithmicVolume() const; // in [0, 1]
 };
 
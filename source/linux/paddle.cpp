@@ -1,6 +1,7 @@
 #include "StdAfx.h"
 
 #include "linux/paddle.h"
+#include "linux/inputrecorder.h"
 
 #include "Memory.h"
 #include "CPU.h"
@@ -19,12 +20,18 @@ bool Paddle::ourSquaring = true;
 
 void Paddle::setButtonPressed(int i)
 {
-    ourButtons.insert(i);
+    if (InputRecorder::instance().onButton(i, true))
+    {
+        ourButtons.insert(i);
+    }
 }
 
 void Paddle::setButtonReleased(int i)
 {
-    ourButtons.erase(i);
+    if (InputRecorder::instance().onButton(i, false))
+    {
+        ourButtons.erase(i);
+    }
 }
 
 void Paddle::setSquaring(bool value)
@@ -70,6 +77,9 @@ int Paddle::getAxisValue(int i) const
 
 BYTE __stdcall JoyReadButton(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG uExecutedCycles)
 {
+    // the input recorder stamps the value with the exact cycle
+    CpuCalcCycles(uExecutedCycles);
+
     addr &= 0xFF;
     BOOL pressed = 0;
 
@@ -90,7 +100,7 @@ BYTE __stdcall JoyReadButton(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG uExe
                 }
                 else
                 {
-                    pressed = Paddle::instance->getButton(0);
+                    pressed = InputRecorder::instance().readPaddleButton(0, Paddle::instance->getButton(0));
                 }
                 break;
             case Paddle::ourSolidApple:
@@ -100,7 +110,7 @@ BYTE __stdcall JoyReadButton(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG uExe
                 }
                 else
                 {
-                    pressed = Paddle::instance->getButton(1);
+                    pressed = InputRecorder::instance().readPaddleButton(1, Paddle::instance->getButton(1));
                 }
                 break;
             case Paddle::ourThirdApple:
@@ -143,7 +153,7 @@ BYTE __stdcall JoyReadPosition(WORD pc, WORD address, BYTE bWrite, BYTE d, ULONG
         if (nJoyNum == 0)
         {
             int axis = address & 1;
-            int pos = Paddle::instance->getAxisValue(axis);
+            int pos = InputRecorder::instance().readPaddleAxis(axis, Paddle::instance->getAxisValue(axis));
             // This is from KEGS. It helps games like Championship Lode Runner, Boulderdash & Learning with
             // Leeper(GH#1128)
             if (pos >= 255)